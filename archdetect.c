@@ -0,0 +1,223 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * archdetect.c - Architecture detection for program files without any
+ *  metadata. The image is decoded under every architecture in a single
+ *  pass, with lazily filled opcode tables instead of the formatted
+ *  disassembly, so scoring is cheap next to disassembling the image.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "pic_disasm.h"
+#include "image.h"
+#include "archdetect.h"
+#include "profile.h"
+#include "errorcodes.h"
+
+extern instructionSetInfo allInstructionSets[];
+
+/* Score difference that makes the better architecture e times as likely */
+#define ARCH_DETECT_SCORE_SCALE		20.0
+
+/* Score a larger instruction set has to win by over the next smaller
+ * one, since it decodes some data words of a smaller core's program as
+ * instructions of its own */
+#define ARCH_DETECT_MIN_MARGIN		10
+
+/* Largest program memory of the candidates, in words */
+#define ARCH_DETECT_MAX_ADDRESS		0x8000
+
+/* Kinds of decoded words, DECODE_UNKNOWN for opcodes not decoded yet */
+enum {
+	DECODE_UNKNOWN,
+	DECODE_DATA,
+	DECODE_INSTRUCTION,
+	DECODE_ABSOLUTE,	/* goto, call */
+	DECODE_RELATIVE,	/* bra */
+};
+
+/* Structure to hold a decoded opcode, with the target of a jump or call */
+typedef struct {
+	int16_t operand;
+	uint8_t kind;
+} decodedWord;
+
+/* Structure to hold the decoding of a candidate architecture */
+typedef struct {
+	int archSelect;
+	/* Bits that no instruction of the core has */
+	uint16_t wideMask;
+	uint32_t programMemorySize, pageSize;
+	/* Decoding of every opcode of the core, filled in when first seen */
+	decodedWord *decoded;
+} candidateDecoder;
+
+/* Decodes an opcode into the table of the candidate. */
+static const decodedWord *decodeCandidateWord(candidateDecoder *candidate, uint16_t opcode) {
+	disassembledInstruction dInstruction;
+	assembledInstruction aInstruction;
+	decodedWord *dWord;
+	const instructionSetInfo *instructionSet;
+
+	dWord = &candidate->decoded[opcode];
+	if (dWord->kind != DECODE_UNKNOWN)
+		return dWord;
+
+	aInstruction.address = 0;
+	aInstruction.opcode = opcode;
+	instructionSet = &allInstructionSets[candidate->archSelect];
+	/* Only fails for an invalid architecture */
+	disassembleInstruction(&dInstruction, &aInstruction, candidate->archSelect);
+
+	dWord->operand = 0;
+	if (dInstruction.instruction == &instructionSet->instructionSet[instructionSet->numInstructions-1]) {
+		dWord->kind = DECODE_DATA;
+	} else if (dInstruction.instruction->operandTypes[0] == OPERAND_ABSOLUTE_ADDRESS) {
+		dWord->kind = DECODE_ABSOLUTE;
+		dWord->operand = dInstruction.operands[0];
+	} else if (dInstruction.instruction->operandTypes[0] == OPERAND_RELATIVE_ADDRESS) {
+		dWord->kind = DECODE_RELATIVE;
+		dWord->operand = dInstruction.operands[0];
+	} else {
+		dWord->kind = DECODE_INSTRUCTION;
+	}
+	return dWord;
+}
+
+/* Decodes the program image under every architecture side by side and
+ * scores each one by its data word ratio, the jumps and calls to
+ * addresses inside the image, and the instruction at the reset vector.
+ * Fills in the ARCH_DETECT_NUM_CANDIDATES scores and the confidence in the
+ * winner in percent. Returns the architecture with the best score, where
+ * a larger instruction set has to win by a margin, or a negative error
+ * code. */
+int detectArchitecture(const programImage *image, architectureScore *scores, int *confidence) {
+	candidateDecoder candidates[ARCH_DETECT_NUM_CANDIDATES] = {
+		{PIC_BASELINE, 0xF000, 0x800, 0x200, NULL},
+		{PIC_MIDRANGE, 0xC000, 0x2000, 0x800, NULL},
+		{PIC_MIDRANGE_ENHANCED, 0xC000, 0x8000, 0x800, NULL},
+	};
+	/* Bitmap of the addresses the image holds */
+	uint8_t present[ARCH_DETECT_MAX_ADDRESS/8];
+	const assembledInstruction *aInstruction;
+	const decodedWord *dWord;
+	candidateDecoder *candidate;
+	architectureScore *score;
+	uint32_t target;
+	double likelihood;
+	int handicaps[ARCH_DETECT_NUM_CANDIDATES];
+	int i, c, best, previousStage;
+	int retVal = 0;
+
+	previousStage = PROFILE_SWITCH(PROFILE_STAGE_ANALYZE);
+
+	for (c = 0; c < ARCH_DETECT_NUM_CANDIDATES; c++) {
+		candidates[c].decoded = calloc((~candidates[c].wideMask & 0xFFFF) + 1, sizeof(decodedWord));
+		if (candidates[c].decoded == NULL) {
+			retVal = ERROR_MEMORY_ALLOCATION_ERROR;
+			goto done;
+		}
+		memset(&scores[c], 0, sizeof(architectureScore));
+		scores[c].archSelect = candidates[c].archSelect;
+	}
+
+	memset(present, 0, sizeof(present));
+	for (i = 0; i < image->numInstructions; i++) {
+		if (image->instructions[i].address < ARCH_DETECT_MAX_ADDRESS)
+			present[image->instructions[i].address/8] |= 1 << (image->instructions[i].address%8);
+	}
+
+	for (i = 0; i < image->numInstructions; i++) {
+		aInstruction = &image->instructions[i];
+		for (c = 0; c < ARCH_DETECT_NUM_CANDIDATES; c++) {
+			candidate = &candidates[c];
+			score = &scores[c];
+			if (aInstruction->address >= candidate->programMemorySize)
+				continue;
+			score->numWords++;
+
+			/* Words wider than the core are never instructions */
+			if ((aInstruction->opcode & candidate->wideMask) != 0) {
+				score->numDataWords++;
+				if (aInstruction->address == 0)
+					score->resetVectorValid = 0;
+				continue;
+			}
+
+			dWord = decodeCandidateWord(candidate, aInstruction->opcode);
+			if (aInstruction->address == 0)
+				score->resetVectorValid = (dWord->kind != DECODE_DATA);
+			if (dWord->kind == DECODE_DATA) {
+				score->numDataWords++;
+			} else if (dWord->kind == DECODE_ABSOLUTE || dWord->kind == DECODE_RELATIVE) {
+				/* Jumps and calls are taken to stay in the page, as
+				 * the page selection isn't tracked here */
+				if (dWord->kind == DECODE_ABSOLUTE)
+					target = (aInstruction->address & ~(candidate->pageSize-1)) + dWord->operand;
+				else
+					target = aInstruction->address + dWord->operand + 1;
+				score->numBranches++;
+				if (target < candidate->programMemorySize && (present[target/8] & (1 << (target%8))) != 0)
+					score->numValidTargets++;
+			}
+		}
+	}
+
+	/* The instruction words count most, then the jump and call targets */
+	for (c = 0; c < ARCH_DETECT_NUM_CANDIDATES; c++) {
+		score = &scores[c];
+		if (score->numWords > 0)
+			score->score += 600*(score->numWords - score->numDataWords)/score->numWords;
+		if (score->numBranches > 0)
+			score->score += 300*score->numValidTargets/score->numBranches;
+		if (score->resetVectorValid)
+			score->score += 100;
+	}
+
+	/* The candidates are in order of their instruction sets, and each
+	 * larger one must beat the smaller ones by a margin: a midrange
+	 * program with a few data words in the opcodes only the enhanced
+	 * core has is still a midrange program. On a tie the smaller
+	 * instruction set wins. */
+	best = 0;
+	for (c = 0; c < ARCH_DETECT_NUM_CANDIDATES; c++) {
+		handicaps[c] = c*ARCH_DETECT_MIN_MARGIN;
+		if (scores[c].score - handicaps[c] > scores[best].score - handicaps[best])
+			best = c;
+	}
+	/* The confidence is the share of the winner in the likelihoods of
+	 * all of the architectures, which grow exponentially with the score
+	 * less the margin */
+	likelihood = 0.0;
+	for (c = 0; c < ARCH_DETECT_NUM_CANDIDATES; c++)
+		likelihood += exp(((scores[c].score - handicaps[c]) - (scores[best].score - handicaps[best]))/ARCH_DETECT_SCORE_SCALE);
+	*confidence = (int)(100.0/likelihood);
+	retVal = candidates[best].archSelect;
+
+done:
+	for (c = 0; c < ARCH_DETECT_NUM_CANDIDATES; c++)
+		free(candidates[c].decoded);
+	PROFILE_SWITCH(previousStage);
+
+	return retVal;
+}
@@ -0,0 +1,57 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * archdetect.h - Header file for the architecture detection, which scores
+ *  how well a program image decodes under each architecture.
+ *
+ */
+
+#ifndef ARCHDETECT_DISASM_H
+#define ARCHDETECT_DISASM_H
+
+#include "image.h"
+
+/* Number of architectures scored: baseline, midrange and enhanced */
+#define ARCH_DETECT_NUM_CANDIDATES	3
+
+/* Structure to hold the score of the program image under an architecture */
+struct _architectureScore {
+	int archSelect;
+	/* Words inside the program memory of the architecture, and the ones
+	 * that don't decode to an instruction */
+	long numWords, numDataWords;
+	/* Jumps and calls, and the ones to an address the image holds */
+	long numBranches, numValidTargets;
+	/* The reset vector holds an instruction */
+	int resetVectorValid;
+	/* Score from 0 to 1000 */
+	int score;
+};
+typedef struct _architectureScore architectureScore;
+
+/* Decodes the program image under every architecture side by side and
+ * scores each one by its data word ratio, the jumps and calls to
+ * addresses inside the image, and the instruction at the reset vector.
+ * Fills in the ARCH_DETECT_NUM_CANDIDATES scores and the confidence in the
+ * winner in percent. Returns the architecture with the best score, where
+ * a larger instruction set has to win by a margin, or a negative error
+ * code. */
+int detectArchitecture(const programImage *image, architectureScore *scores, int *confidence);
+
+#endif
@@ -0,0 +1,663 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * assemble.c - Two pass assembler for the disassembly text, with the
+ *  mnemonics looked up in a hash table built from the instruction sets.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include "assemble.h"
+#include "file.h"
+#include "pic_device.h"
+#include "errorcodes.h"
+
+extern instructionSetInfo allInstructionSets[];
+
+/* Number of slots of the mnemonic hash table, a power of two of at least
+ * twice the number of instructions of the largest instruction set */
+#define ASSEMBLER_MNEMONIC_SLOTS	256
+
+/* Maximum number of operands on a line */
+#define ASSEMBLER_MAX_OPERANDS		4
+
+/* Structure for each entry of the symbol table, holding the address
+ * labels and the register names looked up so far. */
+struct _assemblerSymbol {
+	char *name;
+	long value;
+};
+typedef struct _assemblerSymbol assemblerSymbol;
+
+/* Structure to hold the state of the assembler */
+struct _assembler {
+	int archSelect;
+	int deviceIndex;
+	const char *labelPrefix;
+	/* Index of the first instruction with the mnemonic hashed to each
+	 * slot, or -1 for empty slots */
+	int mnemonicSlots[ASSEMBLER_MNEMONIC_SLOTS];
+	/* Index of the next instruction with the same mnemonic, or -1. A few
+	 * mnemonics, such as moviw and movwi, have one entry per operand
+	 * syntax. */
+	int nextInstruction[PIC_TOTAL_PIC18_INSTRUCTIONS];
+	/* Open addressed symbol table, with a power of two capacity */
+	assemblerSymbol *symbols;
+	int numSymbols;
+	int symbolCapacity;
+	/* Address of the next word, and the current line number */
+	uint32_t address;
+	int lineNumber;
+};
+typedef struct _assembler assembler;
+
+/* Assembles a single line, in the first pass only collecting the labels.
+ * Returns 1 at the end directive. */
+static int assembleLine(assembler *as, char *line, int pass, programImage *image);
+/* Encodes an instruction with the mnemonic and operands of a line. */
+static int encodeInstruction(assembler *as, const char *mnemonic, char **operands, int numOperands, uint16_t *opcode);
+/* Parses a number, the current address ".", a label, or a register name. */
+static int parseValue(assembler *as, const char *text, long *value);
+static int defineSymbol(assembler *as, const char *name, long value);
+static uint32_t hashName(const char *name);
+static uint16_t insertDataIntoMask(uint16_t data, uint16_t mask);
+static char *trimWhitespace(char *s);
+
+
+/* Assembles the assembly text written by disassembleProgramImage() with
+ * address labels, appending the assembled words to the program image in
+ * the order of the text. Understands the org, end, dw, de and __config
+ * directives, address labels, and register names of the device if
+ * deviceIndex is not -1. Labels that are never defined, as printed for
+ * branches out of the program, stand for their address if they are
+ * labelPrefix followed by a hexadecimal address. An instruction that can't
+ * be encoded is reported and appended with ASSEMBLER_UNENCODABLE set in
+ * its address, so the words after it still line up. The file is read
+ * twice, once to collect the labels and once to encode, so it must be
+ * seekable. */
+int assembleText(programImage *image, FILE *fileIn, int archSelect, int deviceIndex, const char *labelPrefix) {
+	const instructionInfo *instructionSet;
+	assembler as;
+	char *line;
+	size_t lineSize;
+	uint32_t slot;
+	int i, pass, retVal;
+
+	if (archSelect < PIC_BASELINE || archSelect > PIC_PIC18)
+		return ERROR_INVALID_ARGUMENTS;
+
+	memset(&as, 0, sizeof(as));
+	as.archSelect = archSelect;
+	as.deviceIndex = deviceIndex;
+	as.labelPrefix = labelPrefix;
+
+	/* Chain the instructions with the same mnemonic in the order of the
+	 * instruction set, by inserting them backwards at the head */
+	instructionSet = allInstructionSets[archSelect].instructionSet;
+	for (i = 0; i < ASSEMBLER_MNEMONIC_SLOTS; i++)
+		as.mnemonicSlots[i] = -1;
+	for (i = allInstructionSets[archSelect].numInstructions-1; i >= 0; i--) {
+		slot = hashName(instructionSet[i].mnemonic) & (ASSEMBLER_MNEMONIC_SLOTS-1);
+		while (as.mnemonicSlots[slot] >= 0 && strcasecmp(instructionSet[as.mnemonicSlots[slot]].mnemonic, instructionSet[i].mnemonic) != 0)
+			slot = (slot+1) & (ASSEMBLER_MNEMONIC_SLOTS-1);
+		as.nextInstruction[i] = as.mnemonicSlots[slot];
+		as.mnemonicSlots[slot] = i;
+	}
+
+	as.symbolCapacity = 256;
+	as.symbols = calloc(as.symbolCapacity, sizeof(assemblerSymbol));
+	if (as.symbols == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for the symbol table!\n");
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+
+	line = NULL;
+	lineSize = 0;
+	retVal = 0;
+	for (pass = 1; pass <= 2 && retVal == 0; pass++) {
+		if (fseek(fileIn, 0, SEEK_SET) < 0) {
+			fprintf(stderr, "Error rewinding the assembly text!\n");
+			retVal = ERROR_FILE_READING_ERROR;
+			break;
+		}
+		as.address = 0;
+		as.lineNumber = 0;
+		while (getline(&line, &lineSize, fileIn) >= 0) {
+			as.lineNumber++;
+			retVal = assembleLine(&as, line, pass, image);
+			if (retVal != 0)
+				break;
+		}
+		/* The end directive */
+		if (retVal == 1)
+			retVal = 0;
+	}
+	if (retVal == 0 && ferror(fileIn)) {
+		fprintf(stderr, "Error reading the assembly text!\n");
+		retVal = ERROR_FILE_READING_ERROR;
+	}
+
+	free(line);
+	for (i = 0; i < as.symbolCapacity; i++)
+		free(as.symbols[i].name);
+	free(as.symbols);
+
+	return retVal;
+}
+
+/* Disassembles the program image with address labels, assembles the
+ * disassembly again, and prints every word that doesn't assemble back to
+ * its original value. Returns the number of such words, or a negative
+ * error code. */
+int verifyRoundTrip(FILE *fileOut, const programImage *image, formattingOptions fOptions, int archSelect) {
+	programImage reassembled;
+	disassembledInstruction dInstruction;
+	const assembledInstruction *original;
+	FILE *textFile;
+	char *text;
+	size_t textSize;
+	int i, retVal, numMismatches;
+
+	/* Only assembly text with labels and org directives can be
+	 * assembled. The ASCII comments are left out, because they would
+	 * print control characters such as newlines raw. */
+	if (!(fOptions.options & FORMAT_OPTION_ADDRESS_LABEL)) {
+		fOptions.options |= FORMAT_OPTION_ADDRESS_LABEL;
+		strcpy(fOptions.addressLabelPrefix, "A_");
+	}
+	fOptions.options &= ~FORMAT_OPTION_LITERAL_ASCII_COMMENT;
+	fOptions.outputFormat = OUTPUT_FORMAT_TEXT;
+
+	text = NULL;
+	textSize = 0;
+	textFile = open_memstream(&text, &textSize);
+	if (textFile == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for the disassembly!\n");
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+	retVal = disassembleProgramImage(textFile, image, fOptions, archSelect);
+	if (fclose(textFile) != 0 && retVal == 0)
+		retVal = ERROR_FILE_WRITING_ERROR;
+	if (retVal < 0) {
+		free(text);
+		return retVal;
+	}
+
+	initProgramImage(&reassembled);
+	textFile = fmemopen(text, textSize, "r");
+	if (textFile == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for the disassembly!\n");
+		free(text);
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+	retVal = assembleText(&reassembled, textFile, archSelect, fOptions.deviceIndex, fOptions.addressLabelPrefix);
+	fclose(textFile);
+	free(text);
+	if (retVal < 0) {
+		freeProgramImage(&reassembled);
+		return retVal;
+	}
+
+	/* Every word of the image is printed as one line, so the reassembled
+	 * words are in the same order as the original ones */
+	numMismatches = 0;
+	for (i = 0; i < image->numInstructions; i++) {
+		original = &image->instructions[i];
+		if (i < reassembled.numInstructions && reassembled.instructions[i].address == original->address &&
+		    reassembled.instructions[i].opcode == original->opcode)
+			continue;
+
+		numMismatches++;
+		if (i >= reassembled.numInstructions)
+			retVal = fprintf(fileOut, "%0*X: %04X is missing from the reassembled program", fOptions.addressFieldWidth, original->address, original->opcode);
+		else if (reassembled.instructions[i].address & ASSEMBLER_UNENCODABLE)
+			retVal = fprintf(fileOut, "%0*X: %04X doesn't reassemble", fOptions.addressFieldWidth, original->address, original->opcode);
+		else if (reassembled.instructions[i].address != original->address)
+			retVal = fprintf(fileOut, "%0*X: %04X reassembles at address %0*X", fOptions.addressFieldWidth, original->address, original->opcode, fOptions.addressFieldWidth, reassembled.instructions[i].address);
+		else
+			retVal = fprintf(fileOut, "%0*X: %04X reassembles to %04X", fOptions.addressFieldWidth, original->address, original->opcode, reassembled.instructions[i].opcode);
+		if (retVal >= 0 && (fOptions.deviceIndex < 0 || lookupMemoryRegion(fOptions.deviceIndex, original->address) == REGION_PROGRAM) &&
+		    disassembleInstruction(&dInstruction, original, archSelect) == 0)
+			retVal = fprintf(fileOut, " (%s)", dInstruction.instruction->mnemonic);
+		if (retVal < 0 || fprintf(fileOut, "\n") < 0) {
+			freeProgramImage(&reassembled);
+			return ERROR_FILE_WRITING_ERROR;
+		}
+	}
+	for (; i < reassembled.numInstructions; i++) {
+		numMismatches++;
+		if (fprintf(fileOut, "%0*X: %04X is not in the original program\n", fOptions.addressFieldWidth, reassembled.instructions[i].address & ~ASSEMBLER_UNENCODABLE, reassembled.instructions[i].opcode) < 0) {
+			freeProgramImage(&reassembled);
+			return ERROR_FILE_WRITING_ERROR;
+		}
+	}
+
+	retVal = fprintf(fileOut, "%d words, %d reassembled differently\n", image->numInstructions, numMismatches);
+	freeProgramImage(&reassembled);
+	if (retVal < 0)
+		return ERROR_FILE_WRITING_ERROR;
+
+	return numMismatches;
+}
+
+/* Assembles a single line, in the first pass only collecting the labels.
+ * Returns 1 at the end directive. */
+static int assembleLine(assembler *as, char *line, int pass, programImage *image) {
+	char *label, *mnemonic, *operandText, *operands[ASSEMBLER_MAX_OPERANDS], *next, *p;
+	long value, address;
+	uint16_t opcode;
+	int numOperands;
+
+	/* Comments run to the end of the line */
+	p = strchr(line, ';');
+	if (p != NULL)
+		*p = '\0';
+
+	/* Anything in the first column is a label, except for the org and
+	 * end directives which are printed there */
+	label = NULL;
+	mnemonic = line;
+	if (*line != '\0' && !isspace((unsigned char)*line)) {
+		for (p = line; *p != '\0' && !isspace((unsigned char)*p); p++)
+			;
+		if (p-line != 3 || (strncasecmp(line, "org", 3) != 0 && strncasecmp(line, "end", 3) != 0)) {
+			label = line;
+			mnemonic = p;
+			if (*p != '\0')
+				mnemonic++;
+			*p = '\0';
+		}
+	}
+
+	mnemonic = trimWhitespace(mnemonic);
+	for (operandText = mnemonic; *operandText != '\0' && !isspace((unsigned char)*operandText); operandText++)
+		;
+	if (*operandText != '\0')
+		*operandText++ = '\0';
+	operandText = trimWhitespace(operandText);
+
+	if (label != NULL && pass == 1 && defineSymbol(as, label, as->address) < 0)
+		return ERROR_INVALID_ARGUMENTS;
+	if (*mnemonic == '\0')
+		return 0;
+
+	/* Split up the operands */
+	numOperands = 0;
+	while (*operandText != '\0') {
+		if (numOperands == ASSEMBLER_MAX_OPERANDS) {
+			fprintf(stderr, "Error: line %d: too many operands!\n", as->lineNumber);
+			return ERROR_INVALID_ARGUMENTS;
+		}
+		next = strchr(operandText, ',');
+		if (next != NULL)
+			*next++ = '\0';
+		else
+			next = operandText + strlen(operandText);
+		operands[numOperands++] = trimWhitespace(operandText);
+		operandText = next;
+	}
+
+	if (strcasecmp(mnemonic, "end") == 0)
+		return 1;
+
+	if (strcasecmp(mnemonic, "org") == 0) {
+		if (numOperands != 1 || parseValue(as, operands[0], &address) < 0 || address < 0) {
+			fprintf(stderr, "Error: line %d: invalid org directive!\n", as->lineNumber);
+			return ERROR_INVALID_ARGUMENTS;
+		}
+		as->address = address;
+		return 0;
+	}
+
+	/* Configuration words may be given with their address */
+	if (strcasecmp(mnemonic, "__config") == 0 && numOperands == 2) {
+		if (parseValue(as, operands[0], &address) < 0 || address < 0) {
+			fprintf(stderr, "Error: line %d: invalid configuration word address!\n", as->lineNumber);
+			return ERROR_INVALID_ARGUMENTS;
+		}
+		as->address = address;
+		operands[0] = operands[1];
+		numOperands = 1;
+	}
+
+	/* The first pass only counts the words */
+	if (pass == 1) {
+		as->address++;
+		return 0;
+	}
+
+	if (strcasecmp(mnemonic, "dw") == 0 || strcasecmp(mnemonic, "de") == 0 || strcasecmp(mnemonic, "__config") == 0) {
+		if (numOperands != 1 || parseValue(as, operands[0], &value) < 0 || value < 0 || value > 0xFFFF ||
+		    (strcasecmp(mnemonic, "de") == 0 && value > 0xFF)) {
+			fprintf(stderr, "Error: line %d: invalid %s directive!\n", as->lineNumber, mnemonic);
+			return ERROR_INVALID_ARGUMENTS;
+		}
+		opcode = value;
+	} else if (encodeInstruction(as, mnemonic, operands, numOperands, &opcode) < 0) {
+		if (appendProgramImage(image, as->address | ASSEMBLER_UNENCODABLE, 0) < 0) {
+			fprintf(stderr, "Error allocating sufficient memory for program image!\n");
+			return ERROR_MEMORY_ALLOCATION_ERROR;
+		}
+		as->address++;
+		return 0;
+	}
+
+	if (appendProgramImage(image, as->address, opcode) < 0) {
+		fprintf(stderr, "Error allocating sufficient memory for program image!\n");
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+	as->address++;
+
+	return 0;
+}
+
+/* Parses the indirect operand of moviw and movwi, "++INDFn", "--INDFn",
+ * "INDFn++" and "INDFn--" for the increment modes 0 to 3, or "k[INDFn]"
+ * for an index with a signed offset. Returns 0 on success. */
+static int parseIndirectOperand(assembler *as, const char *text, int withOffset, long *index, long *modeOrOffset) {
+	char offsetText[32], *end;
+	const char *p;
+	size_t length;
+
+	if (withOffset) {
+		p = strchr(text, '[');
+		length = strlen(text);
+		if (p == NULL || (size_t)(p-text) >= sizeof(offsetText) || length == 0 || text[length-1] != ']')
+			return ERROR_INVALID_ARGUMENTS;
+		memcpy(offsetText, text, p-text);
+		offsetText[p-text] = '\0';
+		if (parseValue(as, trimWhitespace(offsetText), modeOrOffset) < 0)
+			return ERROR_INVALID_ARGUMENTS;
+		text = p+1;
+	} else if (strncmp(text, "++", 2) == 0 || strncmp(text, "--", 2) == 0) {
+		*modeOrOffset = (text[0] == '+') ? 0 : 1;
+		text += 2;
+	} else {
+		*modeOrOffset = -1;
+	}
+
+	if (strncasecmp(text, OPERAND_PREFIX_INDF_INDEX, strlen(OPERAND_PREFIX_INDF_INDEX)) != 0)
+		return ERROR_INVALID_ARGUMENTS;
+	text += strlen(OPERAND_PREFIX_INDF_INDEX);
+	if (!isdigit((unsigned char)*text))
+		return ERROR_INVALID_ARGUMENTS;
+	*index = strtol(text, &end, 10);
+
+	if (withOffset)
+		return (strcmp(end, "]") == 0) ? 0 : ERROR_INVALID_ARGUMENTS;
+	if (*modeOrOffset >= 0)
+		return (*end == '\0') ? 0 : ERROR_INVALID_ARGUMENTS;
+	if (strcmp(end, "++") == 0)
+		*modeOrOffset = 2;
+	else if (strcmp(end, "--") == 0)
+		*modeOrOffset = 3;
+	else
+		return ERROR_INVALID_ARGUMENTS;
+
+	return 0;
+}
+
+/* Encodes the operands of a line as the operands of one instruction of the
+ * instruction set. Returns 0 on success. */
+static int encodeOperands(assembler *as, const instructionInfo *instruction, char **operands, int numOperands, uint16_t *opcode) {
+	long values[PIC_MAX_NUM_OPERANDS];
+	int i, k, bits, signedOperand;
+
+	/* moviw and movwi print both of their operands as one */
+	if (instruction->numOperands == 2 && instruction->operandTypes[0] == OPERAND_INDF_INDEX) {
+		if (numOperands != 1 || parseIndirectOperand(as, operands[0], instruction->operandTypes[1] == OPERAND_SIGNED_LITERAL, &values[0], &values[1]) < 0)
+			return ERROR_INVALID_ARGUMENTS;
+	} else {
+		if (numOperands != instruction->numOperands)
+			return ERROR_INVALID_ARGUMENTS;
+		for (k = 0; k < numOperands; k++) {
+			if (instruction->operandTypes[k] == OPERAND_REGISTER_DEST && strcasecmp(operands[k], OPERAND_REGISTER_DEST_W) == 0) {
+				values[k] = 0;
+			} else if (instruction->operandTypes[k] == OPERAND_REGISTER_DEST && strcasecmp(operands[k], OPERAND_REGISTER_DEST_F) == 0) {
+				values[k] = 1;
+			} else if (instruction->operandTypes[k] == OPERAND_RELATIVE_ADDRESS && operands[k][0] == '.') {
+				/* ".+n" and ".-n" are printed with the encoded
+				 * distance, not the distance from the
+				 * instruction itself */
+				if (parseValue(as, operands[k]+1, &values[k]) < 0)
+					return ERROR_INVALID_ARGUMENTS;
+			} else {
+				if (parseValue(as, operands[k], &values[k]) < 0)
+					return ERROR_INVALID_ARGUMENTS;
+				if (instruction->operandTypes[k] == OPERAND_RELATIVE_ADDRESS)
+					values[k] -= as->address + 1;
+			}
+		}
+	}
+
+	*opcode = instruction->opcodeMask;
+	for (k = 0; k < instruction->numOperands; k++) {
+		for (i = 0, bits = 0; i < 16; i++) {
+			if (instruction->operandMasks[k] & (1 << i))
+				bits++;
+		}
+
+		/* Register and absolute address operands may be given as
+		 * full bank or page qualified addresses, of which only the
+		 * offset into the bank or page is encoded. */
+		signedOperand = (instruction->operandTypes[k] == OPERAND_RELATIVE_ADDRESS ||
+				 instruction->operandTypes[k] == OPERAND_SIGNED_LITERAL);
+		if (instruction->operandTypes[k] == OPERAND_REGISTER || instruction->operandTypes[k] == OPERAND_ABSOLUTE_ADDRESS)
+			values[k] &= (1L << bits) - 1;
+		else if (signedOperand && (values[k] < -(1L << (bits-1)) || values[k] >= (1L << (bits-1))))
+			return ERROR_INVALID_ARGUMENTS;
+		else if (!signedOperand && (values[k] < 0 || values[k] >= (1L << bits)))
+			return ERROR_INVALID_ARGUMENTS;
+
+		*opcode |= insertDataIntoMask((uint16_t)values[k], instruction->operandMasks[k]);
+	}
+
+	return 0;
+}
+
+/* Encodes an instruction with the mnemonic and operands of a line, trying
+ * every instruction of that mnemonic until the operands fit one. */
+static int encodeInstruction(assembler *as, const char *mnemonic, char **operands, int numOperands, uint16_t *opcode) {
+	const instructionInfo *instructionSet = allInstructionSets[as->archSelect].instructionSet;
+	uint32_t slot;
+	int i;
+
+	slot = hashName(mnemonic) & (ASSEMBLER_MNEMONIC_SLOTS-1);
+	while (as->mnemonicSlots[slot] >= 0 && strcasecmp(instructionSet[as->mnemonicSlots[slot]].mnemonic, mnemonic) != 0)
+		slot = (slot+1) & (ASSEMBLER_MNEMONIC_SLOTS-1);
+	if (as->mnemonicSlots[slot] < 0) {
+		fprintf(stderr, "Error: line %d: unknown mnemonic %s!\n", as->lineNumber, mnemonic);
+		return ERROR_INVALID_ARGUMENTS;
+	}
+
+	for (i = as->mnemonicSlots[slot]; i >= 0; i = as->nextInstruction[i]) {
+		if (encodeOperands(as, &instructionSet[i], operands, numOperands, opcode) == 0)
+			return 0;
+	}
+
+	fprintf(stderr, "Error: line %d: invalid operands for %s!\n", as->lineNumber, mnemonic);
+	return ERROR_INVALID_ARGUMENTS;
+}
+
+/* Finds the slot of a symbol in the symbol table, or the empty slot where
+ * it belongs. */
+static int findSymbol(const assembler *as, const char *name) {
+	uint32_t slot;
+
+	slot = hashName(name) & (as->symbolCapacity-1);
+	while (as->symbols[slot].name != NULL && strcmp(as->symbols[slot].name, name) != 0)
+		slot = (slot+1) & (as->symbolCapacity-1);
+
+	return slot;
+}
+
+/* Defines a symbol, growing the symbol table to keep it at most half
+ * full. Redefining a symbol with another value is an error. */
+static int defineSymbol(assembler *as, const char *name, long value) {
+	assemblerSymbol *oldSymbols;
+	int i, oldCapacity, slot;
+
+	slot = findSymbol(as, name);
+	if (as->symbols[slot].name != NULL) {
+		if (as->symbols[slot].value == value)
+			return 0;
+		fprintf(stderr, "Error: line %d: symbol %s is already defined!\n", as->lineNumber, name);
+		return ERROR_INVALID_ARGUMENTS;
+	}
+
+	if (2*(as->numSymbols+1) > as->symbolCapacity) {
+		oldSymbols = as->symbols;
+		oldCapacity = as->symbolCapacity;
+		as->symbols = calloc(2*oldCapacity, sizeof(assemblerSymbol));
+		if (as->symbols == NULL) {
+			fprintf(stderr, "Error allocating sufficient memory for the symbol table!\n");
+			as->symbols = oldSymbols;
+			return ERROR_MEMORY_ALLOCATION_ERROR;
+		}
+		as->symbolCapacity = 2*oldCapacity;
+		for (i = 0; i < oldCapacity; i++) {
+			if (oldSymbols[i].name != NULL)
+				as->symbols[findSymbol(as, oldSymbols[i].name)] = oldSymbols[i];
+		}
+		free(oldSymbols);
+		slot = findSymbol(as, name);
+	}
+
+	as->symbols[slot].name = strdup(name);
+	if (as->symbols[slot].name == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for the symbol table!\n");
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+	as->symbols[slot].value = value;
+	as->numSymbols++;
+
+	return 0;
+}
+
+/* Parses a number in hexadecimal (0x), binary (b'...') or decimal, the
+ * current address ".", a label, a register name of the device, or the
+ * label prefix followed by a hexadecimal address. Returns 0 on success. */
+static int parseValue(assembler *as, const char *text, long *value) {
+	const char *p;
+	char *end;
+	int32_t address;
+	size_t length;
+	int slot;
+
+	if (strcmp(text, ".") == 0) {
+		*value = as->address;
+		return 0;
+	}
+
+	/* Binary */
+	if ((text[0] == 'b' || text[0] == 'B') && text[1] == '\'') {
+		*value = 0;
+		for (p = text+2; *p == '0' || *p == '1'; p++)
+			*value = (*value << 1) | (*p - '0');
+		return (p > text+2 && strcmp(p, "'") == 0) ? 0 : ERROR_INVALID_ARGUMENTS;
+	}
+
+	/* Hexadecimal or decimal, so "010" isn't taken for octal */
+	if (isdigit((unsigned char)text[0]) || ((text[0] == '-' || text[0] == '+') && isdigit((unsigned char)text[1]))) {
+		if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+			*value = strtol(text, &end, 16);
+		else
+			*value = strtol(text, &end, 10);
+		return (*end == '\0') ? 0 : ERROR_INVALID_ARGUMENTS;
+	}
+
+	/* Labels, and the register names already looked up */
+	slot = findSymbol(as, text);
+	if (as->symbols[slot].name != NULL) {
+		*value = as->symbols[slot].value;
+		return 0;
+	}
+
+	/* Register names are remembered in the symbol table, because
+	 * looking them up by name scans the device's symbol table */
+	if (as->deviceIndex >= 0) {
+		address = lookupRegisterAddress(as->deviceIndex, text);
+		if (address >= 0) {
+			*value = address;
+			return defineSymbol(as, text, address);
+		}
+	}
+
+	/* Branches out of the program are printed with labels that are
+	 * never defined */
+	length = (as->labelPrefix != NULL) ? strlen(as->labelPrefix) : 0;
+	if (length > 0 && strncmp(text, as->labelPrefix, length) == 0 && isxdigit((unsigned char)text[length])) {
+		/* Backward branches out of the bottom of the program memory
+		 * are printed as 32-bit two's complement addresses */
+		*value = (int32_t)strtoul(text+length, &end, 16);
+		if (*end == '\0')
+			return 0;
+	}
+
+	return ERROR_INVALID_ARGUMENTS;
+}
+
+/* FNV-1a hash of a name, ignoring case so that mnemonics hash the same in
+ * any case. */
+static uint32_t hashName(const char *name) {
+	uint32_t hash = 2166136261U;
+
+	for (; *name != '\0'; name++) {
+		hash ^= (uint8_t)tolower((unsigned char)*name);
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+/* Places the bits of data into the bit positions set in mask, the inverse
+ * of extractDataFromMask() in pic_disasm.c. */
+static uint16_t insertDataIntoMask(uint16_t data, uint16_t mask) {
+	int i, j;
+	uint16_t result = 0;
+
+	/* i counts through every bit of the mask,
+	 * j counts through every bit of the data we're copying in. */
+	for (i = 0, j = 0; i < 16; i++) {
+		if (mask & (1<<i)) {
+			if (data & (1<<j))
+				result |= (1<<i);
+			j++;
+		}
+	}
+
+	return result;
+}
+
+/* Removes leading and trailing whitespace from a string, in place. */
+static char *trimWhitespace(char *s) {
+	char *end;
+
+	while (isspace((unsigned char)*s))
+		s++;
+	for (end = s + strlen(s); end > s && isspace((unsigned char)end[-1]); end--)
+		;
+	*end = '\0';
+
+	return s;
+}
@@ -0,0 +1,54 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * assemble.h - Header file for the assembler of the disassembly text, used
+ *  to verify that the disassembly assembles back to the original program.
+ *
+ */
+
+#ifndef ASSEMBLE_DISASM_H
+#define ASSEMBLE_DISASM_H
+
+#include <stdio.h>
+#include "format.h"
+#include "image.h"
+
+/* Flag in the address of a word whose instruction couldn't be encoded */
+#define ASSEMBLER_UNENCODABLE	0x80000000
+
+/* Assembles the assembly text written by disassembleProgramImage() with
+ * address labels, appending the assembled words to the program image in
+ * the order of the text. Understands the org, end, dw, de and __config
+ * directives, address labels, and register names of the device if
+ * deviceIndex is not -1. Labels that are never defined, as printed for
+ * branches out of the program, stand for their address if they are
+ * labelPrefix followed by a hexadecimal address. An instruction that can't
+ * be encoded is reported and appended with ASSEMBLER_UNENCODABLE set in
+ * its address, so the words after it still line up. The file is read
+ * twice, once to collect the labels and once to encode, so it must be
+ * seekable. */
+int assembleText(programImage *image, FILE *fileIn, int archSelect, int deviceIndex, const char *labelPrefix);
+
+/* Disassembles the program image with address labels, assembles the
+ * disassembly again, and prints every word that doesn't assemble back to
+ * its original value. Returns the number of such words, or a negative
+ * error code. */
+int verifyRoundTrip(FILE *fileOut, const programImage *image, formattingOptions fOptions, int archSelect);
+
+#endif
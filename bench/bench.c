@@ -0,0 +1,322 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * bench.c - Throughput benchmark of the disassembler stages: parsing the
+ *  program file, decoding the instructions, formatting the disassembly and
+ *  writing it out, timed separately for every program file.
+ *
+ *  $ bench -a midrange -r 5 midrange-64k.hex > results.jsonl
+ *
+ *  Every stage of every file is printed as a JSON object on its own line,
+ *  and as a table on standard error.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <time.h>
+#include "pic_disasm.h"
+#include "format.h"
+#include "image.h"
+#include "file.h"
+#include "errorcodes.h"
+
+/* Result of a benchmarked stage */
+struct _stageResult {
+	const char *stage;
+	/* Best time of the repetitions, in seconds */
+	double seconds;
+	/* Bytes and instructions processed per repetition */
+	long bytes;
+	long instructions;
+};
+typedef struct _stageResult stageResult;
+
+static const char *archNames[] = {"baseline", "midrange", "enhanced"};
+
+/* Monotonic time in seconds */
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+/* Reads a whole file into memory. */
+static char *loadFile(const char *fileName, long *size) {
+	FILE *fileIn;
+	char *data;
+
+	fileIn = fopen(fileName, "rb");
+	if (fileIn == NULL) {
+		perror("Error: Cannot open program file");
+		return NULL;
+	}
+	fseek(fileIn, 0, SEEK_END);
+	*size = ftell(fileIn);
+	fseek(fileIn, 0, SEEK_SET);
+	data = malloc(*size + 1);
+	if (data != NULL && fread(data, 1, *size, fileIn) != (size_t)*size) {
+		free(data);
+		data = NULL;
+	}
+	fclose(fileIn);
+	if (data == NULL)
+		fprintf(stderr, "Error reading program file %s!\n", fileName);
+	return data;
+}
+
+/* Parses a program file held in memory into a program image. */
+static int parseProgramFile(programImage *image, char *data, long size) {
+	FILE *fileIn;
+	int retVal;
+
+	fileIn = fmemopen(data, size, "r");
+	if (fileIn == NULL)
+		return ERROR_FILE_READING_ERROR;
+	initProgramImage(image);
+	if (data[0] == 'S')
+		retVal = readSRecordFile(image, fileIn);
+	else
+		retVal = readIHexFile(image, fileIn);
+	fclose(fileIn);
+	return retVal;
+}
+
+/* Prints a stage result as a JSON object and as a table row. */
+static void printResult(FILE *out, const char *fileName, int archSelect, const stageResult *result) {
+	double mbps = (result->seconds > 0) ? result->bytes/result->seconds/1e6 : 0;
+	double ips = (result->seconds > 0) ? result->instructions/result->seconds : 0;
+
+	fprintf(out, "{\"file\": \"%s\", \"arch\": \"%s\", \"stage\": \"%s\", \"bytes\": %ld, \"instructions\": %ld, \"seconds\": %.6f, \"MBps\": %.2f, \"instructionsPerSecond\": %.0f}\n",
+		fileName, archNames[archSelect], result->stage, result->bytes, result->instructions, result->seconds, mbps, ips);
+	fprintf(stderr, "  %-10s %10ld bytes %9ld instr %10.6f s %9.2f MB/s %12.0f instr/s\n",
+		result->stage, result->bytes, result->instructions, result->seconds, mbps, ips);
+}
+
+/* Runs every stage over a program file, keeping the best time of the
+ * repetitions. */
+static int benchmarkFile(FILE *out, const char *fileName, int archSelect, int repetitions, formattingOptions fOptions) {
+	stageResult results[5];
+	programImage image;
+	disassembledInstruction *dInstructions = NULL;
+	char *data, *text = NULL;
+	size_t textSize = 0;
+	long size;
+	FILE *textOut, *nullOut = NULL, *tempOut = NULL;
+	double start, elapsed;
+	int r, i, retVal = 0;
+
+	data = loadFile(fileName, &size);
+	if (data == NULL)
+		return ERROR_FILE_READING_ERROR;
+	if (size == 0) {
+		fprintf(stderr, "Error: Program file %s is empty!\n", fileName);
+		free(data);
+		return ERROR_FILE_READING_ERROR;
+	}
+
+	for (i = 0; i < 5; i++)
+		results[i].seconds = -1;
+	results[0].stage = "parse";
+	results[1].stage = "decode";
+	results[2].stage = "format";
+	results[3].stage = "output";
+	results[4].stage = "total";
+
+	/* Parsing, from the file in memory into a program image */
+	initProgramImage(&image);
+	for (r = 0; r < repetitions && retVal == 0; r++) {
+		freeProgramImage(&image);
+		start = now();
+		retVal = parseProgramFile(&image, data, size);
+		elapsed = now() - start;
+		if (results[0].seconds < 0 || elapsed < results[0].seconds)
+			results[0].seconds = elapsed;
+	}
+	results[0].bytes = size;
+	results[0].instructions = image.numInstructions;
+
+	/* Decoding, into an array of disassembled instructions */
+	if (retVal == 0) {
+		dInstructions = malloc(sizeof(disassembledInstruction)*(image.numInstructions+1));
+		if (dInstructions == NULL)
+			retVal = ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+	for (r = 0; r < repetitions && retVal == 0; r++) {
+		start = now();
+		for (i = 0; i < image.numInstructions && retVal == 0; i++)
+			retVal = disassembleInstruction(&dInstructions[i], &image.instructions[i], archSelect);
+		elapsed = now() - start;
+		if (results[1].seconds < 0 || elapsed < results[1].seconds)
+			results[1].seconds = elapsed;
+	}
+	results[1].bytes = 2*image.numInstructions;
+	results[1].instructions = image.numInstructions;
+
+	/* Formatting, of the decoded instructions into a stream that
+	 * discards the text, so no time is spent writing it */
+	if (retVal == 0) {
+		nullOut = fopen("/dev/null", "w");
+		textOut = open_memstream(&text, &textSize);
+		if (nullOut == NULL || textOut == NULL) {
+			perror("Error: Cannot open benchmark output");
+			retVal = ERROR_FILE_WRITING_ERROR;
+		} else {
+			/* Keep the text once for the output stage */
+			for (i = 0; i < image.numInstructions && retVal >= 0; i++)
+				retVal = printDisassembledInstruction(textOut, &image.instructions[i], &dInstructions[i], fOptions);
+			fclose(textOut);
+			retVal = (retVal < 0) ? retVal : 0;
+		}
+	}
+	for (r = 0; r < repetitions && retVal == 0; r++) {
+		start = now();
+		for (i = 0; i < image.numInstructions && retVal >= 0; i++)
+			retVal = printDisassembledInstruction(nullOut, &image.instructions[i], &dInstructions[i], fOptions);
+		fflush(nullOut);
+		elapsed = now() - start;
+		retVal = (retVal < 0) ? retVal : 0;
+		if (results[2].seconds < 0 || elapsed < results[2].seconds)
+			results[2].seconds = elapsed;
+	}
+	results[2].bytes = textSize;
+	results[2].instructions = image.numInstructions;
+
+	/* Output, of the formatted text to a temporary file */
+	if (retVal == 0) {
+		tempOut = tmpfile();
+		if (tempOut == NULL) {
+			perror("Error: Cannot open temporary file");
+			retVal = ERROR_FILE_WRITING_ERROR;
+		}
+	}
+	for (r = 0; r < repetitions && retVal == 0; r++) {
+		rewind(tempOut);
+		start = now();
+		if (fwrite(text, 1, textSize, tempOut) != textSize || fflush(tempOut) != 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		elapsed = now() - start;
+		if (results[3].seconds < 0 || elapsed < results[3].seconds)
+			results[3].seconds = elapsed;
+	}
+	results[3].bytes = textSize;
+	results[3].instructions = image.numInstructions;
+
+	/* Everything together, the way vpicdisasm disassembles a file */
+	for (r = 0; r < repetitions && retVal == 0; r++) {
+		programImage totalImage;
+
+		rewind(tempOut);
+		start = now();
+		retVal = parseProgramFile(&totalImage, data, size);
+		if (retVal == 0)
+			retVal = disassembleProgramImage(tempOut, &totalImage, fOptions, archSelect);
+		if (retVal == 0 && fflush(tempOut) != 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		elapsed = now() - start;
+		freeProgramImage(&totalImage);
+		if (results[4].seconds < 0 || elapsed < results[4].seconds)
+			results[4].seconds = elapsed;
+	}
+	results[4].bytes = size;
+	results[4].instructions = image.numInstructions;
+
+	if (retVal == 0) {
+		fprintf(stderr, "%s (%s, %d words):\n", fileName, archNames[archSelect], image.numInstructions);
+		for (i = 0; i < 5; i++)
+			printResult(out, fileName, archSelect, &results[i]);
+	} else {
+		fprintf(stderr, "Error benchmarking program file %s!\n", fileName);
+	}
+
+	if (tempOut != NULL)
+		fclose(tempOut);
+	if (nullOut != NULL)
+		fclose(nullOut);
+	free(text);
+	free(dInstructions);
+	freeProgramImage(&image);
+	free(data);
+
+	return retVal;
+}
+
+int main(int argc, char *argv[]) {
+	int archSelect = PIC_MIDRANGE, repetitions = 3, optc, failed = 0;
+	formattingOptions fOptions;
+	FILE *out = stdout;
+
+	while ((optc = getopt(argc, argv, "a:r:o:h")) != -1) {
+		switch (optc) {
+			case 'a':
+				if (strcasecmp(optarg, "baseline") == 0)
+					archSelect = PIC_BASELINE;
+				else if (strcasecmp(optarg, "midrange") == 0)
+					archSelect = PIC_MIDRANGE;
+				else if (strcasecmp(optarg, "enhanced") == 0)
+					archSelect = PIC_MIDRANGE_ENHANCED;
+				else {
+					fprintf(stderr, "Unknown architecture %s.\n", optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'r':
+				repetitions = atoi(optarg);
+				if (repetitions < 1)
+					repetitions = 1;
+				break;
+			case 'o':
+				out = fopen(optarg, "a");
+				if (out == NULL) {
+					perror("Error: Cannot open results file");
+					exit(EXIT_FAILURE);
+				}
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-a <architecture>] [-r <repetitions>] [-o <results file>] <program file(s)>\n", argv[0]);
+				exit((optc == 'h') ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+	if (optind == argc) {
+		fprintf(stderr, "Error: No program file specified!\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* The default formatting options of vpicdisasm */
+	memset(&fOptions, 0, sizeof(fOptions));
+	fOptions.options = FORMAT_OPTION_ADDRESS | FORMAT_OPTION_DESTINATION_ADDRESS_COMMENT | FORMAT_OPTION_LITERAL_HEX;
+	fOptions.addressFieldWidth = 3;
+	fOptions.deviceIndex = -1;
+	fOptions.signatures = NULL;
+	fOptions.outputFormat = OUTPUT_FORMAT_TEXT;
+
+	for (; optind < argc; optind++) {
+		if (benchmarkFile(out, argv[optind], archSelect, repetitions, fOptions) < 0)
+			failed = 1;
+	}
+
+	if (out != stdout)
+		fclose(out);
+	exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
@@ -0,0 +1,240 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * genfirmware.c - Generator of reproducible synthetic program files for the
+ *  benchmarks, with an instruction mix resembling compiled PIC firmware.
+ *
+ *  $ genfirmware -a midrange -t ihex -n 65536 -s 1 -o midrange-64k.hex
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include "libGIS-1.0.5/ihex.h"
+#include "libGIS-1.0.5/srecord.h"
+#include "pic_disasm.h"
+
+extern instructionSetInfo allInstructionSets[];
+
+/* Data bytes per record, as written by the usual PIC toolchains */
+#define RECORD_DATA_LEN		16
+
+/* Relative frequency of the instructions in compiled firmware; the
+ * instructions not listed here get a weight of 1, and mnemonics missing
+ * from an instruction set are ignored. */
+static const struct {
+	const char *mnemonic;
+	int weight;
+} instructionWeights[] = {
+	{"movwf", 12}, {"movf", 10}, {"movlw", 10}, {"bcf", 6}, {"bsf", 6},
+	{"btfsc", 6}, {"btfss", 6}, {"goto", 5}, {"call", 5}, {"clrf", 4},
+	{"retlw", 4}, {"movlb", 4}, {"return", 3}, {"addwf", 3}, {"bra", 3},
+	{"subwf", 2}, {"andlw", 2}, {"incf", 2}, {"decf", 2}, {"decfsz", 2},
+	{"andwf", 2}, {"iorwf", 2}, {"nop", 2}, {"movlp", 2}, {"moviw", 2},
+	{"movwi", 2}, {"data", 2},
+	{NULL, 0}
+};
+
+/* Word masks of the cores, for the data words */
+static const uint16_t wordMasks[] = {0x0FFF, 0x3FFF, 0x3FFF};
+
+/* Reproducible pseudo-random numbers (xorshift32) */
+static uint32_t randomState;
+static uint32_t nextRandom(void) {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static void printUsage(FILE *stream, const char *programName) {
+	fprintf(stream, "Usage: %s [-a <architecture>] [-t <file type>] [-n <words>] [-s <seed>] [-o <output file>]\n", programName);
+	fprintf(stream, "  -a <architecture>	baseline, midrange (default) or enhanced\n");
+	fprintf(stream, "  -t <file type>		ihex (default) or srecord\n");
+	fprintf(stream, "  -n <words>		Number of program words (default 1024)\n");
+	fprintf(stream, "  -s <seed>		Seed of the instruction mix (default 1)\n");
+}
+
+/* Writes a block of data bytes as Intel HEX records, with extended linear
+ * address records whenever the upper address bits change. */
+static int writeIHexData(FILE *out, uint32_t address, const uint8_t *data, int dataLen, uint32_t *upperAddress) {
+	IHexRecord irec;
+	uint8_t upper[2];
+
+	if ((address >> 16) != *upperAddress) {
+		*upperAddress = address >> 16;
+		upper[0] = (*upperAddress >> 8) & 0xFF;
+		upper[1] = *upperAddress & 0xFF;
+		if (New_IHexRecord(IHEX_TYPE_04, 0, upper, 2, &irec) != IHEX_OK || Write_IHexRecord(&irec, out) != IHEX_OK)
+			return -1;
+	}
+	if (New_IHexRecord(IHEX_TYPE_00, address & 0xFFFF, data, dataLen, &irec) != IHEX_OK || Write_IHexRecord(&irec, out) != IHEX_OK)
+		return -1;
+	return 0;
+}
+
+/* Writes a block of data bytes as an S-Record with the smallest address
+ * field that fits the whole file. */
+static int writeSRecordData(FILE *out, uint32_t address, const uint8_t *data, int dataLen, int type) {
+	SRecord srec;
+
+	if (New_SRecord(type, address, data, dataLen, &srec) != SRECORD_OK || Write_SRecord(&srec, out) != SRECORD_OK)
+		return -1;
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	int archSelect = PIC_MIDRANGE, srecord = 0;
+	long numWords = 1024, i;
+	uint32_t seed = 1;
+	FILE *out = stdout;
+	instructionInfo *instructionSet;
+	int numInstructions, weights[PIC_TOTAL_PIC18_INSTRUCTIONS], totalWeight;
+	uint16_t operandBits, opcode;
+	uint8_t data[RECORD_DATA_LEN];
+	int dataLen, srecordType, retVal, optc, j, k, pick;
+	uint32_t upperAddress = 0, address;
+	IHexRecord irec;
+	SRecord srec;
+
+	while ((optc = getopt(argc, argv, "a:t:n:s:o:h")) != -1) {
+		switch (optc) {
+			case 'a':
+				if (strcasecmp(optarg, "baseline") == 0)
+					archSelect = PIC_BASELINE;
+				else if (strcasecmp(optarg, "midrange") == 0)
+					archSelect = PIC_MIDRANGE;
+				else if (strcasecmp(optarg, "enhanced") == 0)
+					archSelect = PIC_MIDRANGE_ENHANCED;
+				else {
+					fprintf(stderr, "Unknown architecture %s.\n", optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 't':
+				if (strcasecmp(optarg, "ihex") == 0)
+					srecord = 0;
+				else if (strcasecmp(optarg, "srecord") == 0)
+					srecord = 1;
+				else {
+					fprintf(stderr, "Unknown file type %s.\n", optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'n':
+				numWords = strtol(optarg, NULL, 0);
+				break;
+			case 's':
+				seed = strtoul(optarg, NULL, 0);
+				break;
+			case 'o':
+				out = fopen(optarg, "w");
+				if (out == NULL) {
+					perror("Error: Cannot open output file");
+					exit(EXIT_FAILURE);
+				}
+				break;
+			default:
+				printUsage(stderr, argv[0]);
+				exit((optc == 'h') ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+	if (numWords <= 0 || numWords > 0x7FFFFFFFL/2) {
+		fprintf(stderr, "Invalid number of words.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* xorshift has a fixed point at zero */
+	randomState = (seed != 0) ? seed : 0x9E3779B9;
+
+	instructionSet = allInstructionSets[archSelect].instructionSet;
+	numInstructions = allInstructionSets[archSelect].numInstructions;
+	totalWeight = 0;
+	for (j = 0; j < numInstructions; j++) {
+		weights[j] = 1;
+		for (k = 0; instructionWeights[k].mnemonic != NULL; k++) {
+			if (strcmp(instructionWeights[k].mnemonic, instructionSet[j].mnemonic) == 0)
+				weights[j] = instructionWeights[k].weight;
+		}
+		totalWeight += weights[j];
+	}
+
+	/* Byte addresses past 64K need wider S-Record address fields */
+	if (2*numWords <= 0x10000)
+		srecordType = SRECORD_TYPE_S1;
+	else if (2*numWords <= 0x1000000)
+		srecordType = SRECORD_TYPE_S2;
+	else
+		srecordType = SRECORD_TYPE_S3;
+
+	retVal = 0;
+	dataLen = 0;
+	address = 0;
+	for (i = 0; i < numWords && retVal == 0; i++) {
+		/* Pick an instruction by weight, and fill its operand bits */
+		pick = nextRandom() % totalWeight;
+		for (j = 0; pick >= weights[j]; j++)
+			pick -= weights[j];
+
+		if (j == numInstructions-1) {
+			opcode = nextRandom() & wordMasks[archSelect];
+		} else {
+			operandBits = 0;
+			for (k = 0; k < instructionSet[j].numOperands; k++)
+				operandBits |= instructionSet[j].operandMasks[k];
+			opcode = instructionSet[j].opcodeMask | (nextRandom() & operandBits);
+		}
+
+		/* Assembled PIC program is stored in little-endian. */
+		data[dataLen++] = opcode & 0xFF;
+		data[dataLen++] = opcode >> 8;
+		if (dataLen == RECORD_DATA_LEN || i == numWords-1) {
+			if (srecord)
+				retVal = writeSRecordData(out, address, data, dataLen, srecordType);
+			else
+				retVal = writeIHexData(out, address, data, dataLen, &upperAddress);
+			address += dataLen;
+			dataLen = 0;
+		}
+	}
+
+	/* Terminating record */
+	if (retVal == 0) {
+		if (srecord) {
+			if (New_SRecord(SRECORD_TYPE_S9 - (srecordType - SRECORD_TYPE_S1), 0, NULL, 0, &srec) != SRECORD_OK || Write_SRecord(&srec, out) != SRECORD_OK)
+				retVal = -1;
+		} else {
+			if (New_IHexRecord(IHEX_TYPE_01, 0, NULL, 0, &irec) != IHEX_OK || Write_IHexRecord(&irec, out) != IHEX_OK)
+				retVal = -1;
+		}
+	}
+
+	if (fclose(out) != 0)
+		retVal = -1;
+	if (retVal < 0) {
+		fprintf(stderr, "Error writing program file!\n");
+		exit(EXIT_FAILURE);
+	}
+
+	exit(EXIT_SUCCESS);
+}
+
@@ -0,0 +1,230 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * cache.c - Content addressed cache of disassembly results. Every result
+ *  is a file named by the hash of its key in the cache directory, written
+ *  to a temporary file first and renamed into place when complete.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#include "cache.h"
+#include "errorcodes.h"
+
+#define CACHE_PRIME1	0x9E3779B185EBCA87ULL
+#define CACHE_PRIME2	0xC2B2AE3D27D4EB4FULL
+#define CACHE_PRIME3	0x165667B19E3779F9ULL
+
+/* Formats the path of the entry of a key into path. */
+static void cacheEntryPath(char *path, const char *directory, const cacheKey *key);
+
+
+static inline uint64_t rotateLeft(uint64_t x, int n) {
+	return (x << n) | (x >> (64-n));
+}
+
+/* Final mixing of a hash lane, so that every input bit affects every
+ * output bit. */
+static uint64_t mixLane(uint64_t x) {
+	x ^= x >> 33;
+	x *= CACHE_PRIME2;
+	x ^= x >> 29;
+	x *= CACHE_PRIME3;
+	x ^= x >> 32;
+	return x;
+}
+
+/* Initializes a cache key with nothing hashed yet. */
+void initCacheKey(cacheKey *key) {
+	key->lanes[0] = CACHE_PRIME1;
+	key->lanes[1] = CACHE_PRIME2;
+	key->length = 0;
+}
+
+/* Hashes data into a cache key, eight bytes at a time into two lanes. The
+ * size is hashed too, so consecutive calls can't run into each other. */
+void hashCacheKey(cacheKey *key, const void *data, size_t size) {
+	const unsigned char *p = data;
+	uint64_t block;
+	size_t i;
+
+	for (i = 0; i+8 <= size; i += 8) {
+		memcpy(&block, p+i, sizeof(block));
+		key->lanes[0] = rotateLeft(key->lanes[0] ^ (block * CACHE_PRIME2), 31) * CACHE_PRIME1;
+		key->lanes[1] = rotateLeft(key->lanes[1] + (block * CACHE_PRIME3), 27) * CACHE_PRIME1 + key->lanes[0];
+	}
+
+	/* The last bytes, and the size */
+	block = size;
+	memcpy(&block, p+i, size-i);
+	block ^= (uint64_t)(size-i) << 56;
+	key->lanes[0] = rotateLeft(key->lanes[0] ^ (block * CACHE_PRIME2), 31) * CACHE_PRIME1;
+	key->lanes[1] = rotateLeft(key->lanes[1] + (block * CACHE_PRIME3), 27) * CACHE_PRIME1 + key->lanes[0];
+	key->lanes[0] ^= size * CACHE_PRIME3;
+	key->length += size;
+}
+
+/* Reads the rest of a file into a newly allocated buffer, which must be
+ * free'd after it has been used. */
+int readWholeFile(FILE *fileIn, char **data, size_t *size) {
+	size_t capacity, n;
+	char *grown;
+
+	capacity = 65536;
+	*size = 0;
+	*data = malloc(capacity);
+	if (*data == NULL)
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+
+	while ((n = fread(*data + *size, 1, capacity - *size, fileIn)) > 0) {
+		*size += n;
+		if (*size == capacity) {
+			grown = realloc(*data, 2*capacity);
+			if (grown == NULL) {
+				free(*data);
+				return ERROR_MEMORY_ALLOCATION_ERROR;
+			}
+			*data = grown;
+			capacity *= 2;
+		}
+	}
+
+	if (ferror(fileIn)) {
+		free(*data);
+		return ERROR_FILE_READING_ERROR;
+	}
+
+	return 0;
+}
+
+/* Writes the cached result of a key to fileOut, with sendfile() if
+ * fileOut is a plain file descriptor. Returns 1 if there is a cached
+ * result, 0 if there is none, or a negative error code. */
+int copyCachedResult(FILE *fileOut, const char *directory, const cacheKey *key) {
+	char path[CACHE_MAX_PATH_LENGTH], buffer[65536];
+	struct stat st;
+	off_t offset;
+	ssize_t n;
+	int fd, outFd;
+
+	cacheEntryPath(path, directory, key);
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return (errno == ENOENT) ? 0 : ERROR_FILE_READING_ERROR;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return ERROR_FILE_READING_ERROR;
+	}
+
+	/* Anything already buffered goes first */
+	if (fflush(fileOut) != 0) {
+		close(fd);
+		return ERROR_FILE_WRITING_ERROR;
+	}
+
+	offset = 0;
+	outFd = fileno(fileOut);
+#ifdef __linux__
+	/* The kernel copies the file straight to the output, falling back
+	 * to the loop below for outputs it can't send to */
+	while (outFd >= 0 && offset < st.st_size) {
+		n = sendfile(outFd, fd, &offset, st.st_size - offset);
+		if (n <= 0)
+			break;
+	}
+#endif
+
+	if (lseek(fd, offset, SEEK_SET) < 0) {
+		close(fd);
+		return ERROR_FILE_READING_ERROR;
+	}
+	while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+		if (fwrite(buffer, 1, n, fileOut) != (size_t)n) {
+			close(fd);
+			return ERROR_FILE_WRITING_ERROR;
+		}
+	}
+	close(fd);
+	if (n < 0)
+		return ERROR_FILE_READING_ERROR;
+
+	return 1;
+}
+
+/* Creates the cache directory if needed, and a temporary file in it to
+ * write a new result to. tempPath receives the path of the temporary
+ * file. Returns NULL on failure. */
+FILE *createCacheEntry(const char *directory, char *tempPath) {
+	FILE *file;
+	int fd;
+
+	if (mkdir(directory, 0777) < 0 && errno != EEXIST)
+		return NULL;
+
+	/* Temporary files start with a dot, so they never collide with
+	 * the entries */
+	if (snprintf(tempPath, CACHE_MAX_PATH_LENGTH, "%s/.tmp-XXXXXX", directory) >= CACHE_MAX_PATH_LENGTH)
+		return NULL;
+	fd = mkstemp(tempPath);
+	if (fd < 0)
+		return NULL;
+	/* mkstemp() creates the file readable by the owner only */
+	fchmod(fd, 0644);
+
+	file = fdopen(fd, "w");
+	if (file == NULL) {
+		close(fd);
+		unlink(tempPath);
+	}
+
+	return file;
+}
+
+/* Moves a complete result from its temporary file to the entry of the key
+ * with rename(), so that concurrent runs see either no entry or the
+ * complete result. */
+int commitCacheEntry(const char *directory, const cacheKey *key, const char *tempPath) {
+	char path[CACHE_MAX_PATH_LENGTH];
+
+	cacheEntryPath(path, directory, key);
+	if (rename(tempPath, path) < 0) {
+		unlink(tempPath);
+		return ERROR_FILE_WRITING_ERROR;
+	}
+
+	return 0;
+}
+
+/* Formats the path of the entry of a key into path, the 128-bit hash in
+ * hexadecimal. */
+static void cacheEntryPath(char *path, const char *directory, const cacheKey *key) {
+	snprintf(path, CACHE_MAX_PATH_LENGTH, "%s/%016llx%016llx", directory,
+		(unsigned long long)mixLane(key->lanes[0] ^ key->length),
+		(unsigned long long)mixLane(key->lanes[1] + key->lanes[0]));
+}
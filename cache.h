@@ -0,0 +1,74 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * cache.h - Header file for the content addressed cache of disassembly
+ *  results, shared by concurrent runs through a cache directory.
+ *
+ */
+
+#ifndef CACHE_DISASM_H
+#define CACHE_DISASM_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Maximum length of the path of a cache entry */
+#define CACHE_MAX_PATH_LENGTH	1024
+
+/* Version of the output for the same input and options, hashed into every
+ * key so that results cached by an older build are never served. Bump it
+ * with every change that can alter the disassembly. */
+#define CACHE_OUTPUT_VERSION	2
+
+/* Structure to hold the key of a cached result while it is hashed: a
+ * 128-bit hash of the input bytes and everything else that determines
+ * the output. */
+struct _cacheKey {
+	uint64_t lanes[2];
+	uint64_t length;
+};
+typedef struct _cacheKey cacheKey;
+
+/* Initializes a cache key with nothing hashed yet. */
+void initCacheKey(cacheKey *key);
+
+/* Hashes data into a cache key. The size is hashed too, so consecutive
+ * calls can't run into each other. */
+void hashCacheKey(cacheKey *key, const void *data, size_t size);
+
+/* Reads the rest of a file into a newly allocated buffer, which must be
+ * free'd after it has been used. */
+int readWholeFile(FILE *fileIn, char **data, size_t *size);
+
+/* Writes the cached result of a key to fileOut, with sendfile() if
+ * fileOut is a plain file descriptor. Returns 1 if there is a cached
+ * result, 0 if there is none, or a negative error code. */
+int copyCachedResult(FILE *fileOut, const char *directory, const cacheKey *key);
+
+/* Creates the cache directory if needed, and a temporary file in it to
+ * write a new result to. tempPath receives the path of the temporary
+ * file. Returns NULL on failure. */
+FILE *createCacheEntry(const char *directory, char *tempPath);
+
+/* Moves a complete result from its temporary file to the entry of the key
+ * with rename(), so that concurrent runs see either no entry or the
+ * complete result. */
+int commitCacheEntry(const char *directory, const cacheKey *key, const char *tempPath);
+
+#endif
@@ -0,0 +1,224 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * decodecheck.c - Differential check of the instruction decoders: every
+ *  opcode word of every instruction set is decoded by each decoder and
+ *  compared with a straightforward reference decoder written from the
+ *  instruction set tables alone.
+ *
+ *  $ decodecheck [-v]
+ *
+ *  A faster decoder (a lookup table, a generated switch, ...) is added to
+ *  the decoders[] table below, and must agree with the reference on the
+ *  instruction and the operands of all 65536 opcode words, including the
+ *  first match priority between overlapping entries such as nop, option
+ *  and tris, and the don't care bits of the 12 and 14 bit cores.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pic_disasm.h"
+
+extern instructionSetInfo allInstructionSets[];
+
+/* Decoded instruction as compared by the check */
+struct _decodedWord {
+	int index;
+	int32_t operands[PIC_MAX_NUM_OPERANDS];
+};
+typedef struct _decodedWord decodedWord;
+
+/* A decoder under test, returns a negative number on error */
+typedef int (*decoderFunction)(decodedWord *decoded, uint16_t opcode, int archSelect);
+
+static const char *archNames[] = {"baseline", "midrange", "enhanced"};
+
+/* Reference decoder: the first entry of the instruction set whose fixed
+ * bits match wins, and every operand is gathered from its mask bit by bit,
+ * lowest bit first. Signed operands are two's complement over the width of
+ * their mask. */
+static int referenceDecode(decodedWord *decoded, uint16_t opcode, int archSelect) {
+	const instructionInfo *instructionSet = allInstructionSets[archSelect].instructionSet;
+	int numInstructions = allInstructionSets[archSelect].numInstructions;
+	const instructionInfo *instruction;
+	uint16_t operandBits, mask;
+	int i, j, bit, width;
+	int32_t value;
+
+	for (i = 0; i < numInstructions; i++) {
+		operandBits = 0;
+		for (j = 0; j < PIC_MAX_NUM_OPERANDS; j++)
+			operandBits |= instructionSet[i].operandMasks[j];
+		if ((opcode & ~operandBits) == instructionSet[i].opcodeMask)
+			break;
+	}
+	if (i == numInstructions)
+		return -1;
+
+	instruction = &instructionSet[i];
+	decoded->index = i;
+	memset(decoded->operands, 0, sizeof(decoded->operands));
+	for (j = 0; j < instruction->numOperands; j++) {
+		value = 0;
+		width = 0;
+		for (mask = instruction->operandMasks[j]; mask != 0; mask &= mask-1) {
+			bit = mask & -mask;
+			if (opcode & bit)
+				value |= 1 << width;
+			width++;
+		}
+		if ((instruction->operandTypes[j] == OPERAND_SIGNED_LITERAL || instruction->operandTypes[j] == OPERAND_RELATIVE_ADDRESS) &&
+		    width > 0 && (value & (1 << (width-1))) != 0)
+			value -= 1 << width;
+		decoded->operands[j] = value;
+	}
+
+	return 0;
+}
+
+/* The decoder of pic_disasm.c */
+static int disassembleDecode(decodedWord *decoded, uint16_t opcode, int archSelect) {
+	disassembledInstruction dInstruction;
+	assembledInstruction aInstruction;
+	int i, retVal;
+
+	aInstruction.address = 0;
+	aInstruction.opcode = opcode;
+	retVal = disassembleInstruction(&dInstruction, &aInstruction, archSelect);
+	if (retVal < 0)
+		return retVal;
+
+	decoded->index = dInstruction.instruction - allInstructionSets[archSelect].instructionSet;
+	memset(decoded->operands, 0, sizeof(decoded->operands));
+	for (i = 0; i < dInstruction.instruction->numOperands; i++)
+		decoded->operands[i] = dInstruction.operands[i];
+
+	return 0;
+}
+
+/* Decoders checked against the reference */
+static const struct {
+	const char *name;
+	decoderFunction decode;
+} decoders[] = {
+	{"disassembleInstruction", disassembleDecode},
+	{NULL, NULL}
+};
+
+/* Checks the instruction set tables themselves: the last entry must be the
+ * data word that matches any opcode. With verbose, prints how many opcodes
+ * every entry decodes, and how many it would have matched but lost to an
+ * earlier entry. */
+static int checkInstructionSet(int archSelect, int verbose) {
+	const instructionInfo *instructionSet = allInstructionSets[archSelect].instructionSet;
+	int numInstructions = allInstructionSets[archSelect].numInstructions;
+	long decodedCounts[PIC_TOTAL_PIC18_INSTRUCTIONS], shadowedCounts[PIC_TOTAL_PIC18_INSTRUCTIONS];
+	decodedWord decoded;
+	uint16_t operandBits;
+	long opcode, unmatched = 0;
+	int i, j, failed = 0;
+
+	if (strcmp(instructionSet[numInstructions-1].mnemonic, "data") != 0 || instructionSet[numInstructions-1].opcodeMask != 0) {
+		fprintf(stderr, "%s: last instruction set entry is not the data word!\n", archNames[archSelect]);
+		failed = 1;
+	}
+
+	memset(decodedCounts, 0, sizeof(decodedCounts));
+	memset(shadowedCounts, 0, sizeof(shadowedCounts));
+	for (opcode = 0; opcode <= 0xFFFF; opcode++) {
+		if (referenceDecode(&decoded, opcode, archSelect) < 0) {
+			if (unmatched++ < 10)
+				fprintf(stderr, "%s: opcode %04lX matches no instruction!\n", archNames[archSelect], opcode);
+			failed = 1;
+			continue;
+		}
+		decodedCounts[decoded.index]++;
+		for (i = decoded.index+1; i < numInstructions-1; i++) {
+			operandBits = 0;
+			for (j = 0; j < PIC_MAX_NUM_OPERANDS; j++)
+				operandBits |= instructionSet[i].operandMasks[j];
+			if ((opcode & ~operandBits) == instructionSet[i].opcodeMask)
+				shadowedCounts[i]++;
+		}
+	}
+
+	if (verbose) {
+		printf("%s instruction set:\n", archNames[archSelect]);
+		for (i = 0; i < numInstructions; i++)
+			printf("  %-8s %6ld opcodes  %6ld shadowed\n", instructionSet[i].mnemonic, decodedCounts[i], shadowedCounts[i]);
+	}
+
+	return failed;
+}
+
+/* Compares a decoder with the reference over all opcode words, printing
+ * the first few mismatches. Returns the number of mismatches. */
+static long checkDecoder(const char *name, decoderFunction decode, int archSelect) {
+	const instructionInfo *instructionSet = allInstructionSets[archSelect].instructionSet;
+	decodedWord expected, actual;
+	long opcode, mismatches = 0;
+	int i, same;
+
+	for (opcode = 0; opcode <= 0xFFFF; opcode++) {
+		if (referenceDecode(&expected, opcode, archSelect) < 0)
+			continue;
+		same = (decode(&actual, opcode, archSelect) == 0 && actual.index == expected.index);
+		for (i = 0; same && i < PIC_MAX_NUM_OPERANDS; i++)
+			same = (actual.operands[i] == expected.operands[i]);
+		if (same)
+			continue;
+
+		if (mismatches++ < 10) {
+			fprintf(stderr, "%s: %s: opcode %04lX decoded as %s %d, %d, %d, expected %s %d, %d, %d\n",
+				name, archNames[archSelect], opcode,
+				(actual.index >= 0 && actual.index < allInstructionSets[archSelect].numInstructions) ? instructionSet[actual.index].mnemonic : "?",
+				actual.operands[0], actual.operands[1], actual.operands[2],
+				instructionSet[expected.index].mnemonic,
+				expected.operands[0], expected.operands[1], expected.operands[2]);
+		}
+	}
+
+	return mismatches;
+}
+
+int main(int argc, char *argv[]) {
+	int verbose = 0, failed = 0, archSelect, d;
+	long mismatches;
+
+	if (argc > 1 && strcmp(argv[1], "-v") == 0)
+		verbose = 1;
+
+	for (archSelect = PIC_BASELINE; archSelect <= PIC_MIDRANGE_ENHANCED; archSelect++) {
+		if (checkInstructionSet(archSelect, verbose))
+			failed = 1;
+		for (d = 0; decoders[d].name != NULL; d++) {
+			mismatches = checkDecoder(decoders[d].name, decoders[d].decode, archSelect);
+			printf("%-24s %-9s %s", decoders[d].name, archNames[archSelect], (mismatches == 0) ? "ok\n" : "FAILED");
+			if (mismatches != 0) {
+				printf(" (%ld of 65536 opcodes differ)\n", mismatches);
+				failed = 1;
+			}
+		}
+	}
+
+	exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
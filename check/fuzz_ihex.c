@@ -0,0 +1,52 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * fuzz_ihex.c - Fuzzing entry point for the Intel HEX8 reader of libGIS,
+ *  Read_IHexRecord(). Built with libFuzzer by make fuzz, or with the standalone
+ *  driver of fuzz_main.c by make check.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "libGIS-1.0.5/ihex.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/* Reads records from the input until the end of it or the first invalid
+ * record, the same way readIHexFile() and readSRecordFile() do. */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+	IHexRecord record;
+	FILE *in;
+	int retVal;
+
+	if (size == 0)
+		return 0;
+	in = fmemopen((void *)data, size, "r");
+	if (in == NULL)
+		return 0;
+	do {
+		retVal = Read_IHexRecord(&record, in);
+	} while (retVal == IHEX_OK || retVal == IHEX_ERROR_NEWLINE);
+	fclose(in);
+
+	return 0;
+}
+
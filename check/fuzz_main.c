@@ -0,0 +1,197 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * fuzz_main.c - Standalone driver for the fuzzing entry points, for
+ *  compilers without libFuzzer. Runs the entry point over the files given
+ *  on the command line, or over a number of pseudo-random mutations of a
+ *  few valid records.
+ *
+ *  $ fuzz_ihex crash-file...
+ *  $ fuzz_ihex -n 100000 -s 1
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/* Largest mutated input */
+#define FUZZ_MAX_INPUT_SIZE	2048
+
+/* Valid records of both formats to start the mutations from */
+static const char *seedInputs[] = {
+	":100000000030660028000000000000000000000015\r\n:00000001FF\r\n",
+	":020000040001F9\n:0400000001000200F9\n:00000001FF\n",
+	"S1130000003066002800000000000000000000008E\nS9030000FC\n",
+	"S21400000000011E0001D01FB23EF4003708AE09B10052\nS804000000FB\n",
+	"\n\n:\nS\n",
+	NULL
+};
+
+/* Characters the mutations insert, the ones the readers care about */
+static const char interestingCharacters[] = "0123456789ABCDEFabcdef:S\r\n-+ x\0";
+
+/* Reproducible pseudo-random numbers (xorshift32) */
+static uint32_t randomState;
+static uint32_t nextRandom(void) {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+/* Applies a few random edits to the input: overwriting, inserting and
+ * deleting characters, and duplicating or truncating the tail. */
+static size_t mutateInput(uint8_t *data, size_t size) {
+	int numEdits, i;
+	size_t position, length;
+
+	numEdits = 1 + nextRandom() % 8;
+	for (i = 0; i < numEdits; i++) {
+		position = (size > 0) ? nextRandom() % size : 0;
+		switch (nextRandom() % 6) {
+			case 0:
+				if (size > 0)
+					data[position] = nextRandom() & 0xFF;
+				break;
+			case 1:
+				if (size > 0)
+					data[position] = interestingCharacters[nextRandom() % sizeof(interestingCharacters)];
+				break;
+			case 2:
+				if (size < FUZZ_MAX_INPUT_SIZE) {
+					memmove(data+position+1, data+position, size-position);
+					data[position] = interestingCharacters[nextRandom() % sizeof(interestingCharacters)];
+					size++;
+				}
+				break;
+			case 3:
+				if (size > 0) {
+					memmove(data+position, data+position+1, size-position-1);
+					size--;
+				}
+				break;
+			case 4:
+				length = size - position;
+				if (size + length > FUZZ_MAX_INPUT_SIZE)
+					length = FUZZ_MAX_INPUT_SIZE - size;
+				memcpy(data+size, data+position, length);
+				size += length;
+				break;
+			default:
+				size = position;
+				break;
+		}
+	}
+
+	return size;
+}
+
+/* Runs the entry point over a file. */
+static int runFile(const char *fileName) {
+	FILE *fileIn;
+	uint8_t *data;
+	long size;
+
+	fileIn = fopen(fileName, "rb");
+	if (fileIn == NULL) {
+		perror("Error: Cannot open input file");
+		return -1;
+	}
+	fseek(fileIn, 0, SEEK_END);
+	size = ftell(fileIn);
+	fseek(fileIn, 0, SEEK_SET);
+	data = malloc(size + 1);
+	if (data == NULL || fread(data, 1, size, fileIn) != (size_t)size) {
+		fprintf(stderr, "Error reading input file %s!\n", fileName);
+		free(data);
+		fclose(fileIn);
+		return -1;
+	}
+	fclose(fileIn);
+
+	LLVMFuzzerTestOneInput(data, size);
+	free(data);
+
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	uint8_t *data;
+	size_t size;
+	long numRuns = 10000, run;
+	uint32_t seed = 1;
+	int optc, failed = 0, numSeeds;
+
+	while ((optc = getopt(argc, argv, "n:s:h")) != -1) {
+		switch (optc) {
+			case 'n':
+				numRuns = strtol(optarg, NULL, 0);
+				break;
+			case 's':
+				seed = strtoul(optarg, NULL, 0);
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-n <runs>] [-s <seed>] [input file(s)]\n", argv[0]);
+				exit((optc == 'h') ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+
+	/* Replay the inputs given */
+	if (optind < argc) {
+		for (; optind < argc; optind++) {
+			if (runFile(argv[optind]) < 0)
+				failed = 1;
+		}
+		exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+	}
+
+	for (numSeeds = 0; seedInputs[numSeeds] != NULL; numSeeds++)
+		;
+
+	/* The entry point gets an exactly sized copy of every input, so
+	 * memory checkers catch reads past its end */
+	randomState = (seed != 0) ? seed : 0x9E3779B9;
+	data = malloc(2*FUZZ_MAX_INPUT_SIZE);
+	if (data == NULL)
+		exit(EXIT_FAILURE);
+	for (run = 0; run < numRuns; run++) {
+		uint8_t *input;
+
+		size = strlen(seedInputs[run % numSeeds]);
+		memcpy(data, seedInputs[run % numSeeds], size);
+		size = mutateInput(data, size);
+
+		input = malloc(size + 1);
+		if (input == NULL)
+			exit(EXIT_FAILURE);
+		memcpy(input, data, size);
+		LLVMFuzzerTestOneInput(input, size);
+		free(input);
+	}
+	free(data);
+
+	printf("%s: %ld inputs ok\n", argv[0], numRuns);
+	exit(EXIT_SUCCESS);
+}
+
@@ -0,0 +1,263 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * columns.c - Columnar export of the decoded instructions of many program
+ *  images, one fixed width little endian file per column, for analytics
+ *  tools that map the columns instead of parsing disassembly text.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "pic_disasm.h"
+#include "pic_device.h"
+#include "image.h"
+#include "columns.h"
+#include "errorcodes.h"
+
+extern instructionSetInfo allInstructionSets[];
+
+/* Order of the columns in the columnExport */
+enum Columns_Index {
+	COLUMN_ADDRESS,
+	COLUMN_OPCODE,
+	COLUMN_INSTRUCTION,
+	COLUMN_OPERAND0,
+	COLUMN_OPERAND1,
+	COLUMN_OPERAND2,
+	COLUMN_REGION,
+	COLUMN_IMAGE,
+};
+
+static const char *columnNames[COLUMNS_NUM_COLUMNS] = {"address", "opcode", "instruction", "operand0", "operand1", "operand2", "region", "image"};
+static const char *columnTypes[COLUMNS_NUM_COLUMNS] = {"uint32", "uint16", "uint8", "int32", "int32", "int32", "uint8", "uint32"};
+static const int columnWidths[COLUMNS_NUM_COLUMNS] = {4, 2, 1, 4, 4, 4, 1, 4};
+
+static const char *archNames[] = {"baseline", "midrange", "enhanced"};
+
+/* Opens a file of the export directory. */
+static FILE *openExportFile(const columnExport *export, const char *name, const char *mode) {
+	char path[sizeof(export->directory) + 32];
+
+	snprintf(path, sizeof(path), "%s/%s", export->directory, name);
+	return fopen(path, mode);
+}
+
+/* Closes all files of an export, returns ERROR_FILE_WRITING_ERROR if any
+ * of them failed to be written. */
+static int closeExportFiles(columnExport *export) {
+	int i, retVal = 0;
+
+	for (i = 0; i < COLUMNS_NUM_COLUMNS; i++) {
+		if (export->columns[i] != NULL && fclose(export->columns[i]) != 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		export->columns[i] = NULL;
+	}
+	if (export->images != NULL && fclose(export->images) != 0)
+		retVal = ERROR_FILE_WRITING_ERROR;
+	export->images = NULL;
+	free(export->chunk);
+	export->chunk = NULL;
+
+	return retVal;
+}
+
+/* Creates the export directory if it doesn't exist and opens the column
+ * files. deviceIndex is -1 if no device is selected. */
+int openColumnExport(columnExport *export, const char *directory, int archSelect, int deviceIndex) {
+	char name[32];
+	int i;
+
+	if (export == NULL || directory == NULL)
+		return ERROR_INVALID_ARGUMENTS;
+	if (archSelect != PIC_BASELINE && archSelect != PIC_MIDRANGE && archSelect != PIC_MIDRANGE_ENHANCED)
+		return ERROR_INVALID_ARGUMENTS;
+	if (strlen(directory) >= sizeof(export->directory)) {
+		fprintf(stderr, "Error: Export directory name is too long!\n");
+		return ERROR_INVALID_ARGUMENTS;
+	}
+
+	memset(export, 0, sizeof(columnExport));
+	strcpy(export->directory, directory);
+	export->archSelect = archSelect;
+	export->deviceIndex = deviceIndex;
+
+	if (mkdir(directory, 0777) < 0 && errno != EEXIST) {
+		perror("Error: Cannot create export directory");
+		return ERROR_FILE_WRITING_ERROR;
+	}
+
+	for (i = 0; i < COLUMNS_NUM_COLUMNS; i++) {
+		snprintf(name, sizeof(name), "%s.col", columnNames[i]);
+		export->columns[i] = openExportFile(export, name, "wb");
+		if (export->columns[i] == NULL)
+			break;
+	}
+	if (i == COLUMNS_NUM_COLUMNS)
+		export->images = openExportFile(export, "images.txt", "w");
+	if (export->images == NULL) {
+		perror("Error: Cannot open export file");
+		closeExportFiles(export);
+		return ERROR_FILE_WRITING_ERROR;
+	}
+
+	/* A chunk holds COLUMNS_CHUNK_ROWS values of every column, the
+	 * columns one after the other */
+	for (i = 0; i < COLUMNS_NUM_COLUMNS; i++)
+		export->chunkSize += columnWidths[i]*COLUMNS_CHUNK_ROWS;
+	export->chunk = malloc(export->chunkSize);
+	if (export->chunk == NULL) {
+		closeExportFiles(export);
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+
+	return 0;
+}
+
+/* Stores a little endian integer of a column width. */
+static void putColumnLE(unsigned char *p, uint32_t data, int width) {
+	int i;
+
+	for (i = 0; i < width; i++) {
+		p[i] = data & 0xFF;
+		data >>= 8;
+	}
+}
+
+/* Writes the first numRows rows of the chunk to the column files. */
+static int flushChunk(columnExport *export, int numRows) {
+	unsigned char *column = export->chunk;
+	int i;
+
+	for (i = 0; i < COLUMNS_NUM_COLUMNS; i++) {
+		if (fwrite(column, columnWidths[i], numRows, export->columns[i]) != (size_t)numRows)
+			return ERROR_FILE_WRITING_ERROR;
+		column += columnWidths[i]*COLUMNS_CHUNK_ROWS;
+	}
+	export->numRows += numRows;
+
+	return 0;
+}
+
+/* Decodes every word of a program image and appends it to the columns, in
+ * a single sequential pass over the image. */
+int exportProgramImage(columnExport *export, const char *imageName, const programImage *image) {
+	unsigned char *columns[COLUMNS_NUM_COLUMNS];
+	disassembledInstruction dInstruction;
+	const assembledInstruction *aInstruction;
+	instructionInfo *instructionSet;
+	uint32_t values[COLUMNS_NUM_COLUMNS];
+	int i, j, row, region, retVal;
+
+	if (export == NULL || export->chunk == NULL || image == NULL)
+		return ERROR_INVALID_ARGUMENTS;
+
+	instructionSet = allInstructionSets[export->archSelect].instructionSet;
+
+	columns[0] = export->chunk;
+	for (j = 1; j < COLUMNS_NUM_COLUMNS; j++)
+		columns[j] = columns[j-1] + columnWidths[j-1]*COLUMNS_CHUNK_ROWS;
+
+	row = 0;
+	for (i = 0; i < image->numInstructions; i++) {
+		aInstruction = &image->instructions[i];
+
+		region = REGION_PROGRAM;
+		if (export->deviceIndex >= 0)
+			region = lookupMemoryRegion(export->deviceIndex, aInstruction->address);
+
+		values[COLUMN_ADDRESS] = aInstruction->address;
+		values[COLUMN_OPCODE] = aInstruction->opcode;
+		values[COLUMN_INSTRUCTION] = COLUMNS_NO_INSTRUCTION;
+		values[COLUMN_OPERAND0] = values[COLUMN_OPERAND1] = values[COLUMN_OPERAND2] = 0;
+		values[COLUMN_REGION] = region;
+		values[COLUMN_IMAGE] = export->numImages;
+
+		/* Words outside of program memory aren't instructions */
+		if (region == REGION_PROGRAM) {
+			retVal = disassembleInstruction(&dInstruction, aInstruction, export->archSelect);
+			if (retVal < 0)
+				return retVal;
+			values[COLUMN_INSTRUCTION] = dInstruction.instruction - instructionSet;
+			for (j = 0; j < dInstruction.instruction->numOperands; j++)
+				values[COLUMN_OPERAND0+j] = (uint32_t)dInstruction.operands[j];
+		}
+
+		for (j = 0; j < COLUMNS_NUM_COLUMNS; j++)
+			putColumnLE(columns[j] + row*columnWidths[j], values[j], columnWidths[j]);
+
+		if (++row == COLUMNS_CHUNK_ROWS) {
+			if (flushChunk(export, row) < 0)
+				break;
+			row = 0;
+		}
+	}
+
+	if (i < image->numInstructions || flushChunk(export, row) < 0 || fprintf(export->images, "%s\n", imageName) < 0) {
+		fprintf(stderr, "Error writing columns to export directory!\n");
+		return ERROR_FILE_WRITING_ERROR;
+	}
+	export->numImages++;
+
+	return 0;
+}
+
+/* Writes the schema and closes the column files. */
+int closeColumnExport(columnExport *export) {
+	instructionInfo *instructionSet;
+	FILE *schema;
+	int i, retVal;
+
+	if (export == NULL || export->chunk == NULL)
+		return ERROR_INVALID_ARGUMENTS;
+
+	retVal = closeExportFiles(export);
+
+	schema = openExportFile(export, "schema.txt", "w");
+	if (schema == NULL) {
+		perror("Error: Cannot open export schema file");
+		return ERROR_FILE_WRITING_ERROR;
+	}
+
+	instructionSet = allInstructionSets[export->archSelect].instructionSet;
+	if (fprintf(schema, "version %d\nrows %ld\nimages %ld\narch %s\n", COLUMNS_VERSION, export->numRows, export->numImages, archNames[export->archSelect]) < 0)
+		retVal = ERROR_FILE_WRITING_ERROR;
+	if (export->deviceIndex >= 0 && fprintf(schema, "device %s\n", allDevices[export->deviceIndex].name) < 0)
+		retVal = ERROR_FILE_WRITING_ERROR;
+	for (i = 0; i < COLUMNS_NUM_COLUMNS; i++) {
+		if (fprintf(schema, "column %s %s\n", columnNames[i], columnTypes[i]) < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+	}
+	for (i = 0; i < allInstructionSets[export->archSelect].numInstructions; i++) {
+		if (fprintf(schema, "instruction %d %s\n", i, instructionSet[i].mnemonic) < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+	}
+	if (fclose(schema) != 0)
+		retVal = ERROR_FILE_WRITING_ERROR;
+
+	if (retVal < 0)
+		fprintf(stderr, "Error writing columns to export directory!\n");
+
+	return retVal;
+}
+
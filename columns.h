@@ -0,0 +1,91 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * columns.h - Header file for the columnar export, which writes the decoded
+ *  instructions of many program images as fixed width column files.
+ *
+ */
+
+#ifndef COLUMNS_DISASM_H
+#define COLUMNS_DISASM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "pic_disasm.h"
+#include "image.h"
+
+/* Columnar export layout:
+ *
+ * Every column is a file in the export directory holding one fixed width
+ * little endian value per word, with no header, so a column can be mapped
+ * into memory and used as an array as is. Row i of every column belongs to
+ * the same word. The words of each image are written in the order they
+ * were read from the program file, and the images one after the other.
+ *
+ *   address.col	uint32	word address
+ *   opcode.col		uint16	opcode data
+ *   instruction.col	uint8	index into the mnemonics of the schema, or
+ *				COLUMNS_NO_INSTRUCTION outside program memory
+ *   operand0.col	int32	operands as decoded, 0 if the instruction has
+ *   operand1.col	int32	fewer operands
+ *   operand2.col	int32
+ *   region.col		uint8	one of the PIC_Memory_Regions
+ *   image.col		uint32	index of the image in images.txt
+ *
+ * images.txt holds the name of every image, one per line, and schema.txt
+ * describes the export with one "key value..." pair per line: the format
+ * version, the number of rows and images, the architecture and device,
+ * every column (stored in <name>.col) with its type, and every mnemonic
+ * with its instruction id.
+ */
+#define COLUMNS_VERSION			1
+#define COLUMNS_NO_INSTRUCTION		0xFF
+#define COLUMNS_NUM_COLUMNS		8
+
+/* Number of rows gathered before they are written out */
+#define COLUMNS_CHUNK_ROWS		4096
+
+/* Structure to hold an export in progress. */
+struct _columnExport {
+	char directory[512];
+	int archSelect;
+	int deviceIndex;
+	FILE *columns[COLUMNS_NUM_COLUMNS];
+	FILE *images;
+	/* Rows gathered for all columns before they are written out */
+	unsigned char *chunk;
+	size_t chunkSize;
+	long numRows;
+	long numImages;
+};
+typedef struct _columnExport columnExport;
+
+/* Creates the export directory if it doesn't exist and opens the column
+ * files. deviceIndex is -1 if no device is selected. */
+int openColumnExport(columnExport *export, const char *directory, int archSelect, int deviceIndex);
+
+/* Decodes every word of a program image and appends it to the columns, in
+ * a single sequential pass over the image. */
+int exportProgramImage(columnExport *export, const char *imageName, const programImage *image);
+
+/* Writes the schema and closes the column files. */
+int closeColumnExport(columnExport *export);
+
+#endif
+
@@ -0,0 +1,300 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * convert.c - Conversion of program images to Intel HEX, Motorola S-Record
+ *  and binary files. Records are encoded with a byte to hex digit pair
+ *  table into a buffer, and written with one fwrite() per record.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "image.h"
+#include "errorcodes.h"
+#include "convert.h"
+
+/* Longest record: S3 type, count, 4 address bytes, data, checksum, newline */
+#define CONVERT_MAX_RECORD_LENGTH	(4 + 2*(1+4+CONVERT_RECORD_BYTES+1) + 1)
+
+/* Hex digit pairs of every byte value */
+static char hexPairs[256][2];
+static int hexPairsReady = 0;
+
+static void initHexPairs(void) {
+	const char *digits = "0123456789ABCDEF";
+	int i;
+
+	for (i = 0; i < 256; i++) {
+		hexPairs[i][0] = digits[i >> 4];
+		hexPairs[i][1] = digits[i & 0xF];
+	}
+	hexPairsReady = 1;
+}
+
+/* Encodes bytes as hex digit pairs, adding them to the checksum sum */
+static char *encodeHexBytes(char *out, const uint8_t *bytes, int n, unsigned int *sum) {
+	int i;
+
+	for (i = 0; i < n; i++) {
+		memcpy(out, hexPairs[bytes[i]], 2);
+		out += 2;
+		*sum += bytes[i];
+	}
+	return out;
+}
+
+static int compareAddress(const void *a, const void *b) {
+	const assembledInstruction *x = *(const assembledInstruction **)a;
+	const assembledInstruction *y = *(const assembledInstruction **)b;
+
+	if (x->address != y->address)
+		return (x->address < y->address) ? -1 : 1;
+	return (x < y) ? -1 : (x > y);
+}
+
+/* Parses a list of word patches, such as "0x2000=0x12,0x2001=0x34", and
+ * appends the patched words to the program image, so they take the place
+ * of the words read from the file at the same addresses. */
+int applyWordPatches(programImage *image, const char *patches) {
+	const char *p;
+	char *end;
+	unsigned long address, value;
+
+	for (p = patches; ; p = end+1) {
+		address = strtoul(p, &end, 0);
+		if (end == p || *end != '=') {
+			fprintf(stderr, "Invalid patch %s, expected <address>=<value>.\n", p);
+			return ERROR_INVALID_ARGUMENTS;
+		}
+		/* The byte address of the word must fit in the 32 bits of the
+		 * program file formats */
+		if (address > 0x7FFFFFFF) {
+			fprintf(stderr, "Invalid patch address %.*s, expected a word address up to 0x7FFFFFFF.\n", (int)(end-p), p);
+			return ERROR_INVALID_ARGUMENTS;
+		}
+		p = end+1;
+		value = strtoul(p, &end, 0);
+		if (end == p || (*end != ',' && *end != '\0') || value > 0xFFFF) {
+			fprintf(stderr, "Invalid patch value %s, expected a 16-bit word.\n", p);
+			return ERROR_INVALID_ARGUMENTS;
+		}
+
+		if (appendProgramImage(image, address, value) < 0) {
+			fprintf(stderr, "Error allocating sufficient memory for program image!\n");
+			return ERROR_MEMORY_ALLOCATION_ERROR;
+		}
+		if (*end == '\0')
+			break;
+	}
+
+	return 0;
+}
+
+/* Writes an Intel HEX record */
+static int writeIHexRecord(FILE *fileOut, int type, uint16_t address, const uint8_t *data, int dataLen) {
+	char record[CONVERT_MAX_RECORD_LENGTH], *out;
+	uint8_t header[4];
+	unsigned int sum;
+
+	header[0] = dataLen;
+	header[1] = address >> 8;
+	header[2] = address & 0xFF;
+	header[3] = type;
+
+	sum = 0;
+	record[0] = ':';
+	out = encodeHexBytes(record+1, header, 4, &sum);
+	out = encodeHexBytes(out, data, dataLen, &sum);
+	memcpy(out, hexPairs[(-sum) & 0xFF], 2);
+	out[2] = '\n';
+	out += 3;
+
+	if (fwrite(record, 1, out-record, fileOut) != (size_t)(out-record))
+		return ERROR_FILE_WRITING_ERROR;
+	return 0;
+}
+
+/* Writes a Motorola S-Record record, with an address of addressLen bytes */
+static int writeSRecord(FILE *fileOut, int type, uint32_t address, int addressLen, const uint8_t *data, int dataLen) {
+	char record[CONVERT_MAX_RECORD_LENGTH], *out;
+	uint8_t header[5];
+	unsigned int sum;
+	int i;
+
+	header[0] = addressLen + dataLen + 1;
+	for (i = 0; i < addressLen; i++)
+		header[1+i] = address >> (8*(addressLen-1-i));
+
+	sum = 0;
+	record[0] = 'S';
+	record[1] = '0' + type;
+	out = encodeHexBytes(record+2, header, 1+addressLen, &sum);
+	out = encodeHexBytes(out, data, dataLen, &sum);
+	memcpy(out, hexPairs[(~sum) & 0xFF], 2);
+	out[2] = '\n';
+	out += 3;
+
+	if (fwrite(record, 1, out-record, fileOut) != (size_t)(out-record))
+		return ERROR_FILE_WRITING_ERROR;
+	return 0;
+}
+
+/* Writes the sorted words as Intel HEX records, with an extended linear
+ * address record wherever the upper 16 bits of the byte address change. */
+static int writeIHexWords(FILE *fileOut, const assembledInstruction **words, int numWords) {
+	uint8_t data[CONVERT_RECORD_BYTES];
+	uint32_t byteAddress, upper;
+	int i, n, retVal;
+
+	upper = 0;
+	for (i = 0; i < numWords; i += n) {
+		byteAddress = words[i]->address*2;
+		if ((byteAddress >> 16) != upper) {
+			upper = byteAddress >> 16;
+			data[0] = upper >> 8;
+			data[1] = upper & 0xFF;
+			retVal = writeIHexRecord(fileOut, 0x04, 0, data, 2);
+			if (retVal < 0)
+				return retVal;
+		}
+
+		/* Consecutive words, up to the record size and the end of the 64 KB segment */
+		for (n = 0; i+n < numWords && 2*n < CONVERT_RECORD_BYTES; n++) {
+			if (words[i+n]->address != words[i]->address+n || ((words[i+n]->address*2) >> 16) != upper)
+				break;
+			data[2*n] = words[i+n]->opcode & 0xFF;
+			data[2*n+1] = words[i+n]->opcode >> 8;
+		}
+		retVal = writeIHexRecord(fileOut, 0x00, byteAddress & 0xFFFF, data, 2*n);
+		if (retVal < 0)
+			return retVal;
+	}
+
+	return writeIHexRecord(fileOut, 0x01, 0, NULL, 0);
+}
+
+/* Writes the sorted words as S-Record records, with the shortest address
+ * that holds the highest address */
+static int writeSRecordWords(FILE *fileOut, const assembledInstruction **words, int numWords) {
+	uint8_t data[CONVERT_RECORD_BYTES];
+	uint32_t maxByteAddress;
+	int i, n, addressLen, retVal;
+
+	maxByteAddress = (numWords > 0) ? words[numWords-1]->address*2+1 : 0;
+	if (maxByteAddress <= 0xFFFF)
+		addressLen = 2;
+	else if (maxByteAddress <= 0xFFFFFF)
+		addressLen = 3;
+	else
+		addressLen = 4;
+
+	for (i = 0; i < numWords; i += n) {
+		for (n = 0; i+n < numWords && 2*n < CONVERT_RECORD_BYTES; n++) {
+			if (words[i+n]->address != words[i]->address+n)
+				break;
+			data[2*n] = words[i+n]->opcode & 0xFF;
+			data[2*n+1] = words[i+n]->opcode >> 8;
+		}
+		/* S1, S2 or S3 data record */
+		retVal = writeSRecord(fileOut, addressLen-1, words[i]->address*2, addressLen, data, 2*n);
+		if (retVal < 0)
+			return retVal;
+	}
+
+	/* S9, S8 or S7 termination record */
+	return writeSRecord(fileOut, 11-addressLen, 0, addressLen, NULL, 0);
+}
+
+/* Writes the sorted words as a binary file from address 0 */
+static int writeBinaryWords(FILE *fileOut, const assembledInstruction **words, int numWords) {
+	static uint8_t fill[4096];
+	uint8_t bytes[2];
+	uint64_t gap, n;
+	uint32_t next;
+	int i;
+
+	if (fill[0] != 0xFF)
+		memset(fill, 0xFF, sizeof(fill));
+
+	next = 0;
+	for (i = 0; i < numWords; i++) {
+		for (gap = 2*(uint64_t)(words[i]->address - next); gap > 0; gap -= n) {
+			n = (gap < sizeof(fill)) ? gap : sizeof(fill);
+			if (fwrite(fill, 1, n, fileOut) != n)
+				return ERROR_FILE_WRITING_ERROR;
+		}
+		bytes[0] = words[i]->opcode & 0xFF;
+		bytes[1] = words[i]->opcode >> 8;
+		if (fwrite(bytes, 1, 2, fileOut) != 2)
+			return ERROR_FILE_WRITING_ERROR;
+		next = words[i]->address+1;
+	}
+
+	return 0;
+}
+
+/* Writes the words of a program image in address order as an Intel HEX,
+ * Motorola S-Record or binary file. Where an address appears more than
+ * once, the last word appended to the image is written. Binary files
+ * start at address 0, with the gaps filled with 0xFF bytes. */
+int writeProgramImage(FILE *fileOut, const programImage *image, int format) {
+	const assembledInstruction **words;
+	int i, numWords, retVal;
+
+	if (!hexPairsReady)
+		initHexPairs();
+
+	words = malloc((image->numInstructions+1)*sizeof(assembledInstruction *));
+	if (words == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for conversion!\n");
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+	for (i = 0; i < image->numInstructions; i++)
+		words[i] = &image->instructions[i];
+	qsort(words, image->numInstructions, sizeof(assembledInstruction *), compareAddress);
+
+	/* Keep the last word of every address */
+	for (i = 0, numWords = 0; i < image->numInstructions; i++) {
+		if (i+1 < image->numInstructions && words[i+1]->address == words[i]->address)
+			continue;
+		words[numWords++] = words[i];
+	}
+
+	switch (format) {
+		case CONVERT_IHEX:
+			retVal = writeIHexWords(fileOut, words, numWords);
+			break;
+		case CONVERT_SRECORD:
+			retVal = writeSRecordWords(fileOut, words, numWords);
+			break;
+		case CONVERT_BINARY:
+			retVal = writeBinaryWords(fileOut, words, numWords);
+			break;
+		default:
+			retVal = ERROR_INVALID_ARGUMENTS;
+			break;
+	}
+	free(words);
+
+	if (retVal == ERROR_FILE_WRITING_ERROR)
+		fprintf(stderr, "Error writing converted program file!\n");
+	return retVal;
+}
@@ -0,0 +1,52 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * convert.h - Header file for the conversion of program images to Intel
+ *  HEX, Motorola S-Record and binary files, with word patches applied.
+ *
+ */
+
+#ifndef CONVERT_DISASM_H
+#define CONVERT_DISASM_H
+
+#include <stdio.h>
+#include "image.h"
+
+/* Enumeration for the formats a program image can be converted to */
+enum {
+	CONVERT_IHEX,
+	CONVERT_SRECORD,
+	CONVERT_BINARY,
+};
+
+/* Number of data bytes in a converted Intel HEX or S-Record record */
+#define CONVERT_RECORD_BYTES	16
+
+/* Parses a list of word patches, such as "0x2000=0x12,0x2001=0x34", and
+ * appends the patched words to the program image, so they take the place
+ * of the words read from the file at the same addresses. */
+int applyWordPatches(programImage *image, const char *patches);
+
+/* Writes the words of a program image in address order as an Intel HEX,
+ * Motorola S-Record or binary file. Where an address appears more than
+ * once, the last word appended to the image is written. Binary files
+ * start at address 0, with the gaps filled with 0xFF bytes. */
+int writeProgramImage(FILE *fileOut, const programImage *image, int format);
+
+#endif
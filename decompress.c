@@ -0,0 +1,233 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * decompress.c - Transparent decompression of gzip and xz compressed
+ *  program files. The compressed file is recognized by its first byte and
+ *  wrapped with fopencookie(), so the record parsers read the decompressed
+ *  data with fgets() like any other file.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <zlib.h>
+#include <lzma.h>
+#include "profile.h"
+#include "decompress.h"
+
+/* First bytes of the magic of gzip (1F 8B) and xz (FD 37 7A 58 5A 00)
+ * compressed data. Neither can start an Intel HEX or S-Record file. */
+#define GZIP_MAGIC_BYTE		0x1F
+#define XZ_MAGIC_BYTE		0xFD
+
+/* Size of the buffer of compressed data, and of the stdio buffer the
+ * decompressed data is written into */
+#define DECOMPRESS_BUFFER_SIZE	65536
+
+/* Wrapped file, see decompressFile() */
+struct _decompressedFile {
+	FILE *file;
+	uint8_t input[DECOMPRESS_BUFFER_SIZE];
+	/* The compressed file has been read to the end */
+	int inputEnd;
+	/* The gzip member or all of the xz streams have ended */
+	int streamEnd;
+	z_stream gzip;
+	lzma_stream xz;
+};
+typedef struct _decompressedFile decompressedFile;
+
+/* Reads the next compressed data into the input buffer. Returns the
+ * number of bytes read, 0 at the end of the file, or -1 on error. */
+static ssize_t fillInput(decompressedFile *dFile) {
+	size_t length;
+
+	length = fread(dFile->input, 1, sizeof(dFile->input), dFile->file);
+	if (length == 0) {
+		if (ferror(dFile->file))
+			return -1;
+		dFile->inputEnd = 1;
+	}
+	return length;
+}
+
+/* Fails a read of damaged compressed data */
+static ssize_t damagedInput(void) {
+	fprintf(stderr, "Error: Compressed program file is damaged or truncated!\n");
+	errno = EIO;
+	return -1;
+}
+
+static ssize_t gzipRead(void *cookie, char *buffer, size_t size) {
+	decompressedFile *dFile = cookie;
+	z_stream *gzip = &dFile->gzip;
+	ssize_t length;
+	int previousStage, retVal;
+
+	gzip->next_out = (Bytef *)buffer;
+	gzip->avail_out = size;
+	while (gzip->avail_out == size) {
+		if (gzip->avail_in == 0 && !dFile->inputEnd) {
+			length = fillInput(dFile);
+			if (length < 0)
+				return -1;
+			gzip->next_in = dFile->input;
+			gzip->avail_in = length;
+		}
+
+		/* Concatenated gzip members decompress to their concatenation */
+		if (dFile->streamEnd) {
+			if (gzip->avail_in == 0 && dFile->inputEnd)
+				return 0;
+			if (inflateReset(gzip) != Z_OK)
+				return damagedInput();
+			dFile->streamEnd = 0;
+		}
+
+		previousStage = PROFILE_SWITCH(PROFILE_STAGE_READ);
+		retVal = inflate(gzip, Z_NO_FLUSH);
+		PROFILE_SWITCH(previousStage);
+		if (retVal == Z_STREAM_END)
+			dFile->streamEnd = 1;
+		else if (retVal == Z_BUF_ERROR && dFile->inputEnd)
+			return damagedInput();
+		else if (retVal != Z_OK && retVal != Z_BUF_ERROR)
+			return damagedInput();
+	}
+
+	return size - gzip->avail_out;
+}
+
+static ssize_t xzRead(void *cookie, char *buffer, size_t size) {
+	decompressedFile *dFile = cookie;
+	lzma_stream *xz = &dFile->xz;
+	ssize_t length;
+	int previousStage;
+	lzma_ret retVal;
+
+	if (dFile->streamEnd)
+		return 0;
+
+	xz->next_out = (uint8_t *)buffer;
+	xz->avail_out = size;
+	while (xz->avail_out == size) {
+		if (xz->avail_in == 0 && !dFile->inputEnd) {
+			length = fillInput(dFile);
+			if (length < 0)
+				return -1;
+			xz->next_in = dFile->input;
+			xz->avail_in = length;
+		}
+
+		previousStage = PROFILE_SWITCH(PROFILE_STAGE_READ);
+		retVal = lzma_code(xz, dFile->inputEnd ? LZMA_FINISH : LZMA_RUN);
+		PROFILE_SWITCH(previousStage);
+		if (retVal == LZMA_STREAM_END) {
+			dFile->streamEnd = 1;
+			break;
+		}
+		else if (retVal != LZMA_OK)
+			return damagedInput();
+	}
+
+	return size - xz->avail_out;
+}
+
+static int gzipClose(void *cookie) {
+	decompressedFile *dFile = cookie;
+	int retVal;
+
+	inflateEnd(&dFile->gzip);
+	retVal = fclose(dFile->file);
+	free(dFile);
+
+	return retVal;
+}
+
+static int xzClose(void *cookie) {
+	decompressedFile *dFile = cookie;
+	int retVal;
+
+	lzma_end(&dFile->xz);
+	retVal = fclose(dFile->file);
+	free(dFile);
+
+	return retVal;
+}
+
+/* Wraps a file that starts with the magic bytes of gzip or xz compressed
+ * data, so that reading the returned file reads the decompressed data,
+ * straight into the buffer of the returned file. Closing the returned
+ * file closes the file too. Returns the file itself if it isn't
+ * compressed, or NULL with the file closed if the decompression can't be
+ * set up. */
+FILE *decompressFile(FILE *file) {
+	cookie_io_functions_t gzipFunctions = {gzipRead, NULL, NULL, gzipClose};
+	cookie_io_functions_t xzFunctions = {xzRead, NULL, NULL, xzClose};
+	lzma_stream xzInit = LZMA_STREAM_INIT;
+	decompressedFile *dFile;
+	FILE *wrapped;
+	int c, retVal;
+
+	if (file == NULL)
+		return file;
+
+	c = fgetc(file);
+	if (c == EOF)
+		return file;
+	ungetc(c, file);
+	if (c != GZIP_MAGIC_BYTE && c != XZ_MAGIC_BYTE)
+		return file;
+
+	dFile = calloc(1, sizeof(decompressedFile));
+	if (dFile == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for decompression!\n");
+		fclose(file);
+		return NULL;
+	}
+	dFile->file = file;
+
+	if (c == GZIP_MAGIC_BYTE) {
+		/* Window bits of 15+32 read the gzip header */
+		retVal = (inflateInit2(&dFile->gzip, 15+32) == Z_OK) ? 0 : -1;
+		wrapped = (retVal == 0) ? fopencookie(dFile, "r", gzipFunctions) : NULL;
+		if (wrapped == NULL && retVal == 0)
+			inflateEnd(&dFile->gzip);
+	} else {
+		dFile->xz = xzInit;
+		retVal = (lzma_stream_decoder(&dFile->xz, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK) ? 0 : -1;
+		wrapped = (retVal == 0) ? fopencookie(dFile, "r", xzFunctions) : NULL;
+		if (wrapped == NULL && retVal == 0)
+			lzma_end(&dFile->xz);
+	}
+	if (wrapped == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for decompression!\n");
+		free(dFile);
+		fclose(file);
+		return NULL;
+	}
+
+	/* The decompressed data is written straight into this buffer, where
+	 * fgets() reads the records from */
+	setvbuf(wrapped, NULL, _IOFBF, DECOMPRESS_BUFFER_SIZE);
+
+	return wrapped;
+}
@@ -0,0 +1,38 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * decompress.h - Header file for the transparent decompression of gzip
+ *  and xz compressed program files.
+ *
+ */
+
+#ifndef DECOMPRESS_DISASM_H
+#define DECOMPRESS_DISASM_H
+
+#include <stdio.h>
+
+/* Wraps a file that starts with the magic bytes of gzip or xz compressed
+ * data, so that reading the returned file reads the decompressed data,
+ * straight into the buffer of the returned file. Closing the returned
+ * file closes the file too. Returns the file itself if it isn't
+ * compressed, or NULL with the file closed if the decompression can't be
+ * set up. */
+FILE *decompressFile(FILE *file);
+
+#endif
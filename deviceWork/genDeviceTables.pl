@@ -0,0 +1,211 @@
+#!/usr/bin/perl
+#
+# Generates pic_devicetables.c from the PICDevices device database:
+#   $ perl genDeviceTables.pl PICDevices > ../pic_devicetables.c
+#
+# The SFR symbols of all devices are stored in a single table indexed by a
+# minimal perfect hash (hash and displace): a key is first hashed into a
+# bucket, and every bucket holds the seed of a second hash that places the
+# keys of that bucket into free slots of the table. A lookup is therefore
+# two hashes, one load of the bucket seed and one load of the table entry.
+# The hash function must match hashRegisterKey() in pic_device.c.
+
+# Must match REGISTER_ANY_BANK in pic_device.h
+$ANY_BANK = 0x8000;
+
+%archNames = ("baseline" => "PIC_BASELINE", "midrange" => "PIC_MIDRANGE", "enhanced" => "PIC_MIDRANGE_ENHANCED");
+%bankSizes = ("baseline" => 0x20, "midrange" => 0x80, "enhanced" => 0x80);
+
+# 32-bit multiplication, split up so perl never leaves integer precision
+sub mul32 {
+	my ($a, $b) = @_;
+	return (($a * ($b & 0xFFFF)) + ((($a * ($b >> 16)) & 0xFFFF) << 16)) & 0xFFFFFFFF;
+}
+
+sub hashRegisterKey {
+	my ($key, $seed) = @_;
+	$key = ($key ^ $seed) & 0xFFFFFFFF;
+	$key ^= $key >> 16;
+	$key = mul32($key, 0x85EBCA6B);
+	$key ^= $key >> 13;
+	$key = mul32($key, 0xC2B2AE35);
+	$key ^= $key >> 16;
+	return $key;
+}
+
+# Parse the device database
+@devices = ();
+while ($line = <>) {
+	chomp($line);
+	$line =~ s/#.*//;
+	@fields = split(' ', $line);
+	next if (scalar @fields == 0);
+
+	if ($fields[0] eq "device") {
+		die "Unknown architecture $fields[2]\n" if (!exists $archNames{$fields[2]});
+		push(@devices, {name => $fields[1], arch => $fields[2], banks => $fields[3] + 0, core => {}, sfr => {},
+			progmem => 0, idlocs => [0, 0], config => [0, 0], eeprom => [0, 0], settings => []});
+	} elsif ($fields[0] eq "progmem") {
+		$devices[-1]{progmem} = hex($fields[1]);
+	} elsif ($fields[0] eq "idlocs" || $fields[0] eq "config" || $fields[0] eq "eeprom") {
+		$devices[-1]{$fields[0]} = [hex($fields[1]), $fields[2] + 0];
+	} elsif ($fields[0] eq "setting") {
+		for ($i = 4; $i < scalar @fields; $i++) {
+			($setting, $value) = split(/=/, $fields[$i]);
+			push(@{$devices[-1]{settings}}, [hex($fields[1]), hex($fields[2]), hex($value), $fields[3], $setting]);
+		}
+	} elsif ($fields[0] eq "core") {
+		$devices[-1]{core}{hex($fields[1])} = $fields[2];
+	} elsif ($fields[0] eq "sfr") {
+		$devices[-1]{sfr}{hex($fields[1])} = $fields[2];
+	} else {
+		die "Unknown directive $fields[0]\n";
+	}
+}
+
+# Expand the registers of every device into keys
+%symbols = ();
+for ($d = 0; $d < scalar @devices; $d++) {
+	$device = $devices[$d];
+	$bankSize = $bankSizes{$device->{arch}};
+	%registers = %{$device->{sfr}};
+	foreach $offset (keys %{$device->{core}}) {
+		for ($bank = 0; $bank < $device->{banks}; $bank++) {
+			$registers{$bank*$bankSize + $offset} = $device->{core}{$offset};
+		}
+	}
+	foreach $address (keys %registers) {
+		$symbols{($d << 16) | $address} = $registers{$address};
+	}
+	# Registers with the same name in every bank can be named without
+	# knowing the bank
+	for ($offset = 0; $offset < $bankSize; $offset++) {
+		$name = $registers{$offset};
+		next if (!defined $name);
+		for ($bank = 1; $bank < $device->{banks}; $bank++) {
+			last if (!defined $registers{$bank*$bankSize + $offset} || $registers{$bank*$bankSize + $offset} ne $name);
+		}
+		$symbols{($d << 16) | $ANY_BANK | $offset} = $name if ($bank == $device->{banks});
+	}
+}
+
+# Build the minimal perfect hash
+@keys = sort { $a <=> $b } keys %symbols;
+$numKeys = scalar @keys;
+$numBuckets = int(($numKeys + 3) / 4);
+@buckets = ();
+foreach $key (@keys) {
+	push(@{$buckets[hashRegisterKey($key, 0) % $numBuckets]}, $key);
+}
+@order = sort { scalar @{$buckets[$b] || []} <=> scalar @{$buckets[$a] || []} or $a <=> $b } (0 .. $numBuckets-1);
+@slots = ();
+@seeds = (0) x $numBuckets;
+foreach $bucket (@order) {
+	next if (!defined $buckets[$bucket]);
+	for ($seed = 1; ; $seed++) {
+		%taken = ();
+		$ok = 1;
+		foreach $key (@{$buckets[$bucket]}) {
+			$slot = hashRegisterKey($key, $seed) % $numKeys;
+			if (defined $slots[$slot] || exists $taken{$slot}) {
+				$ok = 0;
+				last;
+			}
+			$taken{$slot} = $key;
+		}
+		last if ($ok);
+	}
+	$seeds[$bucket] = $seed;
+	foreach $slot (keys %taken) {
+		$slots[$slot] = $taken{$slot};
+	}
+}
+
+# Pack the names into a single string pool
+$poolLength = 0;
+%nameOffsets = ();
+foreach $key (@keys) {
+	$name = $symbols{$key};
+	next if (exists $nameOffsets{$name});
+	$nameOffsets{$name} = $poolLength;
+	$poolLength += length($name) + 1;
+}
+
+print <<'EOT';
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * pic_devicetables.c - PIC device database and SFR symbol tables.
+ *
+ * Generated by deviceWork/genDeviceTables.pl from deviceWork/PICDevices,
+ * do not edit by hand.
+ *
+ */
+
+#include "pic_device.h"
+
+EOT
+
+printf("const int numDevices = %d;\n\n", scalar @devices);
+print "const deviceInfo allDevices[] = {\n";
+$numSettings = 0;
+foreach $device (@devices) {
+	printf("\t{\"%s\", %s, %d, 0x%X, {0x%X, %d}, {0x%X, %d}, {0x%X, %d}, %d, %d},\n",
+		$device->{name}, $archNames{$device->{arch}}, $device->{banks}, $device->{progmem},
+		@{$device->{idlocs}}, @{$device->{config}}, @{$device->{eeprom}},
+		$numSettings, scalar @{$device->{settings}});
+	$numSettings += scalar @{$device->{settings}};
+}
+print "};\n\n";
+
+print "const configSetting configSettings[] = {\n";
+foreach $device (@devices) {
+	foreach $setting (@{$device->{settings}}) {
+		printf("\t{0x%04X, 0x%04X, 0x%04X, \"%s\", \"%s\"},\n", @{$setting});
+	}
+}
+print "};\n\n";
+
+printf("const int numRegisterSymbols = %d;\n", $numKeys);
+printf("const int numRegisterSymbolBuckets = %d;\n\n", $numBuckets);
+
+print "const uint16_t registerSymbolSeeds[] = {";
+for ($i = 0; $i < $numBuckets; $i++) {
+	print(($i % 12 == 0) ? "\n\t" : " ");
+	printf("%d,", $seeds[$i]);
+}
+print "\n};\n\n";
+
+print "const registerSymbol registerSymbols[] = {\n";
+for ($i = 0; $i < $numKeys; $i++) {
+	$key = $slots[$i];
+	printf("\t{0x%06X, %d},\t/* %s */\n", $key, $nameOffsets{$symbols{$key}}, $symbols{$key});
+}
+print "};\n\n";
+
+print "const char registerSymbolNames[] =";
+$linePool = "";
+foreach $name (sort { $nameOffsets{$a} <=> $nameOffsets{$b} } keys %nameOffsets) {
+	if (length($linePool) + length($name) > 60) {
+		print "\n\t\"$linePool\"";
+		$linePool = "";
+	}
+	$linePool .= $name . "\\0";
+}
+print "\n\t\"$linePool\";\n\n";
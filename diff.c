@@ -0,0 +1,578 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * diff.c - Instruction level comparison of two program images. The basic
+ *  blocks found by the analysis in pic_analysis.c are hashed and aligned,
+ *  so an inserted instruction shows up as one changed block instead of
+ *  shifting every address after it. The words outside of the program
+ *  memory, like configuration words and EEPROM data, are compared by
+ *  address.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pic_disasm.h"
+#include "pic_analysis.h"
+#include "format.h"
+#include "image.h"
+#include "file.h"
+#include "diff.h"
+#include "errorcodes.h"
+
+/* Per block details of one of the compared images */
+struct _diffSide {
+	programAnalysis analysis;
+	/* Hash of each block, and each instruction word, with the code
+	 * address operands masked out */
+	uint32_t *hashes;
+	uint16_t *normalized;
+	/* Index of the matching block in the other image, or -1 */
+	int *matches;
+	/* Words outside of the analyzed program memory, sorted by address
+	 * with the last one read at each address */
+	const assembledInstruction **others;
+	int numOthers;
+};
+typedef struct _diffSide diffSide;
+
+/* Entry of the hash table of block hashes, counting the blocks of each
+ * image with that hash and remembering the last one of them. */
+struct _diffHashEntry {
+	uint32_t hash;
+	int used;
+	int count[2];
+	int index[2];
+};
+typedef struct _diffHashEntry diffHashEntry;
+
+/* Hashes the blocks of an analyzed program image. */
+static int hashBlocks(diffSide *side);
+/* Aligns the blocks of the two images, filling in their matches. */
+static int alignBlocks(diffSide *oldSide, diffSide *newSide);
+/* Prints a range of blocks of one image, prefixing every line. */
+static int printBlocks(FILE *fileOut, diffSide *side, int firstBlock, int lastBlock, const char *prefix, formattingOptions fOptions);
+/* Prints the header of a changed, inserted or removed range of blocks. */
+static int printHunkHeader(FILE *fileOut, const char *change, diffSide *oldSide, int oldFirst, int oldLast, diffSide *newSide, int newFirst, int newLast, formattingOptions fOptions);
+/* Collects the words of an image outside of its analyzed program memory. */
+static int collectOtherWords(diffSide *side, const programImage *image);
+/* Compares the words outside of the program memory by address. */
+static int diffOtherWords(FILE *fileOut, diffSide *oldSide, diffSide *newSide, formattingOptions fOptions, int counts[3]);
+
+/* Final mixing of a hash, so nearby values land in unrelated buckets */
+static uint32_t mixHash(uint32_t hash) {
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6B;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+/* Returns whether an old and a new block hold the same instructions,
+ * apart from their code address operands. */
+static int blocksEqual(diffSide *oldSide, int i, diffSide *newSide, int j) {
+	const basicBlock *oldBlock = &oldSide->analysis.blocks[i], *newBlock = &newSide->analysis.blocks[j];
+
+	if (oldBlock->end-oldBlock->start != newBlock->end-newBlock->start)
+		return 0;
+	return memcmp(&oldSide->normalized[oldBlock->start], &newSide->normalized[newBlock->start],
+		(oldBlock->end-oldBlock->start)*sizeof(uint16_t)) == 0;
+}
+
+/* Returns whether two matched blocks are identical, at the same address. */
+static int blocksIdentical(diffSide *oldSide, int i, diffSide *newSide, int j) {
+	const basicBlock *oldBlock = &oldSide->analysis.blocks[i], *newBlock = &newSide->analysis.blocks[j];
+	int k;
+
+	if (oldSide->analysis.instructions[oldBlock->start].address != newSide->analysis.instructions[newBlock->start].address)
+		return 0;
+	for (k = 0; k < oldBlock->end-oldBlock->start; k++) {
+		if (oldSide->analysis.instructions[oldBlock->start+k].opcode != newSide->analysis.instructions[newBlock->start+k].opcode)
+			return 0;
+	}
+	return 1;
+}
+
+/* Compares two program images block by block: the basic blocks of both
+ * images are hashed with their code address operands masked out, aligned
+ * on their hashes, and the changed, inserted and removed blocks are
+ * disassembled and printed, followed by a summary. The words outside of
+ * the program memory are compared by address. */
+int diffProgramImages(FILE *fileOut, const programImage *oldImage, const programImage *newImage, formattingOptions fOptions, int archSelect) {
+	diffSide sides[2];
+	int unchanged = 0, relocated = 0, changed = 0, inserted = 0, removed = 0;
+	int otherCounts[3] = {0, 0, 0};
+	int i, j, oldEnd, newEnd, pairs, retVal;
+
+	memset(sides, 0, sizeof(sides));
+	/* Labels and org directives don't make sense in a diff, and
+	 * the hunks are always printed as text */
+	fOptions.options &= ~FORMAT_OPTION_ADDRESS_LABEL;
+	fOptions.outputFormat = OUTPUT_FORMAT_TEXT;
+
+	retVal = analyzeProgramImage(&sides[0].analysis, oldImage, archSelect);
+	if (retVal == 0)
+		retVal = analyzeProgramImage(&sides[1].analysis, newImage, archSelect);
+	if (retVal == 0)
+		retVal = hashBlocks(&sides[0]);
+	if (retVal == 0)
+		retVal = hashBlocks(&sides[1]);
+	if (retVal == 0)
+		retVal = collectOtherWords(&sides[0], oldImage);
+	if (retVal == 0)
+		retVal = collectOtherWords(&sides[1], newImage);
+	if (retVal == 0)
+		retVal = alignBlocks(&sides[0], &sides[1]);
+	if (retVal < 0) {
+		if (retVal == ERROR_MEMORY_ALLOCATION_ERROR)
+			fprintf(stderr, "Error allocating sufficient memory for program comparison!\n");
+		else
+			fprintf(stderr, "Error analyzing program images for comparison!\n");
+		goto cleanup;
+	}
+
+	/* Walk both block sequences in step. Matched blocks advance both,
+	 * and the unmatched blocks between two matches form a hunk, where
+	 * blocks are paired up as changed and the rest of the longer side
+	 * is inserted or removed. */
+	i = j = 0;
+	while (i < sides[0].analysis.numBlocks || j < sides[1].analysis.numBlocks) {
+		if (i < sides[0].analysis.numBlocks && sides[0].matches[i] >= 0 && sides[0].matches[i] == j) {
+			if (blocksIdentical(&sides[0], i, &sides[1], j))
+				unchanged++;
+			else
+				relocated++;
+			i++;
+			j++;
+			continue;
+		}
+
+		for (oldEnd = i; oldEnd < sides[0].analysis.numBlocks && sides[0].matches[oldEnd] < 0; oldEnd++)
+			;
+		for (newEnd = j; newEnd < sides[1].analysis.numBlocks && sides[1].matches[newEnd] < 0; newEnd++)
+			;
+		pairs = (oldEnd-i < newEnd-j) ? oldEnd-i : newEnd-j;
+
+		if (pairs > 0) {
+			retVal = printHunkHeader(fileOut, "changed", &sides[0], i, i+pairs-1, &sides[1], j, j+pairs-1, fOptions);
+			if (retVal == 0)
+				retVal = printBlocks(fileOut, &sides[0], i, i+pairs-1, "- ", fOptions);
+			if (retVal == 0)
+				retVal = printBlocks(fileOut, &sides[1], j, j+pairs-1, "+ ", fOptions);
+			changed += pairs;
+		}
+		if (retVal == 0 && oldEnd-i > pairs) {
+			retVal = printHunkHeader(fileOut, "removed", &sides[0], i+pairs, oldEnd-1, NULL, 0, 0, fOptions);
+			if (retVal == 0)
+				retVal = printBlocks(fileOut, &sides[0], i+pairs, oldEnd-1, "- ", fOptions);
+			removed += oldEnd-i-pairs;
+		}
+		if (retVal == 0 && newEnd-j > pairs) {
+			retVal = printHunkHeader(fileOut, "inserted", NULL, 0, 0, &sides[1], j+pairs, newEnd-1, fOptions);
+			if (retVal == 0)
+				retVal = printBlocks(fileOut, &sides[1], j+pairs, newEnd-1, "+ ", fOptions);
+			inserted += newEnd-j-pairs;
+		}
+		if (retVal < 0)
+			goto cleanup;
+
+		i = oldEnd;
+		j = newEnd;
+	}
+
+	retVal = diffOtherWords(fileOut, &sides[0], &sides[1], fOptions, otherCounts);
+	if (retVal < 0)
+		goto cleanup;
+
+	retVal = fprintf(fileOut, "; %d blocks unchanged, %d relocated, %d changed, %d inserted, %d removed",
+		unchanged, relocated, changed, inserted, removed);
+	/* Only mention the other words where there are any */
+	if (retVal >= 0 && (sides[0].numOthers > 0 || sides[1].numOthers > 0))
+		retVal = fprintf(fileOut, "; %d words outside of the program memory changed, %d inserted, %d removed",
+			otherCounts[0], otherCounts[1], otherCounts[2]);
+	if (retVal < 0 || fprintf(fileOut, "\n") < 0) {
+		fprintf(stderr, "Error writing formatted disassembly to file!\n");
+		retVal = ERROR_FILE_WRITING_ERROR;
+	} else {
+		retVal = 0;
+	}
+
+	cleanup:
+	for (i = 0; i < 2; i++) {
+		free(sides[i].hashes);
+		free(sides[i].normalized);
+		free(sides[i].matches);
+		free(sides[i].others);
+		freeProgramAnalysis(&sides[i].analysis);
+	}
+
+	return retVal;
+}
+
+/* Hashes the blocks of an analyzed program image. The goto and call
+ * destinations and relative branch distances of every instruction are
+ * masked out of the normalized hash, since they change whenever code
+ * before their destination grows or shrinks. */
+static int hashBlocks(diffSide *side) {
+	programAnalysis *analysis = &side->analysis;
+	disassembledInstruction dInstruction;
+	assembledInstruction aInstruction;
+	uint32_t hash;
+	uint16_t addressMask;
+	int b, i, k, retVal;
+
+	side->hashes = malloc((analysis->numBlocks+1)*sizeof(uint32_t));
+	side->normalized = malloc((analysis->numInstructions+1)*sizeof(uint16_t));
+	side->matches = malloc((analysis->numBlocks+1)*sizeof(int));
+	if (side->hashes == NULL || side->normalized == NULL || side->matches == NULL)
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+
+	for (b = 0; b < analysis->numBlocks; b++) {
+		/* FNV-1a over the instruction words of the block */
+		hash = 0x811C9DC5;
+		for (i = analysis->blocks[b].start; i < analysis->blocks[b].end; i++) {
+			aInstruction.address = analysis->instructions[i].address;
+			aInstruction.opcode = analysis->instructions[i].opcode;
+			retVal = disassembleInstruction(&dInstruction, &aInstruction, analysis->archSelect);
+			if (retVal < 0)
+				return retVal;
+
+			addressMask = 0;
+			for (k = 0; k < dInstruction.instruction->numOperands; k++) {
+				if (dInstruction.instruction->operandTypes[k] == OPERAND_ABSOLUTE_ADDRESS ||
+				    dInstruction.instruction->operandTypes[k] == OPERAND_RELATIVE_ADDRESS)
+					addressMask |= dInstruction.instruction->operandMasks[k];
+			}
+			side->normalized[i] = aInstruction.opcode & ~addressMask;
+			hash = (hash ^ side->normalized[i]) * 0x01000193;
+		}
+		side->hashes[b] = mixHash(hash);
+		side->matches[b] = -1;
+	}
+
+	return 0;
+}
+
+/* Looks up the hash table entry of a hash, using linear probing, and
+ * claims an empty entry for it if it isn't in the table yet. */
+static diffHashEntry *findHashEntry(diffHashEntry *table, uint32_t tableMask, uint32_t hash) {
+	uint32_t slot;
+
+	for (slot = hash & tableMask; table[slot].used && table[slot].hash != hash; slot = (slot+1) & tableMask)
+		;
+	if (!table[slot].used) {
+		table[slot].used = 1;
+		table[slot].hash = hash;
+	}
+	return &table[slot];
+}
+
+/* Records a match between an old and a new block. */
+static void matchBlocks(diffSide *oldSide, int i, diffSide *newSide, int j) {
+	oldSide->matches[i] = j;
+	newSide->matches[j] = i;
+}
+
+/* Returns whether an old and a new block are both unmatched and equal.
+ * The hashes only rule blocks out, equal ones are compared word by word. */
+static int canMatch(diffSide *oldSide, int i, diffSide *newSide, int j) {
+	return i >= 0 && j >= 0 && i < oldSide->analysis.numBlocks && j < newSide->analysis.numBlocks &&
+		oldSide->matches[i] < 0 && newSide->matches[j] < 0 && oldSide->hashes[i] == newSide->hashes[j] &&
+		blocksEqual(oldSide, i, newSide, j);
+}
+
+/* Aligns the blocks of the two images. A full longest common subsequence
+ * is quadratic, so as in patience diff the blocks whose hash occurs exactly
+ * once in each image are used as anchors: the longest increasing run of
+ * anchors is found in O(n log n), and the matches are then grown forwards
+ * and backwards from every anchor and from both ends of the images. */
+static int alignBlocks(diffSide *oldSide, diffSide *newSide) {
+	int numOld = oldSide->analysis.numBlocks, numNew = newSide->analysis.numBlocks;
+	diffHashEntry *table = NULL, *entry;
+	int *anchorOld = NULL, *anchorNew = NULL, *tails = NULL, *previous = NULL;
+	uint32_t tableSize, tableMask;
+	int numAnchors, length, low, high, mid, i, j;
+
+	/* Size the table to at most half full */
+	for (tableSize = 16; tableSize < 2*(uint32_t)(numOld+numNew); tableSize <<= 1)
+		;
+	tableMask = tableSize-1;
+	table = calloc(tableSize, sizeof(diffHashEntry));
+	anchorOld = malloc((numOld+1)*sizeof(int));
+	anchorNew = malloc((numOld+1)*sizeof(int));
+	tails = malloc((numOld+1)*sizeof(int));
+	previous = malloc((numOld+1)*sizeof(int));
+	if (table == NULL || anchorOld == NULL || anchorNew == NULL || tails == NULL || previous == NULL) {
+		free(table);
+		free(anchorOld);
+		free(anchorNew);
+		free(tails);
+		free(previous);
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+
+	for (i = 0; i < numOld; i++) {
+		entry = findHashEntry(table, tableMask, oldSide->hashes[i]);
+		entry->count[0]++;
+		entry->index[0] = i;
+	}
+	for (j = 0; j < numNew; j++) {
+		entry = findHashEntry(table, tableMask, newSide->hashes[j]);
+		entry->count[1]++;
+		entry->index[1] = j;
+	}
+
+	/* Collect the unique blocks in old image order */
+	numAnchors = 0;
+	for (i = 0; i < numOld; i++) {
+		entry = findHashEntry(table, tableMask, oldSide->hashes[i]);
+		if (entry->count[0] == 1 && entry->count[1] == 1 && blocksEqual(oldSide, i, newSide, entry->index[1])) {
+			anchorOld[numAnchors] = i;
+			anchorNew[numAnchors] = entry->index[1];
+			numAnchors++;
+		}
+	}
+
+	/* Longest increasing subsequence of the new image indices, where
+	 * tails[k] is the anchor ending the best run of length k+1 */
+	length = 0;
+	for (i = 0; i < numAnchors; i++) {
+		low = 0;
+		high = length;
+		while (low < high) {
+			mid = (low+high)/2;
+			if (anchorNew[tails[mid]] < anchorNew[i])
+				low = mid+1;
+			else
+				high = mid;
+		}
+		previous[i] = (low > 0) ? tails[low-1] : -1;
+		tails[low] = i;
+		if (low == length)
+			length++;
+	}
+	for (i = (length > 0) ? tails[length-1] : -1; i >= 0; i = previous[i])
+		matchBlocks(oldSide, anchorOld[i], newSide, anchorNew[i]);
+
+	/* Grow the matches from the start and end of the images, then
+	 * forwards and backwards from every match */
+	for (i = 0; canMatch(oldSide, i, newSide, i); i++)
+		matchBlocks(oldSide, i, newSide, i);
+	for (i = numOld-1, j = numNew-1; canMatch(oldSide, i, newSide, j); i--, j--)
+		matchBlocks(oldSide, i, newSide, j);
+	for (i = 0; i < numOld; i++) {
+		if (oldSide->matches[i] >= 0 && canMatch(oldSide, i+1, newSide, oldSide->matches[i]+1))
+			matchBlocks(oldSide, i+1, newSide, oldSide->matches[i]+1);
+	}
+	for (i = numOld-1; i >= 0; i--) {
+		if (oldSide->matches[i] >= 0 && canMatch(oldSide, i-1, newSide, oldSide->matches[i]-1))
+			matchBlocks(oldSide, i-1, newSide, oldSide->matches[i]-1);
+	}
+
+	free(table);
+	free(anchorOld);
+	free(anchorNew);
+	free(tails);
+	free(previous);
+
+	return 0;
+}
+
+/* Prints a range of blocks of one image, prefixing every line. */
+static int printBlocks(FILE *fileOut, diffSide *side, int firstBlock, int lastBlock, const char *prefix, formattingOptions fOptions) {
+	programAnalysis *analysis = &side->analysis;
+	programAnalysis *resolve = NULL;
+	assembledInstruction aInstruction;
+	int i, retVal;
+
+	if (fOptions.options & FORMAT_OPTION_RESOLVE_ADDRESSES)
+		resolve = analysis;
+
+	for (i = analysis->blocks[firstBlock].start; i < analysis->blocks[lastBlock].end; i++) {
+		aInstruction.address = analysis->instructions[i].address;
+		aInstruction.opcode = analysis->instructions[i].opcode;
+		if (fputs(prefix, fileOut) < 0) {
+			fprintf(stderr, "Error writing formatted disassembly to file!\n");
+			return ERROR_FILE_WRITING_ERROR;
+		}
+		retVal = disassembleAndPrint(fileOut, &aInstruction, fOptions, analysis->archSelect, resolve);
+		if (retVal < 0)
+			return retVal;
+	}
+
+	return 0;
+}
+
+/* Prints the header of a changed, inserted or removed range of blocks,
+ * with the address ranges of the blocks in the old and new images. */
+static int printHunkHeader(FILE *fileOut, const char *change, diffSide *oldSide, int oldFirst, int oldLast, diffSide *newSide, int newFirst, int newLast, formattingOptions fOptions) {
+	const diffSide *sides[2];
+	int firsts[2], lasts[2];
+	int k, retVal;
+
+	sides[0] = oldSide;
+	sides[1] = newSide;
+	firsts[0] = oldFirst;
+	firsts[1] = newFirst;
+	lasts[0] = oldLast;
+	lasts[1] = newLast;
+
+	retVal = fprintf(fileOut, "@@ %s", change);
+	for (k = 0; k < 2 && retVal >= 0; k++) {
+		if (sides[k] == NULL)
+			continue;
+		retVal = fprintf(fileOut, " %s%0*X-%0*X", (k == 0) ? "-" : "+",
+			fOptions.addressFieldWidth, sides[k]->analysis.instructions[sides[k]->analysis.blocks[firsts[k]].start].address,
+			fOptions.addressFieldWidth, sides[k]->analysis.instructions[sides[k]->analysis.blocks[lasts[k]].end-1].address);
+	}
+	if (retVal >= 0)
+		retVal = fprintf(fileOut, " @@\n");
+	if (retVal < 0) {
+		fprintf(stderr, "Error writing formatted disassembly to file!\n");
+		return ERROR_FILE_WRITING_ERROR;
+	}
+
+	return 0;
+}
+
+
+static int compareWordAddress(const void *a, const void *b) {
+	const assembledInstruction *x = *(const assembledInstruction **)a;
+	const assembledInstruction *y = *(const assembledInstruction **)b;
+
+	if (x->address != y->address)
+		return (x->address < y->address) ? -1 : 1;
+	return (x < y) ? -1 : (x > y);
+}
+
+/* Returns whether the analysis holds an instruction at an address. */
+static int analysisHoldsAddress(const programAnalysis *analysis, uint32_t address) {
+	int low, high, middle;
+
+	low = 0;
+	high = analysis->numInstructions;
+	while (low < high) {
+		middle = low + (high-low)/2;
+		if (analysis->instructions[middle].address < address)
+			low = middle+1;
+		else
+			high = middle;
+	}
+	return low < analysis->numInstructions && analysis->instructions[low].address == address;
+}
+
+/* Collects the words of an image outside of its analyzed program memory,
+ * such as the configuration words, ID locations and EEPROM data, sorted by
+ * address. Where an address appears more than once the last word read
+ * from the file is kept, like the analysis does. */
+static int collectOtherWords(diffSide *side, const programImage *image) {
+	int i, n;
+
+	side->others = malloc((image->numInstructions+1)*sizeof(assembledInstruction *));
+	if (side->others == NULL)
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+
+	for (i = 0, n = 0; i < image->numInstructions; i++) {
+		if (!analysisHoldsAddress(&side->analysis, image->instructions[i].address))
+			side->others[n++] = &image->instructions[i];
+	}
+	qsort(side->others, n, sizeof(assembledInstruction *), compareWordAddress);
+
+	/* The words read later sort after the earlier ones at an address */
+	for (i = 0, side->numOthers = 0; i < n; i++) {
+		if (i+1 < n && side->others[i+1]->address == side->others[i]->address)
+			continue;
+		side->others[side->numOthers++] = side->others[i];
+	}
+
+	return 0;
+}
+
+/* Prints a changed, inserted or removed word outside of the program
+ * memory as a hunk of its own. */
+static int printWordHunk(FILE *fileOut, const char *change, const assembledInstruction *oldWord, const assembledInstruction *newWord, formattingOptions fOptions, int archSelect) {
+	const assembledInstruction *words[2];
+	int k, retVal;
+
+	words[0] = oldWord;
+	words[1] = newWord;
+
+	retVal = fprintf(fileOut, "@@ %s", change);
+	for (k = 0; k < 2 && retVal >= 0; k++) {
+		if (words[k] != NULL)
+			retVal = fprintf(fileOut, " %s%0*X-%0*X", (k == 0) ? "-" : "+",
+				fOptions.addressFieldWidth, words[k]->address, fOptions.addressFieldWidth, words[k]->address);
+	}
+	if (retVal >= 0)
+		retVal = fprintf(fileOut, " @@\n");
+	if (retVal < 0) {
+		fprintf(stderr, "Error writing formatted disassembly to file!\n");
+		return ERROR_FILE_WRITING_ERROR;
+	}
+
+	for (k = 0; k < 2; k++) {
+		if (words[k] == NULL)
+			continue;
+		if (fputs((k == 0) ? "- " : "+ ", fileOut) < 0) {
+			fprintf(stderr, "Error writing formatted disassembly to file!\n");
+			return ERROR_FILE_WRITING_ERROR;
+		}
+		retVal = disassembleAndPrint(fileOut, words[k], fOptions, archSelect, NULL);
+		if (retVal < 0)
+			return retVal;
+	}
+
+	return 0;
+}
+
+/* Compares the words outside of the program memory by address, printing
+ * the changed, inserted and removed words and counting them in counts. */
+static int diffOtherWords(FILE *fileOut, diffSide *oldSide, diffSide *newSide, formattingOptions fOptions, int counts[3]) {
+	const assembledInstruction *oldWord, *newWord;
+	int archSelect = oldSide->analysis.archSelect;
+	int i, j, retVal;
+
+	i = j = 0;
+	retVal = 0;
+	while ((i < oldSide->numOthers || j < newSide->numOthers) && retVal == 0) {
+		oldWord = (i < oldSide->numOthers) ? oldSide->others[i] : NULL;
+		newWord = (j < newSide->numOthers) ? newSide->others[j] : NULL;
+
+		if (oldWord != NULL && newWord != NULL && oldWord->address == newWord->address) {
+			if (oldWord->opcode != newWord->opcode) {
+				retVal = printWordHunk(fileOut, "changed", oldWord, newWord, fOptions, archSelect);
+				counts[0]++;
+			}
+			i++;
+			j++;
+		} else if (newWord == NULL || (oldWord != NULL && oldWord->address < newWord->address)) {
+			retVal = printWordHunk(fileOut, "removed", oldWord, NULL, fOptions, archSelect);
+			counts[2]++;
+			i++;
+		} else {
+			retVal = printWordHunk(fileOut, "inserted", NULL, newWord, fOptions, archSelect);
+			counts[1]++;
+			j++;
+		}
+	}
+
+	return retVal;
+}
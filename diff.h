@@ -0,0 +1,40 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * diff.h - Header file for the instruction level comparison of two
+ *  program images.
+ *
+ */
+
+#ifndef DIFF_DISASM_H
+#define DIFF_DISASM_H
+
+#include <stdio.h>
+#include "format.h"
+#include "image.h"
+
+/* Compares two program images block by block: the basic blocks of both
+ * images are hashed with their code address operands masked out, aligned
+ * on their hashes, and the changed, inserted and removed blocks are
+ * disassembled and printed, followed by a summary. The words outside of
+ * the program memory are compared by address. */
+int diffProgramImages(FILE *fileOut, const programImage *oldImage, const programImage *newImage, formattingOptions fOptions, int archSelect);
+
+#endif
+
@@ -27,20 +27,66 @@
 #include "libGIS-1.0.5/ihex.h"
 #include "libGIS-1.0.5/srecord.h"
 #include "pic_disasm.h"
+#include "pic_analysis.h"
 #include "format.h"
+#include "pic_device.h"
+#include "image.h"
+#include "signature.h"
+#include "record.h"
+#include "profile.h"
 #include "file.h"
 
-/* Reads a record from an Intel Hex formatted file, formats the assembled
- * instruction data into an assembledInsruction structure, then passes the
- * assembled instruction data to disassembleAndPrint() for disassembly and printing.
- * Loops until all records have been read and processed. */
+static int printProgramImage(FILE *fileOut, const programImage *image, formattingOptions fOptions, int archSelect);
+
+/* Reads all of the records from an Intel Hex formatted file into a program
+ * image, then passes the program image to disassembleProgramImage() for
+ * disassembly and printing. The words before a malformed record are still
+ * printed. */
 int disassembleIHexFile(FILE *fileOut, FILE *fileIn, formattingOptions fOptions, int archSelect) {
+	programImage image;
+	int retVal;
+
+	initProgramImage(&image);
+	retVal = readIHexFile(&image, fileIn);
+	if (retVal == 0)
+		retVal = disassembleProgramImage(fileOut, &image, fOptions, archSelect);
+	else if (retVal != ERROR_MEMORY_ALLOCATION_ERROR)
+		printProgramImage(fileOut, &image, fOptions, archSelect);
+	freeProgramImage(&image);
+
+	return retVal;
+}
+
+/* Reads all of the records from a Motorola S-Record formatted file into a
+ * program image, then passes the program image to disassembleProgramImage()
+ * for disassembly and printing. The words before a malformed record are
+ * still printed. */
+int disassembleSRecordFile(FILE *fileOut, FILE *fileIn, formattingOptions fOptions, int archSelect) {
+	programImage image;
+	int retVal;
+
+	initProgramImage(&image);
+	retVal = readSRecordFile(&image, fileIn);
+	if (retVal == 0)
+		retVal = disassembleProgramImage(fileOut, &image, fOptions, archSelect);
+	else if (retVal != ERROR_MEMORY_ALLOCATION_ERROR)
+		printProgramImage(fileOut, &image, fOptions, archSelect);
+	freeProgramImage(&image);
+
+	return retVal;
+}
+
+/* Reads the records of an Intel Hex formatted file into the program image,
+ * see readIHexFile(). */
+static int readIHexRecords(programImage *image, FILE *fileIn) {
 	assembledInstruction aInstruction;
 	IHexRecord irec;
 	int i;
 	int retVal = 0;
 	uint16_t dataFromPreviousOddRecord = 0;
 	int dataFromPreviousOddRecordAvailable = 0;
+	/* Upper address bits set by extended address records */
+	uint32_t addressOffset = 0;
 
 
 	while (retVal == 0) {
@@ -53,6 +99,7 @@ int disassembleIHexFile(FILE *fileOut, FILE *fileIn, formattingOptions fOptions,
 
 		switch (retVal) {
 			case IHEX_OK:
+				PROFILE_COUNT(PROFILE_COUNTER_RECORDS, 1);
 				break;
 			case IHEX_ERROR_FILE:
 				perror("Error reading Intel HEX formatted file");
@@ -66,11 +113,23 @@ int disassembleIHexFile(FILE *fileOut, FILE *fileIn, formattingOptions fOptions,
 				return ERROR_IRRECOVERABLE;
 		}
 
+		/* Extended segment and linear address records set the upper
+		 * address bits of the following data records, needed for
+		 * the configuration words and data EEPROM of the Enhanced
+		 * Mid-Range devices. */
+		if (irec.type == IHEX_TYPE_02 && irec.dataLen == 2) {
+			addressOffset = (((uint32_t)irec.data[0] << 8) + irec.data[1]) << 4;
+			continue;
+		} else if (irec.type == IHEX_TYPE_04 && irec.dataLen == 2) {
+			addressOffset = (((uint32_t)irec.data[0] << 8) + irec.data[1]) << 16;
+			continue;
+		}
+
 		/* Skip the record if it's not a data record */
 		if (irec.type != IHEX_TYPE_00)
 			continue;
 
-		aInstruction.address = irec.address/2;
+		aInstruction.address = (addressOffset + irec.address)/2;
 		for (i = 0; i < irec.dataLen; i += 2) {
 			/* Make sure there is a data byte after this,
 			 * (we need both because each opcode is 16-bits) */
@@ -106,25 +165,22 @@ int disassembleIHexFile(FILE *fileOut, FILE *fileIn, formattingOptions fOptions,
 				i--;
 			}
 
-			retVal = disassembleAndPrint(fileOut, &aInstruction, fOptions, archSelect);
-			if (retVal < 0)
-				return retVal;
+			if (appendProgramImage(image, aInstruction.address, aInstruction.opcode) < 0) {
+				fprintf(stderr, "Error allocating sufficient memory for program image!\n");
+				return ERROR_MEMORY_ALLOCATION_ERROR;
+			}
 			/* Increment the address for the correct address
 			 * location of the next instruction. */
 			aInstruction.address++;
 		}
 	}
 
-	finishDisassembly(fileOut, fOptions);
-
 	return 0;
 }
 
-/* Reads a record from an Motorola S-Record formatted file, formats the assembled
- * instruction data into an assembledInsruction structure, then passes the
- * assembled instruction data to disassembleAndPrint() for disassembly and printing.
- * Loops until all records have been read and processed. */
-int disassembleSRecordFile(FILE *fileOut, FILE *fileIn, formattingOptions fOptions, int archSelect) {
+/* Reads the records of a Motorola S-Record formatted file into the program
+ * image, see readSRecordFile(). */
+static int readSRecordRecords(programImage *image, FILE *fileIn) {
 	assembledInstruction aInstruction;
 	SRecord srec;
 	int i;
@@ -141,6 +197,7 @@ int disassembleSRecordFile(FILE *fileOut, FILE *fileIn, formattingOptions fOptio
 			break;
 		switch (retVal) {
 			case SRECORD_OK:
+				PROFILE_COUNT(PROFILE_COUNTER_RECORDS, 1);
 				break;
 			case SRECORD_ERROR_FILE:
 				perror("Error reading Motorola S-Record formatted file");
@@ -192,26 +249,159 @@ int disassembleSRecordFile(FILE *fileOut, FILE *fileIn, formattingOptions fOptio
 				i--;
 			}
 
-			retVal = disassembleAndPrint(fileOut, &aInstruction, fOptions, archSelect);
-			if (retVal < 0)
-				return retVal;
+			if (appendProgramImage(image, aInstruction.address, aInstruction.opcode) < 0) {
+				fprintf(stderr, "Error allocating sufficient memory for program image!\n");
+				return ERROR_MEMORY_ALLOCATION_ERROR;
+			}
 			/* Increment the address for the correct address
 			 * location of the next instruction. */
 			aInstruction.address++;
 		}
 	}
 
-	finishDisassembly(fileOut, fOptions);
-
 	return 0;
 }
 
+/* Reads a record from an Intel Hex formatted file, formats the assembled
+ * instruction data into an assembledInstruction structure, and appends it
+ * to the program image. Loops until all records have been read and processed. */
+int readIHexFile(programImage *image, FILE *fileIn) {
+	int previousStage, retVal;
+
+	previousStage = PROFILE_SWITCH(PROFILE_STAGE_PARSE);
+	retVal = readIHexRecords(image, fileIn);
+	PROFILE_SWITCH(previousStage);
+
+	return retVal;
+}
+
+/* Reads a record from an Motorola S-Record formatted file, formats the assembled
+ * instruction data into an assembledInstruction structure, and appends it
+ * to the program image. Loops until all records have been read and processed. */
+int readSRecordFile(programImage *image, FILE *fileIn) {
+	int previousStage, retVal;
+
+	previousStage = PROFILE_SWITCH(PROFILE_STAGE_PARSE);
+	retVal = readSRecordRecords(image, fileIn);
+	PROFILE_SWITCH(previousStage);
+
+	return retVal;
+}
+
+/* Disassembles and prints every instruction of a program image, in the
+ * order they were read from the file. If address resolution is enabled,
+ * the program image is analyzed first. */
+int disassembleProgramImage(FILE *fileOut, const programImage *image, formattingOptions fOptions, int archSelect) {
+	int retVal;
+
+	retVal = printProgramImage(fileOut, image, fOptions, archSelect);
+	if (retVal < 0)
+		return retVal;
+
+	return finishDisassembly(fileOut, fOptions);
+}
+
+/* Prints the instructions of a program image like disassembleProgramImage(),
+ * without finishing off the disassembly, so a program image that was only
+ * partly read isn't ended like a complete one. */
+static int printProgramImage(FILE *fileOut, const programImage *image, formattingOptions fOptions, int archSelect) {
+	programAnalysis analysis, *pAnalysis;
+	signatureMatches matches;
+	int retVal, previousStage;
+
+	pAnalysis = NULL;
+	matches.numMatches = 0;
+	if ((fOptions.options & FORMAT_OPTION_RESOLVE_ADDRESSES) || fOptions.signatures != NULL) {
+		previousStage = PROFILE_SWITCH(PROFILE_STAGE_ANALYZE);
+		retVal = analyzeProgramImage(&analysis, image, archSelect);
+		PROFILE_SWITCH(previousStage);
+		switch (retVal) {
+			case 0:
+				pAnalysis = &analysis;
+				break;
+			case ERROR_MEMORY_ALLOCATION_ERROR:
+				fprintf(stderr, "Error allocating sufficient memory for program analysis!\n");
+				return ERROR_MEMORY_ALLOCATION_ERROR;
+			default:
+				fprintf(stderr, "Encountered an irrecoverable error during program analysis!\n");
+				return ERROR_IRRECOVERABLE;
+		}
+	}
+
+	/* Recognize the known library functions of the program */
+	if (fOptions.signatures != NULL) {
+		previousStage = PROFILE_SWITCH(PROFILE_STAGE_ANALYZE);
+		retVal = matchSignatures(&matches, fOptions.signatures, pAnalysis);
+		PROFILE_SWITCH(previousStage);
+		if (retVal < 0) {
+			fprintf(stderr, "Error allocating sufficient memory for signature matching!\n");
+			freeProgramAnalysis(pAnalysis);
+			return ERROR_MEMORY_ALLOCATION_ERROR;
+		}
+		/* The analysis was only needed for the function candidates */
+		if (!(fOptions.options & FORMAT_OPTION_RESOLVE_ADDRESSES)) {
+			freeProgramAnalysis(pAnalysis);
+			pAnalysis = NULL;
+		}
+	}
+
+	/* disassembleAndPrintWords() switches between decoding and formatting */
+	previousStage = PROFILE_SWITCH(PROFILE_STAGE_FORMAT);
+	retVal = writeRecordHeader(fileOut, archSelect, fOptions);
+	if (retVal < 0)
+		fprintf(stderr, "Error writing formatted disassembly to file!\n");
+	else
+		retVal = disassembleAndPrintWords(fileOut, image->instructions, image->numInstructions, fOptions, archSelect, pAnalysis, &matches);
+	PROFILE_SWITCH(previousStage);
+
+	if (pAnalysis != NULL)
+		freeProgramAnalysis(pAnalysis);
+	if (fOptions.signatures != NULL)
+		freeSignatureMatches(&matches);
+
+	return retVal;
+}
+
 static int currentAddress = -5;
 
-/* Disassemble an assembled instruction, and print its disassembly
- * to fileOut. Alert user of errors. */
-int disassembleAndPrint(FILE *fileOut, const assembledInstruction *aInstruction, formattingOptions fOptions, int archSelect) {
-	disassembledInstruction dInstruction;
+/* Number of words disassembleAndPrintWords() decodes before printing them */
+#define DISASSEMBLY_BATCH_WORDS	256
+
+/* Sets the address the disassembly continues at, so that the next
+ * instruction only gets an org directive if it isn't at this address.
+ * A negative address always starts a new program origin. */
+void continueDisassemblyAt(int address) {
+	currentAddress = address - 1;
+}
+
+/* Decodes a word and resolves its operands if a program analysis is
+ * available. Sets region to the memory region of the word, which is only
+ * decoded if it is in the program memory, or if there is no device. */
+static int decodeWord(disassembledInstruction *dInstruction, int *region, const assembledInstruction *aInstruction, formattingOptions fOptions, int archSelect, programAnalysis *analysis) {
+	/* Words outside of the device's program memory aren't instructions */
+	*region = REGION_PROGRAM;
+	if (fOptions.deviceIndex >= 0) {
+		*region = lookupMemoryRegion(fOptions.deviceIndex, aInstruction->address);
+		if (*region != REGION_PROGRAM)
+			return 0;
+	}
+
+	/* First disassemble the instruction, and check for errors. */
+	PROFILE_COUNT(PROFILE_COUNTER_INSTRUCTIONS, 1);
+	if (disassembleInstruction(dInstruction, aInstruction, archSelect) != 0) {
+		fprintf(stderr, "Encountered an irrecoverable error during disassembly!\n");
+		return ERROR_IRRECOVERABLE;
+	}
+
+	/* Replace the operands with their full addresses where we know them */
+	if (analysis != NULL)
+		resolveOperands(analysis, dInstruction);
+
+	return 0;
+}
+
+/* Prints a word decoded by decodeWord() to fileOut. Alert user of errors. */
+static int printWord(FILE *fileOut, const assembledInstruction *aInstruction, const disassembledInstruction *dInstruction, int region, formattingOptions fOptions) {
 	int retVal;
 
 	/* If we are printing address labels (assemble-able code) */
@@ -228,18 +418,24 @@ int disassembleAndPrint(FILE *fileOut, const assembledInstruction *aInstruction,
 		}
 	}
 
-	/* First disassemble the instruction, and check for errors. */
-	retVal = disassembleInstruction(&dInstruction, aInstruction, archSelect);
-	switch (retVal) {
-		case 0:
-			break;
-		default:
-			fprintf(stderr, "Encountered an irrecoverable error during disassembly!\n");
-			return ERROR_IRRECOVERABLE;
+	if (region != REGION_PROGRAM) {
+		if (fOptions.outputFormat != OUTPUT_FORMAT_TEXT)
+			retVal = writeMemoryWordRecord(fileOut, aInstruction, region, fOptions);
+		else
+			retVal = printMemoryWord(fileOut, aInstruction, region, fOptions);
+		if (retVal < 0) {
+			fprintf(stderr, "Error writing formatted disassembly to file!\n");
+			return ERROR_FILE_WRITING_ERROR;
+		}
+		return 0;
 	}
 
-	/* Next print the disassembled instruction, check for errors. */
-	retVal = printDisassembledInstruction(fileOut, aInstruction, &dInstruction, fOptions);
+	/* Print the disassembled instruction, or write its record for the
+	 * structured output formats, check for errors. */
+	if (fOptions.outputFormat != OUTPUT_FORMAT_TEXT)
+		retVal = writeInstructionRecord(fileOut, aInstruction, dInstruction, fOptions);
+	else
+		retVal = printDisassembledInstruction(fileOut, aInstruction, dInstruction, fOptions);
 	switch (retVal) {
 		case 0:
 			break;
@@ -257,6 +453,58 @@ int disassembleAndPrint(FILE *fileOut, const assembledInstruction *aInstruction,
 	return 0;
 }
 
+/* Disassemble an assembled instruction, resolve its operands if a program
+ * analysis is available, and print its disassembly to fileOut. Alert user
+ * of errors. */
+int disassembleAndPrint(FILE *fileOut, const assembledInstruction *aInstruction, formattingOptions fOptions, int archSelect, programAnalysis *analysis) {
+	disassembledInstruction dInstruction;
+	int retVal, region;
+
+	PROFILE_SWITCH(PROFILE_STAGE_DECODE);
+	retVal = decodeWord(&dInstruction, &region, aInstruction, fOptions, archSelect, analysis);
+	PROFILE_SWITCH(PROFILE_STAGE_FORMAT);
+	if (retVal < 0)
+		return retVal;
+
+	return printWord(fileOut, aInstruction, &dInstruction, region, fOptions);
+}
+
+/* Disassembles and prints a run of words like disassembleAndPrint(), naming
+ * the functions recognized in matches in a comment before their first
+ * instruction. The words are decoded and then printed in batches, so the
+ * profile switches between the stages once per batch instead of twice per
+ * word. */
+int disassembleAndPrintWords(FILE *fileOut, const assembledInstruction *words, int numWords, formattingOptions fOptions, int archSelect, programAnalysis *analysis, const signatureMatches *matches) {
+	disassembledInstruction dInstructions[DISASSEMBLY_BATCH_WORDS];
+	int regions[DISASSEMBLY_BATCH_WORDS];
+	const char *functionName;
+	int start, batchSize, i, retVal;
+
+	retVal = 0;
+	for (start = 0; start < numWords && retVal == 0; start += batchSize) {
+		batchSize = (numWords-start < DISASSEMBLY_BATCH_WORDS) ? numWords-start : DISASSEMBLY_BATCH_WORDS;
+
+		PROFILE_SWITCH(PROFILE_STAGE_DECODE);
+		for (i = 0; i < batchSize && retVal == 0; i++)
+			retVal = decodeWord(&dInstructions[i], &regions[i], &words[start+i], fOptions, archSelect, analysis);
+		PROFILE_SWITCH(PROFILE_STAGE_FORMAT);
+
+		for (i = 0; i < batchSize && retVal == 0; i++) {
+			/* Name the recognized functions in a comment before their first instruction */
+			if (matches->numMatches > 0 && fOptions.outputFormat == OUTPUT_FORMAT_TEXT) {
+				functionName = lookupSignatureMatch(matches, words[start+i].address);
+				if (functionName != NULL && fprintf(fileOut, "; %s\n", functionName) < 0) {
+					fprintf(stderr, "Error writing formatted disassembly to file!\n");
+					return ERROR_FILE_WRITING_ERROR;
+				}
+			}
+			retVal = printWord(fileOut, &words[start+i], &dInstructions[i], regions[i], fOptions);
+		}
+	}
+
+	return retVal;
+}
+
 /* Finish off the disassemby - print "end" if we have address labels enabled */
 int finishDisassembly(FILE *fileOut, formattingOptions fOptions) {
 	if ((fOptions.options & FORMAT_OPTION_ADDRESS_LABEL) != 0) {
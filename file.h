@@ -28,22 +28,51 @@
 
 #include <stdio.h>
 #include "format.h"
+#include "image.h"
+#include "pic_analysis.h"
+#include "signature.h"
 
-/* Reads a record from an Intel Hex formatted file, formats the assembled
- * instruction data into an assembledInsruction structure, then passes the
- * assembled instruction data to disassembleAndPrint() for disassembly and printing.
- * Loops until all records have been read and processed. */
+/* Reads all of the records from an Intel Hex formatted file into a program
+ * image, then passes the program image to disassembleProgramImage() for
+ * disassembly and printing. */
 int disassembleIHexFile(FILE *fileOut, FILE *fileIn, formattingOptions fOptions, int archSelect);
 
-/* Reads a record from an Motorola S-Record formatted file, formats the assembled
- * instruction data into an assembledInsruction structure, then passes the
- * assembled instruction data to disassembleAndPrint() for disassembly and printing.
- * Loops until all records have been read and processed. */
+/* Reads all of the records from a Motorola S-Record formatted file into a
+ * program image, then passes the program image to disassembleProgramImage()
+ * for disassembly and printing. */
 int disassembleSRecordFile(FILE *fileOut, FILE *fileIn, formattingOptions fOptions, int archSelect);
 
-/* Disassemble an assembled instruction, and print its disassembly
- * to fileOut. Alert user of errors. */
-int disassembleAndPrint(FILE *fileOut, const assembledInstruction *aInstruction, formattingOptions fOptions, int archSelect);
+/* Reads a record from an Intel Hex formatted file, formats the assembled
+ * instruction data into an assembledInstruction structure, and appends it
+ * to the program image. Loops until all records have been read and processed. */
+int readIHexFile(programImage *image, FILE *fileIn);
+
+/* Reads a record from an Motorola S-Record formatted file, formats the assembled
+ * instruction data into an assembledInstruction structure, and appends it
+ * to the program image. Loops until all records have been read and processed. */
+int readSRecordFile(programImage *image, FILE *fileIn);
+
+/* Disassembles and prints every instruction of a program image, in the
+ * order they were read from the file. If address resolution is enabled,
+ * the program image is analyzed first. */
+int disassembleProgramImage(FILE *fileOut, const programImage *image, formattingOptions fOptions, int archSelect);
+
+/* Disassemble an assembled instruction, resolve its operands if a program
+ * analysis is available, and print its disassembly to fileOut. Alert user
+ * of errors. */
+int disassembleAndPrint(FILE *fileOut, const assembledInstruction *aInstruction, formattingOptions fOptions, int archSelect, programAnalysis *analysis);
+
+/* Disassembles and prints a run of words like disassembleAndPrint(), naming
+ * the functions recognized in matches in a comment before their first
+ * instruction. The words are decoded and then printed in batches, so the
+ * profile switches between the stages once per batch instead of twice per
+ * word. */
+int disassembleAndPrintWords(FILE *fileOut, const assembledInstruction *words, int numWords, formattingOptions fOptions, int archSelect, programAnalysis *analysis, const signatureMatches *matches);
+
+/* Sets the address the disassembly continues at, so that the next
+ * instruction only gets an org directive if it isn't at this address.
+ * A negative address always starts a new program origin. */
+void continueDisassemblyAt(int address);
 
 /* Finish off the disassemby - print "end" if we have address labels enabled */
 int finishDisassembly(FILE *fileOut, formattingOptions fOptions);
@@ -27,6 +27,8 @@
 #include <string.h>
 #include <stdarg.h>
 #include "format.h"
+#include "pic_device.h"
+#include "profile.h"
 
 /* Formats a disassembled operand with its prefix (such as 'R' to indicate a
  * register) into the pointer to a C-string strOperand, which must be free'd
@@ -39,11 +41,10 @@
 static int formatDisassembledOperand(char **strOperand, int operandNum, const disassembledInstruction *dInstruction, formattingOptions fOptions);
 
 
-/* Prints a disassembled instruction, formatted with options set in the
- * formattingOptions structure. */
-int printDisassembledInstruction(FILE *out, const assembledInstruction *aInstruction, const disassembledInstruction *dInstruction, formattingOptions fOptions) {
-	int retVal, i;
-	char *strOperand;
+/* Prints the address label or address, and the original opcode, that
+ * precede a disassembled instruction or memory word. */
+static int printAddressAndOpcode(FILE *out, const assembledInstruction *aInstruction, formattingOptions fOptions, int printLabel) {
+	int retVal;
 
 	retVal = 0;
 
@@ -51,11 +52,15 @@ int printDisassembledInstruction(FILE *out, const assembledInstruction *aInstruc
 	 * as set in the string addressLabelPrefix, because labels need to
 	 * start with non-numerical character for best compatibility with PIC
 	 * assemblers. */
-	if (fOptions.options & FORMAT_OPTION_ADDRESS_LABEL)
-		retVal = fprintf(out, "%s%0*X\t", fOptions.addressLabelPrefix, fOptions.addressFieldWidth, dInstruction->address);
+	if (fOptions.options & FORMAT_OPTION_ADDRESS_LABEL) {
+		if (printLabel)
+			retVal = fprintf(out, "%s%0*X\t", fOptions.addressLabelPrefix, fOptions.addressFieldWidth, aInstruction->address);
+		else
+			retVal = fprintf(out, "\t");
 	/* Otherwise just print the address, without address labels. */
-	else if (fOptions.options & FORMAT_OPTION_ADDRESS)
-		retVal = fprintf(out, "%4X:\t", dInstruction->address);
+	} else if (fOptions.options & FORMAT_OPTION_ADDRESS) {
+		retVal = fprintf(out, "%4X:\t", aInstruction->address);
+	}
 
 	if (retVal < 0)
 		return ERROR_FILE_WRITING_ERROR;
@@ -68,6 +73,19 @@ int printDisassembledInstruction(FILE *out, const assembledInstruction *aInstruc
 	if (retVal < 0)
 		return ERROR_FILE_WRITING_ERROR;
 
+	return 0;
+}
+
+/* Prints a disassembled instruction, formatted with options set in the
+ * formattingOptions structure. */
+int printDisassembledInstruction(FILE *out, const assembledInstruction *aInstruction, const disassembledInstruction *dInstruction, formattingOptions fOptions) {
+	int retVal, i;
+	char *strOperand;
+
+	retVal = printAddressAndOpcode(out, aInstruction, fOptions, 1);
+	if (retVal < 0)
+		return retVal;
+
 	/* Print the instruction mnemonic */
 	retVal = fprintf(out, "%s ", dInstruction->instruction->mnemonic);
 
@@ -121,6 +139,58 @@ int printDisassembledInstruction(FILE *out, const assembledInstruction *aInstruc
 	return 0;
 }
 
+/* Prints a word outside of the device's program memory: configuration
+ * words with their decoded settings, ID locations, and data EEPROM bytes,
+ * as the assembler directives that would produce them. */
+int printMemoryWord(FILE *out, const assembledInstruction *aInstruction, int region, formattingOptions fOptions) {
+	const deviceInfo *device;
+	const configSetting *setting;
+	int retVal, i, n;
+
+	device = &allDevices[fOptions.deviceIndex];
+
+	/* Configuration words are set with a directive, which can't be labeled */
+	retVal = printAddressAndOpcode(out, aInstruction, fOptions, region != REGION_CONFIG);
+	if (retVal < 0)
+		return retVal;
+
+	switch (region) {
+		case REGION_CONFIG:
+			/* Devices with more than one configuration word need the
+			 * address of the configuration word in the directive */
+			if (device->configWords.size > 1)
+				retVal = fprintf(out, "__config %s%0*X, %s%04X", OPERAND_PREFIX_ABSOLUTE_ADDRESS, fOptions.addressFieldWidth, aInstruction->address, OPERAND_PREFIX_WORD_DATA, aInstruction->opcode);
+			else
+				retVal = fprintf(out, "__config %s%04X", OPERAND_PREFIX_WORD_DATA, aInstruction->opcode);
+			if (retVal < 0)
+				return ERROR_FILE_WRITING_ERROR;
+
+			/* Decode the setting of every field of the word */
+			for (i = 0, n = 0; i < device->numConfigSettings; i++) {
+				setting = &configSettings[device->firstConfigSetting + i];
+				if (setting->address != aInstruction->address || (aInstruction->opcode & setting->mask) != setting->value)
+					continue;
+				if (fprintf(out, "%s%s=%s", (n++ == 0) ? "\t; " : ", ", setting->field, setting->setting) < 0)
+					return ERROR_FILE_WRITING_ERROR;
+			}
+			break;
+		case REGION_ID_LOCATIONS:
+			retVal = fprintf(out, "dw %s%04X\t; ID location %d", OPERAND_PREFIX_WORD_DATA, aInstruction->opcode, aInstruction->address - device->idLocations.address);
+			break;
+		case REGION_EEPROM:
+			retVal = fprintf(out, "de %s%02X", OPERAND_PREFIX_WORD_DATA, aInstruction->opcode & 0xFF);
+			break;
+		default:
+			retVal = fprintf(out, "dw %s%04X", OPERAND_PREFIX_WORD_DATA, aInstruction->opcode);
+			break;
+	}
+
+	if (retVal < 0 || fprintf(out, "\n") < 0)
+		return ERROR_FILE_WRITING_ERROR;
+
+	return 0;
+}
+
 /* More portable version of asprintf() based on vsnprintf(), mainly for MinGW
  */
 static int asprintf_portable(char **str, const char *fmt, ...) {
@@ -133,6 +203,7 @@ static int asprintf_portable(char **str, const char *fmt, ...) {
 
 	va_start(ap, fmt);
 	*str = malloc(len+1);
+	PROFILE_COUNT(PROFILE_COUNTER_ALLOCATIONS, 1);
 	len = (*str == NULL) ? -1 : vsnprintf(*str, len+1, fmt, ap);
 	va_end(ap);
 
@@ -149,6 +220,7 @@ static int asprintf_portable(char **str, const char *fmt, ...) {
  * prefix and the destination address as the label. */
 int formatDisassembledOperand(char **strOperand, int operandNum, const disassembledInstruction *dInstruction, formattingOptions fOptions) {
 	char binary[9];
+	const char *registerName;
 	int retVal;
 
 	switch (dInstruction->instruction->operandTypes[operandNum]) {
@@ -157,7 +229,15 @@ int formatDisassembledOperand(char **strOperand, int operandNum, const disassemb
 			retVal = 0;
 			break;
 		case OPERAND_REGISTER:
-			retVal = asprintf_portable(strOperand, "%s%02X%s", OPERAND_PREFIX_REGISTER, dInstruction->operands[operandNum], OPERAND_SUFFIX_REGISTER);
+			/* If we know the device, print the special function
+			 * register name, otherwise just the register address. */
+			registerName = NULL;
+			if (fOptions.deviceIndex >= 0)
+				registerName = lookupRegisterName(fOptions.deviceIndex, dInstruction->operands[operandNum], dInstruction->resolvedOperands & (1<<operandNum));
+			if (registerName != NULL)
+				retVal = asprintf_portable(strOperand, "%s", registerName);
+			else
+				retVal = asprintf_portable(strOperand, "%s%02X%s", OPERAND_PREFIX_REGISTER, dInstruction->operands[operandNum], OPERAND_SUFFIX_REGISTER);
 			break;
 		case OPERAND_REGISTER_DEST:
 			if (dInstruction->operands[operandNum] == 0)
@@ -61,6 +61,7 @@
  * FORMAT_OPTION_LITERAL_DEC: Represent the literal operands in decimal
  * FORMAT_OPTION_LITERAL_ASCII_COMMENT: Show the ASCII value of the literal with a comment
  * FORMAT_OPTION_ORIGINAL_OPCODE: Print original opcodes alongside disassembly
+ * FORMAT_OPTION_RESOLVE_ADDRESSES: Print full page/bank qualified call/goto and register addresses
  */
 enum PIC_Formatting_Options {
 	FORMAT_OPTION_ADDRESS_LABEL 			= (1<<0),
@@ -71,6 +72,15 @@ enum PIC_Formatting_Options {
 	FORMAT_OPTION_LITERAL_DEC 			= (1<<5),
 	FORMAT_OPTION_LITERAL_ASCII_COMMENT 		= (1<<6),
 	FORMAT_OPTION_ORIGINAL_OPCODE			= (1<<7),
+	FORMAT_OPTION_RESOLVE_ADDRESSES			= (1<<8),
+};
+
+/* Output formats: the assembly text, or structured records for other
+ * programs to consume (see record.h). */
+enum PIC_Output_Formats {
+	OUTPUT_FORMAT_TEXT,
+	OUTPUT_FORMAT_JSONL,
+	OUTPUT_FORMAT_BINARY,
 };
 
 /* Structure to hold various formatting options supported
@@ -84,6 +94,14 @@ struct _formattingOptions {
 	/* Space field width for address, i.e. "001C"
  	 * has an address field width of 4. */
 	int addressFieldWidth;
+	/* Index into the device database of the device whose
+	 * register names to print, or -1 for none. */
+	int deviceIndex;
+	/* Database of known library functions to name in the
+	 * disassembly, or NULL for none. */
+	const struct _signatureDatabase *signatures;
+	/* One of the PIC_Output_Formats */
+	int outputFormat;
 };
 typedef struct _formattingOptions formattingOptions;
 
@@ -91,4 +109,9 @@ typedef struct _formattingOptions formattingOptions;
 /* Prints a disassembled instruction, formatted with options set in the formattingOptions structure. */
 int printDisassembledInstruction(FILE *out, const assembledInstruction *aInstruction, const disassembledInstruction *dInstruction, formattingOptions fOptions);
 
+/* Prints a word outside of the device's program memory (one of the
+ * PIC_Memory_Regions in pic_device.h other than REGION_PROGRAM) as an
+ * assembler directive. Requires fOptions.deviceIndex to be set. */
+int printMemoryWord(FILE *out, const assembledInstruction *aInstruction, int region, formattingOptions fOptions);
+
 #endif
@@ -0,0 +1,200 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * image.c - The in-memory program image, the assembled instructions of a
+ *  program file held in the order they were read.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "image.h"
+#include "profile.h"
+#include "errorcodes.h"
+
+/* Initial number of instructions allocated for a program image, enough
+ * for most small PIC programs without any reallocation. */
+#define PROGRAM_IMAGE_INITIAL_CAPACITY	1024
+
+/* Initializes an empty program image. */
+void initProgramImage(programImage *image) {
+	image->instructions = NULL;
+	image->numInstructions = 0;
+	image->capacity = 0;
+}
+
+/* Appends an assembled instruction to the program image, growing the
+ * instructions array as necessary. */
+int appendProgramImage(programImage *image, uint32_t address, uint16_t opcode) {
+	assembledInstruction *newInstructions;
+	int newCapacity;
+
+	if (image == NULL)
+		return ERROR_INVALID_ARGUMENTS;
+
+	/* Double the capacity when we run out of room, so appending
+	 * stays amortized constant time. */
+	if (image->numInstructions == image->capacity) {
+		newCapacity = (image->capacity == 0) ? PROGRAM_IMAGE_INITIAL_CAPACITY : image->capacity*2;
+		newInstructions = realloc(image->instructions, newCapacity*sizeof(assembledInstruction));
+		PROFILE_COUNT(PROFILE_COUNTER_ALLOCATIONS, 1);
+		if (newInstructions == NULL)
+			return ERROR_MEMORY_ALLOCATION_ERROR;
+		image->instructions = newInstructions;
+		image->capacity = newCapacity;
+	}
+
+	image->instructions[image->numInstructions].address = address;
+	image->instructions[image->numInstructions].opcode = opcode;
+	image->numInstructions++;
+	PROFILE_COUNT(PROFILE_COUNTER_WORDS, 1);
+
+	return 0;
+}
+
+/* Keeps only the instructions with an address from start to end of the
+ * program image, in the same order. */
+void selectProgramImageRange(programImage *image, uint32_t start, uint32_t end) {
+	int i, n;
+
+	n = 0;
+	for (i = 0; i < image->numInstructions; i++) {
+		if (image->instructions[i].address >= start && image->instructions[i].address <= end)
+			image->instructions[n++] = image->instructions[i];
+	}
+	image->numInstructions = n;
+}
+
+/* Structure to sort the words of a program image by address, keeping the
+ * order they were read in for the words at the same address */
+typedef struct {
+	uint32_t address;
+	int index;
+} addressedWord;
+
+static int compareAddressedWords(const void *a, const void *b) {
+	const addressedWord *wordA = a, *wordB = b;
+
+	if (wordA->address != wordB->address)
+		return (wordA->address < wordB->address) ? -1 : 1;
+	return wordA->index - wordB->index;
+}
+
+/* Reports a range of addresses written more than once with different data */
+static void reportOverlapConflict(const char *imageName, uint32_t start, uint32_t end) {
+	if (start == end)
+		fprintf(stderr, "%s: word 0x%04X is written more than once with different data\n", imageName, start);
+	else
+		fprintf(stderr, "%s: words 0x%04X-0x%04X are written more than once with different data\n", imageName, start, end);
+}
+
+/* Finds the addresses written more than once and keeps one word at each,
+ * the first or last one read, in the same order. Different data at the
+ * same address is reported to standard error, and with OVERLAP_ERROR it
+ * is an error. Returns a negative error code. */
+int resolveProgramImageOverlaps(programImage *image, const char *imageName, int policy) {
+	addressedWord *sorted;
+	char *dropped;
+	long numOverlaps, numConflicts;
+	uint32_t conflictStart = 0, conflictEnd = 0;
+	int i, j, end, keep, conflict, inConflict, n;
+
+	/* Most program files are written in address order, without any
+	 * overlaps, which takes a single pass to tell */
+	for (i = 1; i < image->numInstructions; i++) {
+		if (image->instructions[i].address <= image->instructions[i-1].address)
+			break;
+	}
+	if (i >= image->numInstructions)
+		return 0;
+
+	sorted = malloc(image->numInstructions*sizeof(addressedWord));
+	dropped = calloc(image->numInstructions, sizeof(char));
+	PROFILE_COUNT(PROFILE_COUNTER_ALLOCATIONS, 2);
+	if (sorted == NULL || dropped == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for the overlap check!\n");
+		free(sorted);
+		free(dropped);
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+	for (i = 0; i < image->numInstructions; i++) {
+		sorted[i].address = image->instructions[i].address;
+		sorted[i].index = i;
+	}
+	qsort(sorted, image->numInstructions, sizeof(addressedWord), compareAddressedWords);
+
+	/* Every run of words at the same address keeps one of them. The
+	 * addresses with different data are reported as ranges. */
+	numOverlaps = numConflicts = 0;
+	inConflict = 0;
+	for (i = 0; i < image->numInstructions; i = end) {
+		for (end = i+1; end < image->numInstructions && sorted[end].address == sorted[i].address; end++)
+			;
+		conflict = 0;
+		if (end-i > 1) {
+			numOverlaps++;
+			keep = (policy == OVERLAP_LAST) ? end-1 : i;
+			for (j = i; j < end; j++) {
+				if (j == keep)
+					continue;
+				dropped[sorted[j].index] = 1;
+				if (image->instructions[sorted[j].index].opcode != image->instructions[sorted[keep].index].opcode)
+					conflict = 1;
+			}
+		}
+
+		if (inConflict && (!conflict || sorted[i].address != conflictEnd+1)) {
+			reportOverlapConflict(imageName, conflictStart, conflictEnd);
+			inConflict = 0;
+		}
+		if (conflict) {
+			numConflicts++;
+			if (!inConflict)
+				conflictStart = sorted[i].address;
+			conflictEnd = sorted[i].address;
+			inConflict = 1;
+		}
+	}
+	if (inConflict)
+		reportOverlapConflict(imageName, conflictStart, conflictEnd);
+	if (numOverlaps > 0)
+		fprintf(stderr, "%s: %ld addresses written more than once, %ld of them with different data\n", imageName, numOverlaps, numConflicts);
+
+	for (i = 0, n = 0; i < image->numInstructions; i++) {
+		if (!dropped[i])
+			image->instructions[n++] = image->instructions[i];
+	}
+	image->numInstructions = n;
+
+	free(sorted);
+	free(dropped);
+
+	if (policy == OVERLAP_ERROR && numConflicts > 0) {
+		fprintf(stderr, "Error: Overlapping records of %s write different data to the same addresses!\n", imageName);
+		return ERROR_FILE_READING_ERROR;
+	}
+	return 0;
+}
+
+/* Frees the instructions held by the program image. */
+void freeProgramImage(programImage *image) {
+	free(image->instructions);
+	initProgramImage(image);
+}
+
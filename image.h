@@ -0,0 +1,70 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * image.h - Header file for the in-memory program image, the assembled
+ *  instructions of a program file held in the order they were read.
+ *
+ */
+
+#ifndef IMAGE_DISASM_H
+#define IMAGE_DISASM_H
+
+#include <stdint.h>
+#include "pic_disasm.h"
+
+/* Structure to hold all of the assembled instructions of a program file,
+ * so the program can be analyzed as a whole before it is printed. */
+struct _programImage {
+	/* Assembled instructions, in the order they were read from the file. */
+	assembledInstruction *instructions;
+	int numInstructions;
+	/* Number of instructions the instructions array has room for. */
+	int capacity;
+};
+typedef struct _programImage programImage;
+
+/* Enumeration for what happens to words written more than once */
+enum {
+	OVERLAP_ERROR,		/* Different data at the same address is an error */
+	OVERLAP_FIRST,		/* The word read first is kept */
+	OVERLAP_LAST,		/* The word read last is kept, like a programmer */
+};
+
+/* Initializes an empty program image. */
+void initProgramImage(programImage *image);
+
+/* Appends an assembled instruction to the program image, growing the
+ * instructions array as necessary. */
+int appendProgramImage(programImage *image, uint32_t address, uint16_t opcode);
+
+/* Keeps only the instructions with an address from start to end of the
+ * program image, in the same order. */
+void selectProgramImageRange(programImage *image, uint32_t start, uint32_t end);
+
+/* Finds the addresses written more than once and keeps one word at each,
+ * the first or last one read, in the same order. Different data at the
+ * same address is reported to standard error, and with OVERLAP_ERROR it
+ * is an error. Returns a negative error code. */
+int resolveProgramImageOverlaps(programImage *image, const char *imageName, int policy);
+
+/* Frees the instructions held by the program image. */
+void freeProgramImage(programImage *image);
+
+#endif
+
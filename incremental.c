@@ -0,0 +1,382 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * incremental.c - Incremental disassembly. The program image is split into
+ *  pages of program memory, and the rendered text of every page is kept in
+ *  a state file under the hash of everything it depends on, so the next
+ *  run only renders the pages that changed and splices in the rest.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "pic_disasm.h"
+#include "pic_analysis.h"
+#include "signature.h"
+#include "record.h"
+#include "profile.h"
+#include "file.h"
+#include "errorcodes.h"
+#include "incremental.h"
+
+/* Magic bytes at the start of a state file */
+#define INCREMENTAL_MAGIC	"vPICinc1"
+
+/* Header of a state file, followed by the page table and then the text
+ * of the pages. */
+struct _incrementalHeader {
+	char magic[8];
+	uint64_t optionsKey[2];
+	uint64_t numPages;
+};
+typedef struct _incrementalHeader incrementalHeader;
+
+/* Entry of a page in the page table of a state file, with the offset of
+ * its text from the end of the page table. */
+struct _incrementalPage {
+	uint64_t hash[2];
+	uint64_t textOffset;
+	uint64_t textLength;
+};
+typedef struct _incrementalPage incrementalPage;
+
+/* Structure to hold a page of this run until the state file is written */
+struct _renderedPage {
+	uint64_t hash[2];
+	const char *text;
+	size_t textLength;
+	/* Text rendered in this run, NULL if it is reused from the state */
+	char *rendered;
+};
+typedef struct _renderedPage renderedPage;
+
+/* Orders pages by their hash, for qsort() and bsearch() */
+static int comparePages(const void *a, const void *b) {
+	const incrementalPage *pageA = a, *pageB = b;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		if (pageA->hash[i] != pageB->hash[i])
+			return (pageA->hash[i] < pageB->hash[i]) ? -1 : 1;
+	}
+	return 0;
+}
+
+/* Reads the state file of the previous run, and sorts its page table by
+ * hash. A state file that is missing, damaged, or written with other
+ * options leaves no pages. */
+static int loadState(const char *stateFileName, const cacheKey *optionsKey, char **state, incrementalPage **pages, size_t *numPages) {
+	incrementalHeader header;
+	FILE *fileIn;
+	size_t size, textSize, i;
+	int retVal;
+
+	*state = NULL;
+	*pages = NULL;
+	*numPages = 0;
+
+	fileIn = fopen(stateFileName, "rb");
+	if (fileIn == NULL)
+		return 0;
+	retVal = readWholeFile(fileIn, state, &size);
+	fclose(fileIn);
+	if (retVal < 0)
+		return retVal;
+
+	if (size < sizeof(header))
+		return 0;
+	memcpy(&header, *state, sizeof(header));
+	if (memcmp(header.magic, INCREMENTAL_MAGIC, sizeof(header.magic)) != 0)
+		return 0;
+	if (header.optionsKey[0] != optionsKey->lanes[0] || header.optionsKey[1] != optionsKey->lanes[1])
+		return 0;
+	if (header.numPages > (size - sizeof(header)) / sizeof(incrementalPage))
+		return 0;
+
+	*pages = (incrementalPage *)(*state + sizeof(header));
+	textSize = size - sizeof(header) - header.numPages*sizeof(incrementalPage);
+	for (i = 0; i < header.numPages; i++) {
+		if ((*pages)[i].textOffset > textSize || (*pages)[i].textLength > textSize - (*pages)[i].textOffset)
+			return 0;
+	}
+
+	*numPages = header.numPages;
+	qsort(*pages, *numPages, sizeof(incrementalPage), comparePages);
+	return 0;
+}
+
+/* Hashes everything the text of a page depends on: its words, whether it
+ * continues the previous page without an org directive, and with an
+ * analysis the resolved operands and the names of recognized functions.
+ * Labels and branch comments only depend on the addresses in the page. */
+static int hashPage(uint64_t hash[2], const assembledInstruction *words, int numWords, int contiguous, int archSelect, programAnalysis *analysis, const signatureMatches *matches) {
+	disassembledInstruction dInstruction;
+	cacheKey key;
+	uint64_t values[64];
+	const char *functionName;
+	int i, j, n;
+
+	initCacheKey(&key);
+	hashCacheKey(&key, &contiguous, sizeof(contiguous));
+
+	n = 0;
+	for (i = 0; i < numWords; i++) {
+		values[n++] = ((uint64_t)words[i].address << 16) | words[i].opcode;
+
+		if (analysis != NULL) {
+			if (disassembleInstruction(&dInstruction, &words[i], archSelect) < 0)
+				return ERROR_IRRECOVERABLE;
+			resolveOperands(analysis, &dInstruction);
+			for (j = 0; j < PIC_MAX_NUM_OPERANDS; j++)
+				values[n++] = (uint32_t)dInstruction.operands[j];
+			values[n++] = dInstruction.resolvedOperands;
+		}
+
+		if (matches->numMatches > 0) {
+			functionName = lookupSignatureMatch(matches, words[i].address);
+			if (functionName != NULL) {
+				hashCacheKey(&key, values, n*sizeof(uint64_t));
+				hashCacheKey(&key, functionName, strlen(functionName));
+				n = 0;
+			}
+		}
+
+		if (n > 64-(PIC_MAX_NUM_OPERANDS+2)) {
+			hashCacheKey(&key, values, n*sizeof(uint64_t));
+			n = 0;
+		}
+	}
+	hashCacheKey(&key, values, n*sizeof(uint64_t));
+
+	hash[0] = key.lanes[0];
+	hash[1] = key.lanes[1];
+	return 0;
+}
+
+/* Renders the words of a page into a newly allocated string, the same way
+ * disassembleProgramImage() prints them. */
+static int renderPage(char **text, size_t *textLength, const assembledInstruction *words, int numWords, int contiguous, formattingOptions fOptions, int archSelect, programAnalysis *analysis, const signatureMatches *matches) {
+	FILE *pageOut;
+	int retVal;
+
+	*text = NULL;
+	*textLength = 0;
+	pageOut = open_memstream(text, textLength);
+	if (pageOut == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for formatted disassembly!\n");
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+
+	continueDisassemblyAt(contiguous ? (int)words[0].address : -5);
+	retVal = disassembleAndPrintWords(pageOut, words, numWords, fOptions, archSelect, analysis, matches);
+
+	if (fclose(pageOut) != 0 && retVal == 0) {
+		fprintf(stderr, "Error allocating sufficient memory for formatted disassembly!\n");
+		retVal = ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+	if (retVal < 0) {
+		free(*text);
+		*text = NULL;
+	}
+	return retVal;
+}
+
+/* Writes the pages of this run to a temporary file next to the state
+ * file, and renames it over the state file once it is complete. */
+static int saveState(const char *stateFileName, const cacheKey *optionsKey, const renderedPage *pages, size_t numPages) {
+	incrementalHeader header;
+	incrementalPage page;
+	char *tempName;
+	FILE *fileOut;
+	uint64_t textOffset;
+	size_t i;
+	int failed;
+
+	if (asprintf(&tempName, "%s.tmp", stateFileName) < 0)
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	fileOut = fopen(tempName, "wb");
+	if (fileOut == NULL) {
+		free(tempName);
+		return ERROR_FILE_WRITING_ERROR;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, INCREMENTAL_MAGIC, sizeof(header.magic));
+	header.optionsKey[0] = optionsKey->lanes[0];
+	header.optionsKey[1] = optionsKey->lanes[1];
+	header.numPages = numPages;
+	failed = (fwrite(&header, sizeof(header), 1, fileOut) != 1);
+
+	textOffset = 0;
+	for (i = 0; i < numPages && !failed; i++) {
+		page.hash[0] = pages[i].hash[0];
+		page.hash[1] = pages[i].hash[1];
+		page.textOffset = textOffset;
+		page.textLength = pages[i].textLength;
+		textOffset += pages[i].textLength;
+		failed = (fwrite(&page, sizeof(page), 1, fileOut) != 1);
+	}
+	for (i = 0; i < numPages && !failed; i++)
+		failed = (fwrite(pages[i].text, 1, pages[i].textLength, fileOut) != pages[i].textLength);
+
+	if (fclose(fileOut) != 0)
+		failed = 1;
+	if (!failed && rename(tempName, stateFileName) < 0)
+		failed = 1;
+	if (failed)
+		remove(tempName);
+	free(tempName);
+
+	return failed ? ERROR_FILE_WRITING_ERROR : 0;
+}
+
+/* Disassembles and prints a program image like disassembleProgramImage(),
+ * reusing the rendered text of every page whose words, resolved operands
+ * and function names are unchanged since the run that wrote the state
+ * file. optionsKey identifies the formatting options; a state file
+ * written with other options is not used. The state file is replaced
+ * with the pages of this run. */
+int disassembleIncremental(FILE *fileOut, const programImage *image, formattingOptions fOptions, int archSelect, const cacheKey *optionsKey, const char *stateFileName) {
+	programAnalysis analysis, *pAnalysis;
+	signatureMatches matches;
+	char *state;
+	incrementalPage *oldPages, *oldPage, wanted;
+	size_t numOldPages, numPages, i;
+	renderedPage *pages;
+	int start, end, contiguous, retVal, previousStage;
+	uint32_t page;
+
+	retVal = loadState(stateFileName, optionsKey, &state, &oldPages, &numOldPages);
+	if (retVal < 0) {
+		fprintf(stderr, "Error: Cannot read the incremental state file %s!\n", stateFileName);
+		return retVal;
+	}
+
+	/* Every instruction gets at most a page of its own */
+	pages = malloc((image->numInstructions+1) * sizeof(renderedPage));
+	if (pages == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for the incremental disassembly!\n");
+		free(state);
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+	numPages = 0;
+
+	pAnalysis = NULL;
+	memset(&matches, 0, sizeof(matches));
+	if ((fOptions.options & FORMAT_OPTION_RESOLVE_ADDRESSES) || fOptions.signatures != NULL) {
+		previousStage = PROFILE_SWITCH(PROFILE_STAGE_ANALYZE);
+		retVal = analyzeProgramImage(&analysis, image, archSelect);
+		PROFILE_SWITCH(previousStage);
+		switch (retVal) {
+			case 0:
+				pAnalysis = &analysis;
+				break;
+			case ERROR_MEMORY_ALLOCATION_ERROR:
+				fprintf(stderr, "Error allocating sufficient memory for program analysis!\n");
+				break;
+			default:
+				fprintf(stderr, "Encountered an irrecoverable error during program analysis!\n");
+				retVal = ERROR_IRRECOVERABLE;
+				break;
+		}
+	}
+
+	/* Recognize the known library functions of the program */
+	if (retVal == 0 && fOptions.signatures != NULL) {
+		previousStage = PROFILE_SWITCH(PROFILE_STAGE_ANALYZE);
+		retVal = matchSignatures(&matches, fOptions.signatures, pAnalysis);
+		PROFILE_SWITCH(previousStage);
+		if (retVal < 0) {
+			fprintf(stderr, "Error allocating sufficient memory for signature matching!\n");
+			retVal = ERROR_MEMORY_ALLOCATION_ERROR;
+		} else if (!(fOptions.options & FORMAT_OPTION_RESOLVE_ADDRESSES)) {
+			/* The analysis was only needed for the function candidates */
+			freeProgramAnalysis(pAnalysis);
+			pAnalysis = NULL;
+		}
+	}
+
+	previousStage = PROFILE_SWITCH(PROFILE_STAGE_FORMAT);
+	if (retVal == 0) {
+		retVal = writeRecordHeader(fileOut, archSelect, fOptions);
+		if (retVal < 0)
+			fprintf(stderr, "Error writing formatted disassembly to file!\n");
+	}
+
+	/* A page is a run of words in the same page of program memory, in
+	 * the order they were read from the file */
+	for (start = 0; start < image->numInstructions && retVal == 0; start = end) {
+		page = image->instructions[start].address / INCREMENTAL_PAGE_WORDS;
+		for (end = start+1; end < image->numInstructions; end++) {
+			if (image->instructions[end].address / INCREMENTAL_PAGE_WORDS != page)
+				break;
+		}
+		contiguous = (start > 0 && image->instructions[start].address == image->instructions[start-1].address+1);
+
+		PROFILE_SWITCH(PROFILE_STAGE_DECODE);
+		retVal = hashPage(wanted.hash, &image->instructions[start], end-start, contiguous, archSelect, pAnalysis, &matches);
+		PROFILE_SWITCH(PROFILE_STAGE_FORMAT);
+		if (retVal < 0) {
+			fprintf(stderr, "Encountered an irrecoverable error during disassembly!\n");
+			break;
+		}
+
+		pages[numPages].hash[0] = wanted.hash[0];
+		pages[numPages].hash[1] = wanted.hash[1];
+		pages[numPages].rendered = NULL;
+		oldPage = NULL;
+		if (numOldPages > 0)
+			oldPage = bsearch(&wanted, oldPages, numOldPages, sizeof(incrementalPage), comparePages);
+		if (oldPage != NULL) {
+			pages[numPages].text = state + sizeof(incrementalHeader) + numOldPages*sizeof(incrementalPage) + oldPage->textOffset;
+			pages[numPages].textLength = oldPage->textLength;
+		} else {
+			retVal = renderPage(&pages[numPages].rendered, &pages[numPages].textLength, &image->instructions[start], end-start, contiguous, fOptions, archSelect, pAnalysis, &matches);
+			if (retVal < 0)
+				break;
+			pages[numPages].text = pages[numPages].rendered;
+		}
+
+		if (fwrite(pages[numPages].text, 1, pages[numPages].textLength, fileOut) != pages[numPages].textLength) {
+			fprintf(stderr, "Error writing formatted disassembly to file!\n");
+			retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		numPages++;
+	}
+	PROFILE_SWITCH(previousStage);
+
+	if (retVal == 0)
+		retVal = finishDisassembly(fileOut, fOptions);
+
+	/* The output is complete without the state, so only warn */
+	if (retVal == 0 && saveState(stateFileName, optionsKey, pages, numPages) < 0)
+		fprintf(stderr, "Warning: Cannot write the incremental state file %s!\n", stateFileName);
+
+	for (i = 0; i < numPages; i++)
+		free(pages[i].rendered);
+	free(pages);
+	free(state);
+	if (pAnalysis != NULL)
+		freeProgramAnalysis(pAnalysis);
+	freeSignatureMatches(&matches);
+
+	return retVal;
+}
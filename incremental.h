@@ -0,0 +1,45 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * incremental.h - Header file for the incremental disassembly, which
+ *  renders again only the pages of program memory that changed since the
+ *  previous run.
+ *
+ */
+
+#ifndef INCREMENTAL_DISASM_H
+#define INCREMENTAL_DISASM_H
+
+#include <stdio.h>
+#include "format.h"
+#include "image.h"
+#include "cache.h"
+
+/* Number of words in a page of the incremental disassembly */
+#define INCREMENTAL_PAGE_WORDS	256
+
+/* Disassembles and prints a program image like disassembleProgramImage(),
+ * reusing the rendered text of every page whose words, resolved operands
+ * and function names are unchanged since the run that wrote the state
+ * file. optionsKey identifies the formatting options; a state file
+ * written with other options is not used. The state file is replaced
+ * with the pages of this run. */
+int disassembleIncremental(FILE *fileOut, const programImage *image, formattingOptions fOptions, int archSelect, const cacheKey *optionsKey, const char *stateFileName);
+
+#endif
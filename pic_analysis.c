@@ -0,0 +1,706 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * pic_analysis.c - Page and bank selection dataflow analysis, used to
+ *  resolve the full addresses of call/goto destinations and file register
+ *  operands.
+ *
+ */
+
+/* The call and goto instructions only encode the low bits of their
+ * destination (11 bits on Mid-Range, 9 bits on Baseline), the rest come
+ * from PCLATH or the STATUS page bits at the time of the jump. File register
+ * operands likewise only encode the offset into the bank selected by the
+ * STATUS RP bits, BSR, or FSR. In order to print full addresses, we split
+ * the program into basic blocks, and propagate the known bits of the page
+ * register, bank register, and W from block to block with a worklist until
+ * nothing changes. Every block state can only lose known bits, so this
+ * terminates after a small constant number of visits per block. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "pic_analysis.h"
+#include "profile.h"
+#include "errorcodes.h"
+
+/* Array of PIC instruction sets as defined in pic_instructionset.c,
+ * enumerated by PIC_Instruction_Set_Index enum in pic_disasm.h */
+extern instructionSetInfo allInstructionSets[];
+
+/* Instruction kinds, as far as the analysis is concerned */
+enum Analysis_Instruction_Kinds {
+	KIND_NONE,		/* Leaves the tracked registers alone */
+	KIND_LITERAL,		/* Writes W with a value we don't track */
+	KIND_FILE,		/* Writes W or a file register, with a d operand */
+	KIND_MOVLW,
+	KIND_CLRW,
+	KIND_MOVWF,
+	KIND_CLRF,
+	KIND_BCF,
+	KIND_BSF,
+	KIND_MOVLB,
+	KIND_MOVLP,
+	KIND_TRIS,
+	KIND_SKIP_BIT,		/* btfsc, btfss */
+	KIND_SKIP_FILE,		/* decfsz, incfsz */
+	KIND_GOTO,
+	KIND_CALL,
+	KIND_BRA,
+	KIND_BRW,
+	KIND_CALLW,
+	KIND_RETURN,		/* return, retlw, retfie, reset */
+	KIND_DATA,
+};
+
+/* Mnemonics with a kind other than the one guessed from their operands */
+static const struct {
+	const char *mnemonic;
+	int kind;
+} mnemonicKinds[] = {
+	{"movlw", KIND_MOVLW}, {"clrw", KIND_CLRW}, {"movwf", KIND_MOVWF},
+	{"clrf", KIND_CLRF}, {"bcf", KIND_BCF}, {"bsf", KIND_BSF},
+	{"movlb", KIND_MOVLB}, {"movlp", KIND_MOVLP}, {"tris", KIND_TRIS},
+	{"btfsc", KIND_SKIP_BIT}, {"btfss", KIND_SKIP_BIT},
+	{"decfsz", KIND_SKIP_FILE}, {"incfsz", KIND_SKIP_FILE},
+	{"goto", KIND_GOTO}, {"call", KIND_CALL}, {"bra", KIND_BRA},
+	{"brw", KIND_BRW}, {"callw", KIND_CALLW},
+	{"return", KIND_RETURN}, {"retlw", KIND_RETURN},
+	{"retfie", KIND_RETURN}, {"reset", KIND_RETURN},
+	{"data", KIND_DATA},
+	{"addlw", KIND_LITERAL}, {"andlw", KIND_LITERAL}, {"iorlw", KIND_LITERAL},
+	{"sublw", KIND_LITERAL}, {"xorlw", KIND_LITERAL}, {"moviw", KIND_LITERAL},
+	{NULL, KIND_NONE}
+};
+
+/* Core registers used for page and bank selection */
+#define REGISTER_PCL		0x02
+#define REGISTER_STATUS		0x03
+#define REGISTER_FSR		0x04
+#define REGISTER_BSR		0x08
+#define REGISTER_PCLATH		0x0A
+
+/* Size of a program memory page and the total addressable program memory
+ * of each architecture. Words beyond the program memory (configuration
+ * words, ID locations, EEPROM data) are left out of the analysis. */
+#define BASELINE_PAGE_SIZE		0x200
+#define MIDRANGE_PAGE_SIZE		0x800
+#define BASELINE_PROGRAM_MEMORY_SIZE	0x800
+#define MIDRANGE_PROGRAM_MEMORY_SIZE	0x2000
+#define ENHANCED_PROGRAM_MEMORY_SIZE	0x8000
+
+/* Classifies an instruction of the instruction set for the analysis. */
+static int classifyInstruction(const instructionInfo *instruction);
+/* Applies the effect of an instruction on the selection state. */
+static void transferInstruction(selectionState *state, const analyzedInstruction *aInstruction, int archSelect);
+/* Applies a write of the writeMask bits of a value, with known bits valueKnown, to a file register. */
+static void writeRegister(selectionState *state, int archSelect, int32_t reg, uint8_t value, uint8_t valueKnown, uint8_t writeMask);
+/* Returns whether the file register is in banked (as opposed to shared) data memory. */
+static int isBankedRegister(int archSelect, int32_t reg);
+/* Merges the state from another path into a block's entry state,
+ * returns non-zero if the entry state changed. */
+static int mergeState(selectionState *dest, const selectionState *src);
+/* Look up the index of the instruction at an address, or -1 if the
+ * program image does not contain it. */
+static int findInstruction(const programAnalysis *analysis, uint32_t address);
+/* Returns whether the instruction ends a basic block. */
+static int endsBlock(const analyzedInstruction *aInstruction);
+
+/* Comparison for sorting the instructions by address, keeping the
+ * original file order of instructions with the same address. */
+static int compareAddress(const void *a, const void *b) {
+	const assembledInstruction *x = *(const assembledInstruction **)a;
+	const assembledInstruction *y = *(const assembledInstruction **)b;
+
+	if (x->address != y->address)
+		return (x->address < y->address) ? -1 : 1;
+	return (x < y) ? -1 : (x > y);
+}
+
+/* Builds the control flow graph of the program image and propagates the
+ * page and bank selection states through it until they are stable. */
+int analyzeProgramImage(programAnalysis *analysis, const programImage *image, int archSelect) {
+	const assembledInstruction **sorted = NULL;
+	disassembledInstruction dInstruction;
+	instructionInfo *instructionSet;
+	uint8_t kinds[PIC_TOTAL_PIC18_INSTRUCTIONS];
+	char *leaders = NULL;
+	int *worklist = NULL;
+	char *queued = NULL;
+	uint32_t programMemorySize, pageSize, k;
+	int i, j, n, b, head, tail, retVal;
+
+	memset(analysis, 0, sizeof(programAnalysis));
+	analysis->archSelect = archSelect;
+	analysis->cursorIndex = -1;
+
+	switch (archSelect) {
+		case PIC_BASELINE:
+			programMemorySize = BASELINE_PROGRAM_MEMORY_SIZE;
+			pageSize = BASELINE_PAGE_SIZE;
+			break;
+		case PIC_MIDRANGE:
+			programMemorySize = MIDRANGE_PROGRAM_MEMORY_SIZE;
+			pageSize = MIDRANGE_PAGE_SIZE;
+			break;
+		case PIC_MIDRANGE_ENHANCED:
+			programMemorySize = ENHANCED_PROGRAM_MEMORY_SIZE;
+			pageSize = MIDRANGE_PAGE_SIZE;
+			break;
+		default:
+			return ERROR_INVALID_ARGUMENTS;
+	}
+
+	/* Classify every instruction of the instruction set once, so the
+	 * analysis never has to compare mnemonics per instruction. */
+	instructionSet = allInstructionSets[archSelect].instructionSet;
+	for (i = 0; i < allInstructionSets[archSelect].numInstructions; i++)
+		kinds[i] = classifyInstruction(&instructionSet[i]);
+
+	/* Sort the program memory instructions by address */
+	sorted = malloc((image->numInstructions+1)*sizeof(assembledInstruction *));
+	if (sorted == NULL)
+		goto allocationError;
+	for (i = 0, n = 0; i < image->numInstructions; i++) {
+		if (image->instructions[i].address < programMemorySize)
+			sorted[n++] = &image->instructions[i];
+	}
+	qsort(sorted, n, sizeof(assembledInstruction *), compareAddress);
+
+	analysis->instructions = malloc((n+1)*sizeof(analyzedInstruction));
+	analysis->instructionBlocks = malloc((n+1)*sizeof(int));
+	leaders = calloc(n+1, sizeof(char));
+	PROFILE_COUNT(PROFILE_COUNTER_ALLOCATIONS, 4);
+	if (analysis->instructions == NULL || analysis->instructionBlocks == NULL || leaders == NULL)
+		goto allocationError;
+
+	/* Decode each instruction, where an address appears more than once
+	 * the last one read from the file is the one that gets programmed. */
+	for (i = 0, j = 0; i < n; i++) {
+		if (i+1 < n && sorted[i+1]->address == sorted[i]->address)
+			continue;
+		retVal = disassembleInstruction(&dInstruction, sorted[i], archSelect);
+		if (retVal < 0) {
+			free(sorted);
+			free(leaders);
+			freeProgramAnalysis(analysis);
+			return retVal;
+		}
+		analysis->instructions[j].address = dInstruction.address;
+		analysis->instructions[j].opcode = sorted[i]->opcode;
+		analysis->instructions[j].operands[0] = dInstruction.operands[0];
+		analysis->instructions[j].operands[1] = dInstruction.operands[1];
+		analysis->instructions[j].kind = kinds[dInstruction.instruction - instructionSet];
+		j++;
+	}
+	analysis->numInstructions = n = j;
+	free(sorted);
+	sorted = NULL;
+
+	/* Find the page register bits needed to address the entire image. */
+	analysis->numPages = (n > 0) ? analysis->instructions[n-1].address/pageSize + 1 : 1;
+	for (k = 1; (int)k < analysis->numPages; k <<= 1)
+		;
+	analysis->pageBitsNeeded = (archSelect == PIC_BASELINE) ? (k-1) : ((k-1) << 3);
+
+	/* Mark the leaders of the basic blocks: the first instruction, any
+	 * instruction after a gap in the addresses or after a control flow
+	 * instruction, and every possible destination of a jump. */
+	for (i = 0; i < n; i++) {
+		analyzedInstruction *ai = &analysis->instructions[i];
+
+		if (i == 0 || ai->address != analysis->instructions[i-1].address+1 || endsBlock(&analysis->instructions[i-1]))
+			leaders[i] = 1;
+
+		switch (ai->kind) {
+			case KIND_GOTO:
+			case KIND_CALL:
+				for (j = 0; j < analysis->numPages; j++) {
+					b = findInstruction(analysis, j*pageSize + ai->operands[0]);
+					if (b >= 0)
+						leaders[b] = 1;
+				}
+				break;
+			case KIND_BRA:
+				b = findInstruction(analysis, ai->address + ai->operands[0] + 1);
+				if (b >= 0)
+					leaders[b] = 1;
+				break;
+			case KIND_SKIP_BIT:
+			case KIND_SKIP_FILE:
+				b = findInstruction(analysis, ai->address + 2);
+				if (b >= 0)
+					leaders[b] = 1;
+				break;
+			default:
+				break;
+		}
+	}
+
+	/* The reset and interrupt vectors are entered with states of their
+	 * own, so they start blocks of their own too, or the unknown state
+	 * at the interrupt vector would be merged into the reset block. */
+	b = findInstruction(analysis, 0);
+	if (b >= 0)
+		leaders[b] = 1;
+	b = (archSelect != PIC_BASELINE) ? findInstruction(analysis, 4) : -1;
+	if (b >= 0)
+		leaders[b] = 1;
+
+	/* Split the instructions into basic blocks at the leaders */
+	for (i = 0, b = 0; i < n; i++)
+		b += leaders[i];
+	analysis->numBlocks = b;
+	analysis->blocks = calloc(b+1, sizeof(basicBlock));
+	worklist = malloc((b+1)*sizeof(int));
+	queued = calloc(b+1, sizeof(char));
+	PROFILE_COUNT(PROFILE_COUNTER_ALLOCATIONS, 3);
+	if (analysis->blocks == NULL || worklist == NULL || queued == NULL)
+		goto allocationError;
+
+	for (i = 0, b = -1; i < n; i++) {
+		if (leaders[i]) {
+			b++;
+			analysis->blocks[b].start = i;
+		}
+		analysis->blocks[b].end = i+1;
+		analysis->instructionBlocks[i] = b;
+	}
+	free(leaders);
+	leaders = NULL;
+
+	/* Seed the worklist with the entry points of the program */
+	head = tail = 0;
+	for (i = 0; i < 3 && n > 0; i++) {
+		selectionState entry;
+		memset(&entry, 0, sizeof(entry));
+		entry.reached = 1;
+
+		if (i == 0) {
+			/* Reset vector, where the page and bank bits are cleared
+			 * (except for the FSR bank bits on Baseline) */
+			j = findInstruction(analysis, 0);
+			entry.pageKnown = 0xFF;
+			if (archSelect != PIC_BASELINE)
+				entry.bankKnown = 0xFF;
+		} else if (i == 1) {
+			/* Interrupt vector */
+			j = (archSelect != PIC_BASELINE) ? findInstruction(analysis, 4) : -1;
+		} else {
+			/* An image that doesn't start at the reset vector */
+			j = (analysis->instructions[0].address != 0) ? 0 : -1;
+		}
+		if (j < 0)
+			continue;
+
+		b = analysis->instructionBlocks[j];
+		if (mergeState(&analysis->blocks[b].in, &entry) && !queued[b]) {
+			queued[b] = 1;
+			worklist[tail] = b;
+			tail = (tail+1) % (analysis->numBlocks+1);
+		}
+	}
+
+	/* Propagate the block states along the control flow edges */
+	while (head != tail) {
+		selectionState state, successors[2];
+		uint32_t destinations[ENHANCED_PROGRAM_MEMORY_SIZE/MIDRANGE_PAGE_SIZE + 1];
+		int numDestinations, numFallthrough;
+		analyzedInstruction *last;
+
+		b = worklist[head];
+		head = (head+1) % (analysis->numBlocks+1);
+		queued[b] = 0;
+
+		state = analysis->blocks[b].in;
+		for (i = analysis->blocks[b].start; i < analysis->blocks[b].end-1; i++)
+			transferInstruction(&state, &analysis->instructions[i], archSelect);
+		last = &analysis->instructions[analysis->blocks[b].end-1];
+
+		/* Jump destinations are reached with the state before the last
+		 * instruction (a call only clobbers the state for the fall
+		 * through), skips and fall throughs with the state after it. */
+		numDestinations = 0;
+		numFallthrough = 1;
+		successors[0] = state;
+		transferInstruction(&state, last, archSelect);
+		successors[1] = state;
+
+		switch (last->kind) {
+			case KIND_GOTO:
+			case KIND_CALL:
+				/* Every page consistent with the known page bits */
+				for (j = 0; j < analysis->numPages; j++) {
+					uint8_t pageBits = (archSelect == PIC_BASELINE) ? j : (j << 3);
+					if (((pageBits ^ successors[0].page) & successors[0].pageKnown & analysis->pageBitsNeeded) == 0)
+						destinations[numDestinations++] = j*pageSize + last->operands[0];
+				}
+				if (last->kind == KIND_GOTO)
+					numFallthrough = 0;
+				break;
+			case KIND_BRA:
+				destinations[numDestinations++] = last->address + last->operands[0] + 1;
+				numFallthrough = 0;
+				break;
+			case KIND_SKIP_BIT:
+			case KIND_SKIP_FILE:
+				destinations[numDestinations++] = last->address + 2;
+				successors[0] = successors[1];
+				break;
+			case KIND_RETURN:
+			case KIND_DATA:
+				numFallthrough = 0;
+				break;
+			default:
+				/* Computed jumps (brw, writes to PCL) usually index a
+				 * table right after them, so we continue there. */
+				break;
+		}
+
+		for (i = 0; i < numDestinations + numFallthrough; i++) {
+			uint32_t address;
+			selectionState *successor;
+
+			if (i < numDestinations) {
+				address = destinations[i];
+				successor = &successors[0];
+			} else {
+				address = last->address + 1;
+				successor = &successors[1];
+			}
+
+			j = findInstruction(analysis, address);
+			if (j < 0)
+				continue;
+			j = analysis->instructionBlocks[j];
+			if (mergeState(&analysis->blocks[j].in, successor) && !queued[j]) {
+				queued[j] = 1;
+				worklist[tail] = j;
+				tail = (tail+1) % (analysis->numBlocks+1);
+			}
+		}
+	}
+
+	free(worklist);
+	free(queued);
+
+	return 0;
+
+	allocationError:
+	free(sorted);
+	free(leaders);
+	free(worklist);
+	free(queued);
+	freeProgramAnalysis(analysis);
+	return ERROR_MEMORY_ALLOCATION_ERROR;
+}
+
+/* Replaces the call/goto destination and file register operands of a
+ * disassembled instruction with their full page or bank qualified addresses,
+ * where the analysis could determine them, and marks them in
+ * resolvedOperands. */
+int resolveOperands(programAnalysis *analysis, disassembledInstruction *dInstruction) {
+	basicBlock *block;
+	selectionState state;
+	int index, i;
+	uint8_t bankBitsNeeded;
+	int bankShift;
+	uint32_t pageSize;
+
+	if (analysis == NULL || dInstruction == NULL)
+		return ERROR_INVALID_ARGUMENTS;
+
+	/* Most of the time we are called on the instruction right after
+	 * the previous one, so check that before searching. */
+	if (analysis->cursorIndex >= 0 && analysis->cursorIndex+1 < analysis->numInstructions &&
+	    analysis->instructions[analysis->cursorIndex+1].address == dInstruction->address)
+		index = analysis->cursorIndex+1;
+	else
+		index = findInstruction(analysis, dInstruction->address);
+	if (index < 0)
+		return 0;
+
+	/* Find the state before this instruction, either from the previous
+	 * instruction in the same block, or by replaying the block. */
+	block = &analysis->blocks[analysis->instructionBlocks[index]];
+	if (index == analysis->cursorIndex+1 && index != block->start) {
+		state = analysis->cursorState;
+		transferInstruction(&state, &analysis->instructions[index-1], analysis->archSelect);
+	} else {
+		state = block->in;
+		for (i = block->start; i < index; i++)
+			transferInstruction(&state, &analysis->instructions[i], analysis->archSelect);
+	}
+	analysis->cursorIndex = index;
+	analysis->cursorState = state;
+
+	/* The tris operand always names a port in bank 0 */
+	if (analysis->instructions[index].kind == KIND_TRIS) {
+		dInstruction->resolvedOperands |= (1<<0);
+		return 0;
+	}
+
+	if (!state.reached)
+		return 0;
+
+	if (analysis->archSelect == PIC_BASELINE) {
+		pageSize = BASELINE_PAGE_SIZE;
+		bankBitsNeeded = 0x03;
+		bankShift = 5;
+	} else {
+		pageSize = MIDRANGE_PAGE_SIZE;
+		bankBitsNeeded = (analysis->archSelect == PIC_MIDRANGE_ENHANCED) ? 0x1F : 0x03;
+		bankShift = 7;
+	}
+
+	for (i = 0; i < dInstruction->instruction->numOperands; i++) {
+		switch (dInstruction->instruction->operandTypes[i]) {
+			case OPERAND_ABSOLUTE_ADDRESS:
+				if ((state.pageKnown & analysis->pageBitsNeeded) != analysis->pageBitsNeeded)
+					break;
+				if (analysis->archSelect == PIC_BASELINE)
+					dInstruction->operands[i] += (state.page & analysis->pageBitsNeeded)*pageSize;
+				else
+					dInstruction->operands[i] += ((state.page & analysis->pageBitsNeeded) >> 3)*pageSize;
+				dInstruction->resolvedOperands |= (1<<i);
+				break;
+			case OPERAND_REGISTER:
+				if (isBankedRegister(analysis->archSelect, dInstruction->operands[i])) {
+					if ((state.bankKnown & bankBitsNeeded) != bankBitsNeeded)
+						break;
+					dInstruction->operands[i] += (state.bank & bankBitsNeeded) << bankShift;
+				}
+				dInstruction->resolvedOperands |= (1<<i);
+				break;
+			default:
+				break;
+		}
+	}
+
+	return 0;
+}
+
+/* Frees the memory held by the analysis. */
+void freeProgramAnalysis(programAnalysis *analysis) {
+	free(analysis->instructions);
+	free(analysis->instructionBlocks);
+	free(analysis->blocks);
+	analysis->instructions = NULL;
+	analysis->instructionBlocks = NULL;
+	analysis->blocks = NULL;
+	analysis->numInstructions = 0;
+	analysis->numBlocks = 0;
+	analysis->cursorIndex = -1;
+}
+
+/* Classifies an instruction of the instruction set for the analysis. */
+static int classifyInstruction(const instructionInfo *instruction) {
+	int i;
+
+	for (i = 0; mnemonicKinds[i].mnemonic != NULL; i++) {
+		if (strcmp(mnemonicKinds[i].mnemonic, instruction->mnemonic) == 0)
+			return mnemonicKinds[i].kind;
+	}
+
+	/* Any other instruction with a destination operand (addwf, movf, ...) */
+	if (instruction->numOperands == 2 && instruction->operandTypes[0] == OPERAND_REGISTER &&
+	    instruction->operandTypes[1] == OPERAND_REGISTER_DEST)
+		return KIND_FILE;
+
+	return KIND_NONE;
+}
+
+/* Applies the effect of an instruction on the selection state. */
+static void transferInstruction(selectionState *state, const analyzedInstruction *aInstruction, int archSelect) {
+	switch (aInstruction->kind) {
+		case KIND_LITERAL:
+			state->wKnown = 0;
+			break;
+		case KIND_MOVLW:
+			state->w = aInstruction->operands[0];
+			state->wKnown = 0xFF;
+			break;
+		case KIND_CLRW:
+			state->w = 0;
+			state->wKnown = 0xFF;
+			break;
+		case KIND_MOVWF:
+			writeRegister(state, archSelect, aInstruction->operands[0], state->w, state->wKnown, 0xFF);
+			break;
+		case KIND_CLRF:
+			writeRegister(state, archSelect, aInstruction->operands[0], 0, 0xFF, 0xFF);
+			break;
+		case KIND_BCF:
+			writeRegister(state, archSelect, aInstruction->operands[0], 0, 1 << aInstruction->operands[1], 1 << aInstruction->operands[1]);
+			break;
+		case KIND_BSF:
+			writeRegister(state, archSelect, aInstruction->operands[0], 1 << aInstruction->operands[1], 1 << aInstruction->operands[1], 1 << aInstruction->operands[1]);
+			break;
+		case KIND_MOVLB:
+			state->bank = aInstruction->operands[0];
+			state->bankKnown = 0xFF;
+			break;
+		case KIND_MOVLP:
+			state->page = aInstruction->operands[0];
+			state->pageKnown = 0xFF;
+			break;
+		case KIND_FILE:
+		case KIND_SKIP_FILE:
+			/* d = 0 writes the result to W, d = 1 back to the register */
+			if (aInstruction->operands[1] == 0)
+				state->wKnown = 0;
+			else
+				writeRegister(state, archSelect, aInstruction->operands[0], 0, 0, 0xFF);
+			break;
+		case KIND_CALL:
+		case KIND_CALLW:
+			/* We can't know what the subroutine leaves behind */
+			state->pageKnown = 0;
+			state->bankKnown = 0;
+			state->wKnown = 0;
+			break;
+		default:
+			break;
+	}
+}
+
+/* Applies a write of the writeMask bits of a value, with known bits
+ * valueKnown, to a file register. Written bits outside of valueKnown
+ * become unknown, bits outside of writeMask are left alone. */
+static void writeRegister(selectionState *state, int archSelect, int32_t reg, uint8_t value, uint8_t valueKnown, uint8_t writeMask) {
+	uint8_t *field, *fieldKnown;
+	int shift, width;
+
+	if (reg == REGISTER_STATUS && archSelect == PIC_BASELINE) {
+		/* PA2:PA0 page bits */
+		field = &state->page, fieldKnown = &state->pageKnown;
+		shift = 5, width = 3;
+	} else if (reg == REGISTER_FSR && archSelect == PIC_BASELINE) {
+		/* FSR<6:5> bank bits */
+		field = &state->bank, fieldKnown = &state->bankKnown;
+		shift = 5, width = 2;
+	} else if (reg == REGISTER_STATUS && archSelect == PIC_MIDRANGE) {
+		/* RP1:RP0 bank bits */
+		field = &state->bank, fieldKnown = &state->bankKnown;
+		shift = 5, width = 2;
+	} else if (reg == REGISTER_BSR && archSelect == PIC_MIDRANGE_ENHANCED) {
+		field = &state->bank, fieldKnown = &state->bankKnown;
+		shift = 0, width = 5;
+	} else if (reg == REGISTER_PCLATH && archSelect != PIC_BASELINE) {
+		field = &state->page, fieldKnown = &state->pageKnown;
+		shift = 0, width = 7;
+	} else {
+		return;
+	}
+
+	writeMask = (writeMask >> shift) & ((1 << width) - 1);
+	value = (value >> shift) & writeMask;
+	valueKnown = (valueKnown >> shift) & writeMask;
+
+	*field = (*field & ~writeMask) | value;
+	*fieldKnown = (*fieldKnown & ~writeMask) | valueKnown;
+}
+
+/* Returns whether the file register is in banked (as opposed to shared) data memory. */
+static int isBankedRegister(int archSelect, int32_t reg) {
+	switch (archSelect) {
+		case PIC_BASELINE:
+			/* SFRs and shared GPRs in 0x00-0x0F */
+			return reg >= 0x10;
+		case PIC_MIDRANGE:
+			/* INDF, PCL, STATUS, FSR, PCLATH, INTCON are mirrored in every bank */
+			return !(reg == 0x00 || reg == 0x02 || reg == 0x03 || reg == 0x04 || reg == 0x0A || reg == 0x0B);
+		case PIC_MIDRANGE_ENHANCED:
+			/* Core registers in 0x00-0x0B and common RAM in 0x70-0x7F */
+			return !(reg <= 0x0B || reg >= 0x70);
+		default:
+			return 0;
+	}
+}
+
+/* Merges the state from another path into a block's entry state,
+ * returns non-zero if the entry state changed. */
+static int mergeState(selectionState *dest, const selectionState *src) {
+	selectionState merged;
+
+	if (!src->reached)
+		return 0;
+	if (!dest->reached) {
+		*dest = *src;
+		return 1;
+	}
+
+	/* Only keep the bits both paths know and agree on */
+	merged.pageKnown = dest->pageKnown & src->pageKnown & ~(dest->page ^ src->page);
+	merged.page = dest->page & merged.pageKnown;
+	merged.bankKnown = dest->bankKnown & src->bankKnown & ~(dest->bank ^ src->bank);
+	merged.bank = dest->bank & merged.bankKnown;
+	merged.wKnown = dest->wKnown & src->wKnown & ~(dest->w ^ src->w);
+	merged.w = dest->w & merged.wKnown;
+	merged.reached = 1;
+
+	if (merged.pageKnown == dest->pageKnown && merged.bankKnown == dest->bankKnown && merged.wKnown == dest->wKnown)
+		return 0;
+
+	*dest = merged;
+	return 1;
+}
+
+/* Look up the index of the instruction at an address, or -1 if the
+ * program image does not contain it. */
+static int findInstruction(const programAnalysis *analysis, uint32_t address) {
+	int low, high, middle;
+
+	low = 0;
+	high = analysis->numInstructions-1;
+	while (low <= high) {
+		middle = low + (high-low)/2;
+		if (analysis->instructions[middle].address == address)
+			return middle;
+		else if (analysis->instructions[middle].address < address)
+			low = middle+1;
+		else
+			high = middle-1;
+	}
+
+	return -1;
+}
+
+/* Returns whether the instruction ends a basic block. */
+static int endsBlock(const analyzedInstruction *aInstruction) {
+	switch (aInstruction->kind) {
+		case KIND_GOTO:
+		case KIND_CALL:
+		case KIND_BRA:
+		case KIND_BRW:
+		case KIND_CALLW:
+		case KIND_RETURN:
+		case KIND_DATA:
+		case KIND_SKIP_BIT:
+		case KIND_SKIP_FILE:
+			return 1;
+		case KIND_MOVWF:
+		case KIND_CLRF:
+			return aInstruction->operands[0] == REGISTER_PCL;
+		case KIND_FILE:
+			return aInstruction->operands[0] == REGISTER_PCL && aInstruction->operands[1] == 1;
+		default:
+			return 0;
+	}
+}
+
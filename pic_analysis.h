@@ -0,0 +1,105 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * pic_analysis.h - Header file for the page and bank selection dataflow
+ *  analysis, used to resolve the full addresses of call/goto destinations
+ *  and file register operands.
+ *
+ */
+
+#ifndef PIC_ANALYSIS_H
+#define PIC_ANALYSIS_H
+
+#include <stdint.h>
+#include "pic_disasm.h"
+#include "image.h"
+
+/* Abstract state of the page and bank selection registers. Every value is
+ * paired with a mask of its known bits, so that partial updates such as
+ * "bsf PCLATH, 3" are tracked exactly and merging two paths only forgets
+ * the bits the paths disagree on. The state is kept per basic block only. */
+struct _selectionState {
+	/* PCLATH on Mid-Range and Enhanced, the STATUS<7:5> page bits on Baseline */
+	uint8_t page, pageKnown;
+	/* BSR on Enhanced, the STATUS<6:5> RP bits on Mid-Range, and the
+	 * FSR<6:5> bank bits on Baseline */
+	uint8_t bank, bankKnown;
+	/* The working register, so "movlw k; movwf PCLATH" can be followed */
+	uint8_t w, wKnown;
+	/* Set once any path through the program reaches this state */
+	uint8_t reached;
+};
+typedef struct _selectionState selectionState;
+
+/* Structure for a decoded instruction as needed by the analysis. */
+struct _analyzedInstruction {
+	uint32_t address;
+	uint16_t opcode;
+	int32_t operands[2];
+	/* One of the Analysis_Instruction_Kinds in pic_analysis.c */
+	uint8_t kind;
+};
+typedef struct _analyzedInstruction analyzedInstruction;
+
+/* Structure for a basic block: a run of instructions that is only entered
+ * at its first instruction and only left at its last instruction. */
+struct _basicBlock {
+	/* Index of the first instruction and one past the last instruction */
+	int start, end;
+	/* State on entry to the block, merged over all of its predecessors */
+	selectionState in;
+};
+typedef struct _basicBlock basicBlock;
+
+/* Structure to hold the results of the analysis of a program image. */
+struct _programAnalysis {
+	int archSelect;
+	/* Program memory instructions sorted by address */
+	analyzedInstruction *instructions;
+	int numInstructions;
+	/* Basic block index of each instruction */
+	int *instructionBlocks;
+	basicBlock *blocks;
+	int numBlocks;
+	/* Number of program memory pages spanned by the program image, and
+	 * the page register bits needed to select between them. */
+	int numPages;
+	uint8_t pageBitsNeeded;
+	/* Instruction index and state of the last resolved instruction, so
+	 * a sequential walk through the program replays each instruction once. */
+	int cursorIndex;
+	selectionState cursorState;
+};
+typedef struct _programAnalysis programAnalysis;
+
+/* Builds the control flow graph of the program image and propagates the
+ * page and bank selection states through it until they are stable. */
+int analyzeProgramImage(programAnalysis *analysis, const programImage *image, int archSelect);
+
+/* Replaces the call/goto destination and file register operands of a
+ * disassembled instruction with their full page or bank qualified addresses,
+ * where the analysis could determine them, and marks them in
+ * resolvedOperands. */
+int resolveOperands(programAnalysis *analysis, disassembledInstruction *dInstruction);
+
+/* Frees the memory held by the analysis. */
+void freeProgramAnalysis(programAnalysis *analysis);
+
+#endif
+
@@ -0,0 +1,123 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * pic_device.c - PIC device database lookups, used to name special function
+ *  registers and classify the memory regions of a specific PIC device.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "pic_device.h"
+
+/* SFR symbol tables, as generated into pic_devicetables.c */
+extern const int numRegisterSymbols;
+extern const int numRegisterSymbolBuckets;
+extern const uint16_t registerSymbolSeeds[];
+extern const registerSymbol registerSymbols[];
+extern const char registerSymbolNames[];
+
+/* Hash of a register symbol key, must match hashRegisterKey() in
+ * deviceWork/genDeviceTables.pl. */
+static uint32_t hashRegisterKey(uint32_t key, uint32_t seed) {
+	key ^= seed;
+	key ^= key >> 16;
+	key *= 0x85EBCA6B;
+	key ^= key >> 13;
+	key *= 0xC2B2AE35;
+	key ^= key >> 16;
+	return key;
+}
+
+/* Look up a device by its name, returns the device index, or -1 if the
+ * device is not in the device database. */
+int lookupDevice(const char *name) {
+	int i;
+
+	for (i = 0; i < numDevices; i++) {
+		if (strcasecmp(allDevices[i].name, name) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+/* Look up the name of a special function register of a device, by its
+ * bank qualified address if the bank is known, or by its offset into the
+ * bank otherwise. Returns NULL if there is no such register. */
+const char *lookupRegisterName(int deviceIndex, uint32_t address, int bankKnown) {
+	uint32_t key, slot;
+
+	if (deviceIndex < 0 || deviceIndex >= numDevices || address >= REGISTER_ANY_BANK)
+		return NULL;
+
+	key = ((uint32_t)deviceIndex << 16) | address;
+	if (!bankKnown)
+		key |= REGISTER_ANY_BANK;
+
+	/* The table is indexed by a minimal perfect hash, so every key maps to
+	 * exactly one slot: the first hash picks the bucket seed, the second
+	 * hash with that seed picks the slot. We only need to check that the
+	 * slot actually holds our key. */
+	slot = hashRegisterKey(key, registerSymbolSeeds[hashRegisterKey(key, 0) % numRegisterSymbolBuckets]) % numRegisterSymbols;
+	if (registerSymbols[slot].key != key)
+		return NULL;
+
+	return registerSymbolNames + registerSymbols[slot].nameOffset;
+}
+
+/* Look up the address of a special function register of a device by its
+ * name, the inverse of lookupRegisterName(). The table is only indexed by
+ * address, so this scans it, callers that look up many names should
+ * remember the results. */
+int32_t lookupRegisterAddress(int deviceIndex, const char *name) {
+	int i;
+
+	for (i = 0; i < numRegisterSymbols; i++) {
+		if ((registerSymbols[i].key >> 16) != (uint32_t)deviceIndex)
+			continue;
+		if (strcmp(registerSymbolNames + registerSymbols[i].nameOffset, name) == 0)
+			return registerSymbols[i].key & (REGISTER_ANY_BANK-1);
+	}
+
+	return -1;
+}
+
+/* Classifies a program memory address of a device into one of the
+ * PIC_Memory_Regions. */
+int lookupMemoryRegion(int deviceIndex, uint32_t address) {
+	const deviceInfo *device;
+
+	if (deviceIndex < 0 || deviceIndex >= numDevices)
+		return REGION_PROGRAM;
+	device = &allDevices[deviceIndex];
+
+	if (address < device->programMemorySize)
+		return REGION_PROGRAM;
+	if (address - device->configWords.address < (uint32_t)device->configWords.size)
+		return REGION_CONFIG;
+	if (address - device->idLocations.address < (uint32_t)device->idLocations.size)
+		return REGION_ID_LOCATIONS;
+	if (address - device->eeprom.address < (uint32_t)device->eeprom.size)
+		return REGION_EEPROM;
+
+	return REGION_UNIMPLEMENTED;
+}
+
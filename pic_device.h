@@ -0,0 +1,120 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * pic_device.h - Header file for the PIC device database, used to name
+ *  special function registers and classify the memory regions of a specific
+ *  PIC device.
+ *
+ */
+
+#ifndef PIC_DEVICE_H
+#define PIC_DEVICE_H
+
+#include <stdint.h>
+#include "pic_disasm.h"
+
+/* Flag in the register address of a register symbol key, for registers
+ * that have the same name in every bank of the device, so they can be
+ * named even if the selected bank isn't known. */
+#define REGISTER_ANY_BANK		0x8000
+
+/* Memory regions of a device's program memory address space */
+enum PIC_Memory_Regions {
+	REGION_PROGRAM,
+	REGION_ID_LOCATIONS,
+	REGION_CONFIG,
+	REGION_EEPROM,
+	/* Beyond the program memory, but not in any of the above regions */
+	REGION_UNIMPLEMENTED,
+};
+
+/* Structure for a region of a device's program memory address space */
+struct _memoryRegion {
+	/* Word address and number of words */
+	uint32_t address;
+	int size;
+};
+typedef struct _memoryRegion memoryRegion;
+
+/* Structure for each device in the device database */
+struct _deviceInfo {
+	char name[16];
+	/* Index into allInstructionSets of the device's architecture */
+	int archSelect;
+	/* Number of data memory banks */
+	int numBanks;
+	/* Program memory size in words */
+	uint32_t programMemorySize;
+	memoryRegion idLocations;
+	memoryRegion configWords;
+	/* Data EEPROM, one byte in the low byte of each word */
+	memoryRegion eeprom;
+	/* Range of this device's settings in configSettings */
+	int firstConfigSetting;
+	int numConfigSettings;
+};
+typedef struct _deviceInfo deviceInfo;
+
+/* Structure for each setting of a configuration word field, i.e. the
+ * configuration word at address is set to FOSC=XT if (word & mask) == value. */
+struct _configSetting {
+	uint32_t address;
+	uint16_t mask;
+	uint16_t value;
+	const char *field;
+	const char *setting;
+};
+typedef struct _configSetting configSetting;
+
+/* Structure for each entry of the SFR symbol table */
+struct _registerSymbol {
+	/* Device index in the upper 16 bits, bank qualified register
+	 * address (or REGISTER_ANY_BANK and the offset) in the lower 16 bits. */
+	uint32_t key;
+	/* Offset of the register name in registerSymbolNames */
+	uint16_t nameOffset;
+};
+typedef struct _registerSymbol registerSymbol;
+
+/* Device database and SFR symbol tables, as generated into
+ * pic_devicetables.c by deviceWork/genDeviceTables.pl */
+extern const deviceInfo allDevices[];
+extern const int numDevices;
+extern const configSetting configSettings[];
+
+/* Look up a device by its name, returns the device index, or -1 if the
+ * device is not in the device database. */
+int lookupDevice(const char *name);
+
+/* Look up the name of a special function register of a device, by its
+ * bank qualified address if the bank is known, or by its offset into the
+ * bank otherwise. Returns NULL if there is no such register. */
+const char *lookupRegisterName(int deviceIndex, uint32_t address, int bankKnown);
+
+/* Look up the address of a special function register of a device by its
+ * name, the inverse of lookupRegisterName(). Returns the bank qualified
+ * address, or -1 if the device has no such register. */
+int32_t lookupRegisterAddress(int deviceIndex, const char *name);
+
+/* Classifies a program memory address of a device into one of the
+ * PIC_Memory_Regions. */
+int lookupMemoryRegion(int deviceIndex, uint32_t address);
+
+#endif
+
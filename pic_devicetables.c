@@ -0,0 +1,885 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * pic_devicetables.c - PIC device database and SFR symbol tables.
+ *
+ * Generated by deviceWork/genDeviceTables.pl from deviceWork/PICDevices,
+ * do not edit by hand.
+ *
+ */
+
+#include "pic_device.h"
+
+const int numDevices = 7;
+
+const deviceInfo allDevices[] = {
+	{"pic10f200", PIC_BASELINE, 1, 0x100, {0x100, 4}, {0xFFF, 1}, {0x0, 0}, 0, 6},
+	{"pic12f508", PIC_BASELINE, 1, 0x200, {0x200, 4}, {0xFFF, 1}, {0x0, 0}, 6, 10},
+	{"pic16f54", PIC_BASELINE, 1, 0x200, {0x200, 4}, {0xFFF, 1}, {0x0, 0}, 16, 8},
+	{"pic16f84a", PIC_MIDRANGE, 2, 0x400, {0x2000, 4}, {0x2007, 1}, {0x2100, 64}, 24, 10},
+	{"pic16f628a", PIC_MIDRANGE, 4, 0x800, {0x2000, 4}, {0x2007, 1}, {0x2100, 128}, 34, 22},
+	{"pic16f877a", PIC_MIDRANGE, 4, 0x2000, {0x2000, 4}, {0x2007, 1}, {0x2100, 256}, 56, 22},
+	{"pic16f1827", PIC_MIDRANGE_ENHANCED, 32, 0x1000, {0x8000, 4}, {0x8007, 2}, {0xF000, 256}, 78, 42},
+};
+
+const configSetting configSettings[] = {
+	{0x0FFF, 0x0004, 0x0000, "WDTE", "OFF"},
+	{0x0FFF, 0x0004, 0x0004, "WDTE", "ON"},
+	{0x0FFF, 0x0008, 0x0000, "CP", "ON"},
+	{0x0FFF, 0x0008, 0x0008, "CP", "OFF"},
+	{0x0FFF, 0x0010, 0x0000, "MCLRE", "OFF"},
+	{0x0FFF, 0x0010, 0x0010, "MCLRE", "ON"},
+	{0x0FFF, 0x0003, 0x0000, "FOSC", "LP"},
+	{0x0FFF, 0x0003, 0x0001, "FOSC", "XT"},
+	{0x0FFF, 0x0003, 0x0002, "FOSC", "INTRC"},
+	{0x0FFF, 0x0003, 0x0003, "FOSC", "EXTRC"},
+	{0x0FFF, 0x0004, 0x0000, "WDTE", "OFF"},
+	{0x0FFF, 0x0004, 0x0004, "WDTE", "ON"},
+	{0x0FFF, 0x0008, 0x0000, "CP", "ON"},
+	{0x0FFF, 0x0008, 0x0008, "CP", "OFF"},
+	{0x0FFF, 0x0010, 0x0000, "MCLRE", "OFF"},
+	{0x0FFF, 0x0010, 0x0010, "MCLRE", "ON"},
+	{0x0FFF, 0x0003, 0x0000, "FOSC", "LP"},
+	{0x0FFF, 0x0003, 0x0001, "FOSC", "XT"},
+	{0x0FFF, 0x0003, 0x0002, "FOSC", "HS"},
+	{0x0FFF, 0x0003, 0x0003, "FOSC", "RC"},
+	{0x0FFF, 0x0004, 0x0000, "WDTE", "OFF"},
+	{0x0FFF, 0x0004, 0x0004, "WDTE", "ON"},
+	{0x0FFF, 0x0008, 0x0000, "CP", "ON"},
+	{0x0FFF, 0x0008, 0x0008, "CP", "OFF"},
+	{0x2007, 0x0003, 0x0000, "FOSC", "LP"},
+	{0x2007, 0x0003, 0x0001, "FOSC", "XT"},
+	{0x2007, 0x0003, 0x0002, "FOSC", "HS"},
+	{0x2007, 0x0003, 0x0003, "FOSC", "RC"},
+	{0x2007, 0x0004, 0x0000, "WDTE", "OFF"},
+	{0x2007, 0x0004, 0x0004, "WDTE", "ON"},
+	{0x2007, 0x0008, 0x0000, "PWRTE", "ON"},
+	{0x2007, 0x0008, 0x0008, "PWRTE", "OFF"},
+	{0x2007, 0x3FF0, 0x0000, "CP", "ON"},
+	{0x2007, 0x3FF0, 0x3FF0, "CP", "OFF"},
+	{0x2007, 0x0013, 0x0000, "FOSC", "LP"},
+	{0x2007, 0x0013, 0x0001, "FOSC", "XT"},
+	{0x2007, 0x0013, 0x0002, "FOSC", "HS"},
+	{0x2007, 0x0013, 0x0003, "FOSC", "EC"},
+	{0x2007, 0x0013, 0x0010, "FOSC", "INTOSCIO"},
+	{0x2007, 0x0013, 0x0011, "FOSC", "INTOSCCLK"},
+	{0x2007, 0x0013, 0x0012, "FOSC", "EXTRCIO"},
+	{0x2007, 0x0013, 0x0013, "FOSC", "EXTRCCLK"},
+	{0x2007, 0x0004, 0x0000, "WDTE", "OFF"},
+	{0x2007, 0x0004, 0x0004, "WDTE", "ON"},
+	{0x2007, 0x0008, 0x0000, "PWRTE", "ON"},
+	{0x2007, 0x0008, 0x0008, "PWRTE", "OFF"},
+	{0x2007, 0x0020, 0x0000, "MCLRE", "OFF"},
+	{0x2007, 0x0020, 0x0020, "MCLRE", "ON"},
+	{0x2007, 0x0040, 0x0000, "BOREN", "OFF"},
+	{0x2007, 0x0040, 0x0040, "BOREN", "ON"},
+	{0x2007, 0x0080, 0x0000, "LVP", "OFF"},
+	{0x2007, 0x0080, 0x0080, "LVP", "ON"},
+	{0x2007, 0x0100, 0x0000, "CPD", "ON"},
+	{0x2007, 0x0100, 0x0100, "CPD", "OFF"},
+	{0x2007, 0x2000, 0x0000, "CP", "ON"},
+	{0x2007, 0x2000, 0x2000, "CP", "OFF"},
+	{0x2007, 0x0003, 0x0000, "FOSC", "LP"},
+	{0x2007, 0x0003, 0x0001, "FOSC", "XT"},
+	{0x2007, 0x0003, 0x0002, "FOSC", "HS"},
+	{0x2007, 0x0003, 0x0003, "FOSC", "RC"},
+	{0x2007, 0x0004, 0x0000, "WDTE", "OFF"},
+	{0x2007, 0x0004, 0x0004, "WDTE", "ON"},
+	{0x2007, 0x0008, 0x0000, "PWRTE", "ON"},
+	{0x2007, 0x0008, 0x0008, "PWRTE", "OFF"},
+	{0x2007, 0x0040, 0x0000, "BOREN", "OFF"},
+	{0x2007, 0x0040, 0x0040, "BOREN", "ON"},
+	{0x2007, 0x0080, 0x0000, "LVP", "OFF"},
+	{0x2007, 0x0080, 0x0080, "LVP", "ON"},
+	{0x2007, 0x0100, 0x0000, "CPD", "ON"},
+	{0x2007, 0x0100, 0x0100, "CPD", "OFF"},
+	{0x2007, 0x0600, 0x0000, "WRT", "HALF"},
+	{0x2007, 0x0600, 0x0200, "WRT", "1FOURTH"},
+	{0x2007, 0x0600, 0x0400, "WRT", "256"},
+	{0x2007, 0x0600, 0x0600, "WRT", "OFF"},
+	{0x2007, 0x0800, 0x0000, "DEBUG", "ON"},
+	{0x2007, 0x0800, 0x0800, "DEBUG", "OFF"},
+	{0x2007, 0x2000, 0x0000, "CP", "ON"},
+	{0x2007, 0x2000, 0x2000, "CP", "OFF"},
+	{0x8007, 0x0007, 0x0000, "FOSC", "LP"},
+	{0x8007, 0x0007, 0x0001, "FOSC", "XT"},
+	{0x8007, 0x0007, 0x0002, "FOSC", "HS"},
+	{0x8007, 0x0007, 0x0003, "FOSC", "EXTRC"},
+	{0x8007, 0x0007, 0x0004, "FOSC", "INTOSC"},
+	{0x8007, 0x0007, 0x0005, "FOSC", "ECL"},
+	{0x8007, 0x0007, 0x0006, "FOSC", "ECM"},
+	{0x8007, 0x0007, 0x0007, "FOSC", "ECH"},
+	{0x8007, 0x0018, 0x0000, "WDTE", "OFF"},
+	{0x8007, 0x0018, 0x0008, "WDTE", "SWDTEN"},
+	{0x8007, 0x0018, 0x0010, "WDTE", "NSLEEP"},
+	{0x8007, 0x0018, 0x0018, "WDTE", "ON"},
+	{0x8007, 0x0020, 0x0000, "PWRTE", "ON"},
+	{0x8007, 0x0020, 0x0020, "PWRTE", "OFF"},
+	{0x8007, 0x0040, 0x0000, "MCLRE", "OFF"},
+	{0x8007, 0x0040, 0x0040, "MCLRE", "ON"},
+	{0x8007, 0x0080, 0x0000, "CP", "ON"},
+	{0x8007, 0x0080, 0x0080, "CP", "OFF"},
+	{0x8007, 0x0100, 0x0000, "CPD", "ON"},
+	{0x8007, 0x0100, 0x0100, "CPD", "OFF"},
+	{0x8007, 0x0600, 0x0000, "BOREN", "OFF"},
+	{0x8007, 0x0600, 0x0200, "BOREN", "SBODEN"},
+	{0x8007, 0x0600, 0x0400, "BOREN", "NSLEEP"},
+	{0x8007, 0x0600, 0x0600, "BOREN", "ON"},
+	{0x8007, 0x0800, 0x0000, "CLKOUTEN", "ON"},
+	{0x8007, 0x0800, 0x0800, "CLKOUTEN", "OFF"},
+	{0x8007, 0x1000, 0x0000, "IESO", "OFF"},
+	{0x8007, 0x1000, 0x1000, "IESO", "ON"},
+	{0x8007, 0x2000, 0x0000, "FCMEN", "OFF"},
+	{0x8007, 0x2000, 0x2000, "FCMEN", "ON"},
+	{0x8008, 0x0003, 0x0000, "WRT", "ALL"},
+	{0x8008, 0x0003, 0x0001, "WRT", "HALF"},
+	{0x8008, 0x0003, 0x0002, "WRT", "BOOT"},
+	{0x8008, 0x0003, 0x0003, "WRT", "OFF"},
+	{0x8008, 0x0100, 0x0000, "PLLEN", "OFF"},
+	{0x8008, 0x0100, 0x0100, "PLLEN", "ON"},
+	{0x8008, 0x0200, 0x0000, "STVREN", "OFF"},
+	{0x8008, 0x0200, 0x0200, "STVREN", "ON"},
+	{0x8008, 0x0400, 0x0000, "BORV", "HI"},
+	{0x8008, 0x0400, 0x0400, "BORV", "LO"},
+	{0x8008, 0x2000, 0x0000, "LVP", "OFF"},
+	{0x8008, 0x2000, 0x2000, "LVP", "ON"},
+};
+
+const int numRegisterSymbols = 682;
+const int numRegisterSymbolBuckets = 171;
+
+const uint16_t registerSymbolSeeds[] = {
+	10, 173, 1, 73, 86, 51, 33, 18, 44, 63, 10, 25,
+	355, 1, 32, 44, 33, 10, 162, 142, 1, 1, 56, 22,
+	665, 4, 207, 213, 413, 1, 9, 532, 22, 61, 13, 108,
+	78, 59, 2, 58, 53, 15, 90, 1, 4, 221, 786, 52,
+	55, 39, 180, 1, 38, 122, 36, 219, 110, 21, 12, 65,
+	181, 199, 296, 84, 404, 165, 155, 122, 74, 25, 0, 34,
+	1127, 96, 0, 470, 27, 53, 20, 13, 13, 44, 19, 70,
+	28, 31, 67, 550, 250, 1, 98, 31, 41, 438, 993, 2288,
+	506, 124, 705, 32, 549, 221, 252, 1114, 281, 59, 84, 160,
+	1, 1, 275, 2344, 1202, 612, 31, 574, 524, 170, 2810, 9,
+	6, 0, 80, 305, 16, 91, 1509, 66, 32, 2, 0, 51,
+	2819, 7, 50, 101, 75, 45, 217, 51, 6173, 78, 354, 616,
+	4822, 128, 192, 61, 32, 594, 470, 198, 1254, 51, 38, 582,
+	623, 821, 5017, 4, 155, 27, 995, 1524, 1, 628, 218, 449,
+	1048, 39, 697,
+};
+
+const registerSymbol registerSymbols[] = {
+	{0x060980, 379},	/* INDF0 */
+	{0x04800B, 69},	/* INTCON */
+	{0x060683, 14},	/* STATUS */
+	{0x060C0B, 69},	/* INTCON */
+	{0x060F89, 419},	/* WREG */
+	{0x060F0A, 62},	/* PCLATH */
+	{0x03800B, 69},	/* INTCON */
+	{0x05010C, 49},	/* EEDATA */
+	{0x030009, 56},	/* EEADR */
+	{0x060C87, 409},	/* FSR1H */
+	{0x060A82, 10},	/* PCL */
+	{0x060405, 397},	/* FSR0H */
+	{0x060487, 409},	/* FSR1H */
+	{0x060800, 379},	/* INDF0 */
+	{0x060C09, 419},	/* WREG */
+	{0x060016, 118},	/* TMR1L */
+	{0x060186, 403},	/* FSR1L */
+	{0x060018, 130},	/* T1CON */
+	{0x060480, 379},	/* INDF0 */
+	{0x060D88, 415},	/* BSR */
+	{0x050103, 14},	/* STATUS */
+	{0x060D86, 403},	/* FSR1L */
+	{0x050008, 231},	/* PORTD */
+	{0x04010A, 62},	/* PCLATH */
+	{0x04018B, 69},	/* INTCON */
+	{0x060788, 415},	/* BSR */
+	{0x05018B, 69},	/* INTCON */
+	{0x06008A, 62},	/* PCLATH */
+	{0x008001, 5},	/* TMR0 */
+	{0x060D06, 403},	/* FSR1L */
+	{0x060E89, 419},	/* WREG */
+	{0x05010E, 365},	/* EEDATH */
+	{0x050013, 248},	/* SSPBUF */
+	{0x06080B, 69},	/* INTCON */
+	{0x060E82, 10},	/* PCL */
+	{0x060C02, 10},	/* PCL */
+	{0x060F03, 14},	/* STATUS */
+	{0x060283, 14},	/* STATUS */
+	{0x060213, 660},	/* SSP1MSK */
+	{0x060093, 441},	/* PIE3 */
+	{0x050001, 5},	/* TMR0 */
+	{0x050100, 0},	/* INDF */
+	{0x06020B, 69},	/* INTCON */
+	{0x060203, 14},	/* STATUS */
+	{0x05800A, 62},	/* PCLATH */
+	{0x018006, 32},	/* GPIO */
+	{0x040099, 213},	/* SPBRG */
+	{0x060F01, 385},	/* INDF1 */
+	{0x060481, 385},	/* INDF1 */
+	{0x06038A, 62},	/* PCLATH */
+	{0x06018B, 69},	/* INTCON */
+	{0x060903, 14},	/* STATUS */
+	{0x04010B, 69},	/* INTCON */
+	{0x020002, 10},	/* PCL */
+	{0x058004, 21},	/* FSR */
+	{0x06001C, 141},	/* T2CON */
+	{0x060B04, 391},	/* FSR0L */
+	{0x04018A, 62},	/* PCLATH */
+	{0x050000, 0},	/* INDF */
+	{0x040012, 141},	/* T2CON */
+	{0x068009, 419},	/* WREG */
+	{0x060E09, 419},	/* WREG */
+	{0x060F84, 391},	/* FSR0L */
+	{0x060A84, 391},	/* FSR0L */
+	{0x060B86, 403},	/* FSR1L */
+	{0x060097, 451},	/* WDTCON */
+	{0x060000, 379},	/* INDF0 */
+	{0x060904, 391},	/* FSR0L */
+	{0x060780, 379},	/* INDF0 */
+	{0x020006, 43},	/* PORTB */
+	{0x060180, 379},	/* INDF0 */
+	{0x06058B, 69},	/* INTCON */
+	{0x05008A, 62},	/* PCLATH */
+	{0x060206, 403},	/* FSR1L */
+	{0x060908, 415},	/* BSR */
+	{0x060880, 379},	/* INDF0 */
+	{0x060C0A, 62},	/* PCLATH */
+	{0x06050B, 69},	/* INTCON */
+	{0x060008, 415},	/* BSR */
+	{0x060388, 415},	/* BSR */
+	{0x060506, 403},	/* FSR1L */
+	{0x068006, 403},	/* FSR1L */
+	{0x060A89, 419},	/* WREG */
+	{0x010005, 25},	/* OSCCAL */
+	{0x060106, 403},	/* FSR1L */
+	{0x060182, 10},	/* PCL */
+	{0x04000A, 62},	/* PCLATH */
+	{0x060D82, 10},	/* PCL */
+	{0x06009D, 291},	/* ADCON0 */
+	{0x060091, 193},	/* PIE1 */
+	{0x050098, 207},	/* TXSTA */
+	{0x060C84, 391},	/* FSR0L */
+	{0x060B8A, 62},	/* PCLATH */
+	{0x060705, 397},	/* FSR0H */
+	{0x040011, 136},	/* TMR2 */
+	{0x05000A, 62},	/* PCLATH */
+	{0x050086, 93},	/* TRISB */
+	{0x068005, 397},	/* FSR0H */
+	{0x060200, 379},	/* INDF0 */
+	{0x060B09, 419},	/* WREG */
+	{0x060984, 391},	/* FSR0L */
+	{0x060301, 385},	/* INDF1 */
+	{0x060A81, 385},	/* INDF1 */
+	{0x060807, 409},	/* FSR1H */
+	{0x060101, 385},	/* INDF1 */
+	{0x060003, 14},	/* STATUS */
+	{0x060384, 391},	/* FSR0L */
+	{0x040104, 21},	/* FSR */
+	{0x06019D, 169},	/* RCSTA */
+	{0x05008C, 193},	/* PIE1 */
+	{0x060094, 446},	/* PIE4 */
+	{0x060588, 415},	/* BSR */
+	{0x060F81, 385},	/* INDF1 */
+	{0x040017, 161},	/* CCP1CON */
+	{0x030082, 10},	/* PCL */
+	{0x040000, 0},	/* INDF */
+	{0x030088, 99},	/* EECON1 */
+	{0x060D07, 409},	/* FSR1H */
+	{0x060289, 419},	/* WREG */
+	{0x008004, 21},	/* FSR */
+	{0x060A03, 14},	/* STATUS */
+	{0x060285, 397},	/* FSR0H */
+	{0x04008B, 69},	/* INTCON */
+	{0x05009F, 358},	/* ADCON1 */
+	{0x060902, 10},	/* PCL */
+	{0x008002, 10},	/* PCL */
+	{0x060D09, 419},	/* WREG */
+	{0x040180, 0},	/* INDF */
+	{0x060116, 529},	/* BORCON */
+	{0x06008D, 93},	/* TRISB */
+	{0x040004, 21},	/* FSR */
+	{0x060286, 403},	/* FSR1L */
+	{0x060708, 415},	/* BSR */
+	{0x040085, 87},	/* TRISA */
+	{0x060216, 686},	/* SSP1CON2 */
+	{0x028001, 5},	/* TMR0 */
+	{0x060680, 379},	/* INDF0 */
+	{0x06098A, 62},	/* PCLATH */
+	{0x060F85, 397},	/* FSR0H */
+	{0x060F09, 419},	/* WREG */
+	{0x060C85, 397},	/* FSR0H */
+	{0x060608, 415},	/* BSR */
+	{0x05010B, 69},	/* INTCON */
+	{0x060901, 385},	/* INDF1 */
+	{0x05001A, 181},	/* RCREG */
+	{0x060114, 515},	/* CM2CON1 */
+	{0x060012, 243},	/* PIR2 */
+	{0x040101, 5},	/* TMR0 */
+	{0x06009A, 473},	/* OSCSTAT */
+	{0x050181, 76},	/* OPTION_REG */
+	{0x060408, 415},	/* BSR */
+	{0x060802, 10},	/* PCL */
+	{0x008000, 0},	/* INDF */
+	{0x060100, 379},	/* INDF0 */
+	{0x04800A, 62},	/* PCLATH */
+	{0x04000C, 113},	/* PIR1 */
+	{0x060603, 14},	/* STATUS */
+	{0x060385, 397},	/* FSR0H */
+	{0x040019, 175},	/* TXREG */
+	{0x060096, 198},	/* PCON */
+	{0x05001D, 276},	/* CCP2CON */
+	{0x050186, 93},	/* TRISB */
+	{0x060704, 391},	/* FSR0L */
+	{0x060382, 10},	/* PCL */
+	{0x060A01, 385},	/* INDF1 */
+	{0x060A09, 419},	/* WREG */
+	{0x05001C, 269},	/* CCPR2H */
+	{0x06019C, 624},	/* SPBRGH */
+	{0x060A85, 397},	/* FSR0H */
+	{0x040081, 76},	/* OPTION_REG */
+	{0x060C8B, 69},	/* INTCON */
+	{0x060288, 415},	/* BSR */
+	{0x060E88, 415},	/* BSR */
+	{0x060383, 14},	/* STATUS */
+	{0x060083, 14},	/* STATUS */
+	{0x030083, 14},	/* STATUS */
+	{0x050017, 161},	/* CCP1CON */
+	{0x060A06, 403},	/* FSR1L */
+	{0x06009B, 351},	/* ADRESL */
+	{0x060306, 403},	/* FSR1L */
+	{0x060A0A, 62},	/* PCLATH */
+	{0x060E81, 385},	/* INDF1 */
+	{0x060117, 536},	/* FVRCON */
+	{0x040010, 130},	/* T1CON */
+	{0x06098B, 69},	/* INTCON */
+	{0x050018, 169},	/* RCSTA */
+	{0x060305, 397},	/* FSR0H */
+	{0x018003, 14},	/* STATUS */
+	{0x030006, 43},	/* PORTB */
+	{0x040183, 14},	/* STATUS */
+	{0x06068B, 69},	/* INTCON */
+	{0x060785, 397},	/* FSR0H */
+	{0x06019B, 617},	/* SPBRGL */
+	{0x060087, 409},	/* FSR1H */
+	{0x060E02, 10},	/* PCL */
+	{0x060702, 10},	/* PCL */
+	{0x060B83, 14},	/* STATUS */
+	{0x060207, 409},	/* FSR1H */
+	{0x060B84, 391},	/* FSR0L */
+	{0x060407, 409},	/* FSR1H */
+	{0x060E86, 403},	/* FSR1L */
+	{0x06088B, 69},	/* INTCON */
+	{0x060184, 391},	/* FSR0L */
+	{0x058003, 14},	/* STATUS */
+	{0x06018D, 596},	/* ANSELB */
+	{0x060386, 403},	/* FSR1L */
+	{0x060C86, 403},	/* FSR1L */
+	{0x040003, 14},	/* STATUS */
+	{0x060B81, 385},	/* INDF1 */
+	{0x060A86, 403},	/* FSR1L */
+	{0x060E05, 397},	/* FSR0H */
+	{0x03000B, 69},	/* INTCON */
+	{0x060602, 10},	/* PCL */
+	{0x060A88, 415},	/* BSR */
+	{0x060F06, 403},	/* FSR1L */
+	{0x040184, 21},	/* FSR */
+	{0x06011D, 573},	/* APFCON0 */
+	{0x06000D, 43},	/* PORTB */
+	{0x060982, 10},	/* PCL */
+	{0x060D84, 391},	/* FSR0L */
+	{0x06018A, 62},	/* PCLATH */
+	{0x018004, 21},	/* FSR */
+	{0x060081, 385},	/* INDF1 */
+	{0x060688, 415},	/* BSR */
+	{0x060B08, 415},	/* BSR */
+	{0x028005, 37},	/* PORTA */
+	{0x060118, 543},	/* DACCON0 */
+	{0x05009E, 351},	/* ADRESL */
+	{0x040082, 10},	/* PCL */
+	{0x060D80, 379},	/* INDF0 */
+	{0x06068A, 62},	/* PCLATH */
+	{0x060808, 415},	/* BSR */
+	{0x06020D, 639},	/* WPUB */
+	{0x060A02, 10},	/* PCL */
+	{0x060C04, 391},	/* FSR0L */
+	{0x050101, 5},	/* TMR0 */
+	{0x058002, 10},	/* PCL */
+	{0x050088, 304},	/* TRISD */
+	{0x040103, 14},	/* STATUS */
+	{0x06030B, 69},	/* INTCON */
+	{0x04009D, 106},	/* EECON2 */
+	{0x060B02, 10},	/* PCL */
+	{0x060484, 391},	/* FSR0L */
+	{0x030002, 10},	/* PCL */
+	{0x060004, 391},	/* FSR0L */
+	{0x040002, 10},	/* PCL */
+	{0x060B0A, 62},	/* PCLATH */
+	{0x030080, 0},	/* INDF */
+	{0x060706, 403},	/* FSR1L */
+	{0x060194, 365},	/* EEDATH */
+	{0x06000A, 62},	/* PCLATH */
+	{0x028003, 14},	/* STATUS */
+	{0x040006, 43},	/* PORTB */
+	{0x050003, 14},	/* STATUS */
+	{0x060601, 385},	/* INDF1 */
+	{0x060181, 385},	/* INDF1 */
+	{0x060B01, 385},	/* INDF1 */
+	{0x060582, 10},	/* PCL */
+	{0x030000, 0},	/* INDF */
+	{0x000002, 10},	/* PCL */
+	{0x068007, 409},	/* FSR1H */
+	{0x050180, 0},	/* INDF */
+	{0x060C06, 403},	/* FSR1L */
+	{0x06010B, 69},	/* INTCON */
+	{0x06090A, 62},	/* PCLATH */
+	{0x050093, 329},	/* SSPADD */
+	{0x060111, 491},	/* CM1CON0 */
+	{0x06011A, 559},	/* SRCON0 */
+	{0x06048A, 62},	/* PCLATH */
+	{0x058000, 0},	/* INDF */
+	{0x000006, 32},	/* GPIO */
+	{0x008006, 32},	/* GPIO */
+	{0x060082, 10},	/* PCL */
+	{0x040080, 0},	/* INDF */
+	{0x03008B, 69},	/* INTCON */
+	{0x06078A, 62},	/* PCLATH */
+	{0x060482, 10},	/* PCL */
+	{0x060B03, 14},	/* STATUS */
+	{0x038003, 14},	/* STATUS */
+	{0x050015, 147},	/* CCPR1L */
+	{0x060886, 403},	/* FSR1L */
+	{0x060906, 403},	/* FSR1L */
+	{0x06009E, 358},	/* ADCON1 */
+	{0x060581, 385},	/* INDF1 */
+	{0x060C89, 419},	/* WREG */
+	{0x060989, 419},	/* WREG */
+	{0x030085, 87},	/* TRISA */
+	{0x028000, 0},	/* INDF */
+	{0x05001B, 262},	/* CCPR2L */
+	{0x010003, 14},	/* STATUS */
+	{0x040186, 93},	/* TRISB */
+	{0x060302, 10},	/* PCL */
+	{0x060A83, 14},	/* STATUS */
+	{0x060409, 419},	/* WREG */
+	{0x05001E, 284},	/* ADRESH */
+	{0x060D89, 419},	/* WREG */
+	{0x048002, 10},	/* PCL */
+	{0x048004, 21},	/* FSR */
+	{0x060784, 391},	/* FSR0L */
+	{0x060A00, 379},	/* INDF0 */
+	{0x060605, 397},	/* FSR0H */
+	{0x060284, 391},	/* FSR0L */
+	{0x038000, 0},	/* INDF */
+	{0x060B05, 397},	/* FSR0H */
+	{0x060F82, 10},	/* PCL */
+	{0x060A8A, 62},	/* PCLATH */
+	{0x028006, 43},	/* PORTB */
+	{0x060888, 415},	/* BSR */
+	{0x060085, 397},	/* FSR0H */
+	{0x06088A, 62},	/* PCLATH */
+	{0x060105, 397},	/* FSR0H */
+	{0x000003, 14},	/* STATUS */
+	{0x060191, 603},	/* EEADRL */
+	{0x060281, 385},	/* INDF1 */
+	{0x060781, 385},	/* INDF1 */
+	{0x000004, 21},	/* FSR */
+	{0x060E07, 409},	/* FSR1H */
+	{0x060183, 14},	/* STATUS */
+	{0x060E08, 415},	/* BSR */
+	{0x06070B, 69},	/* INTCON */
+	{0x060504, 391},	/* FSR0L */
+	{0x060401, 385},	/* INDF1 */
+	{0x060E80, 379},	/* INDF0 */
+	{0x060202, 10},	/* PCL */
+	{0x050014, 255},	/* SSPCON */
+	{0x018005, 25},	/* OSCCAL */
+	{0x04009A, 49},	/* EEDATA */
+	{0x060D87, 409},	/* FSR1H */
+	{0x06070A, 62},	/* PCLATH */
+	{0x050012, 141},	/* T2CON */
+	{0x060217, 695},	/* SSP1CON3 */
+	{0x050016, 154},	/* CCPR1H */
+	{0x06028B, 69},	/* INTCON */
+	{0x060B8B, 69},	/* INTCON */
+	{0x06011B, 566},	/* SRCON1 */
+	{0x060905, 397},	/* FSR0H */
+	{0x060B07, 409},	/* FSR1H */
+	{0x000005, 25},	/* OSCCAL */
+	{0x060D81, 385},	/* INDF1 */
+	{0x018002, 10},	/* PCL */
+	{0x060196, 106},	/* EECON2 */
+	{0x060B85, 397},	/* FSR0H */
+	{0x060187, 409},	/* FSR1H */
+	{0x060D08, 415},	/* BSR */
+	{0x050007, 225},	/* PORTC */
+	{0x060700, 379},	/* INDF0 */
+	{0x060088, 415},	/* BSR */
+	{0x060102, 10},	/* PCL */
+	{0x060204, 391},	/* FSR0L */
+	{0x060685, 397},	/* FSR0H */
+	{0x05000C, 113},	/* PIR1 */
+	{0x060586, 403},	/* FSR1L */
+	{0x060B00, 379},	/* INDF0 */
+	{0x060604, 391},	/* FSR0L */
+	{0x060402, 10},	/* PCL */
+	{0x06020A, 62},	/* PCLATH */
+	{0x060001, 385},	/* INDF1 */
+	{0x060783, 14},	/* STATUS */
+	{0x050083, 14},	/* STATUS */
+	{0x060B87, 409},	/* FSR1H */
+	{0x060F87, 409},	/* FSR1H */
+	{0x05018C, 99},	/* EECON1 */
+	{0x060500, 379},	/* INDF0 */
+	{0x060508, 415},	/* BSR */
+	{0x060988, 415},	/* BSR */
+	{0x06800A, 62},	/* PCLATH */
+	{0x060086, 403},	/* FSR1L */
+	{0x030008, 49},	/* EEDATA */
+	{0x060987, 409},	/* FSR1H */
+	{0x06800B, 69},	/* INTCON */
+	{0x060E01, 385},	/* INDF1 */
+	{0x060015, 5},	/* TMR0 */
+	{0x060E8B, 69},	/* INTCON */
+	{0x048003, 14},	/* STATUS */
+	{0x068000, 379},	/* INDF0 */
+	{0x060986, 403},	/* FSR1L */
+	{0x068003, 14},	/* STATUS */
+	{0x060404, 391},	/* FSR0L */
+	{0x060509, 419},	/* WREG */
+	{0x060782, 10},	/* PCL */
+	{0x030005, 37},	/* PORTA */
+	{0x040106, 43},	/* PORTB */
+	{0x060786, 403},	/* FSR1L */
+	{0x060E83, 14},	/* STATUS */
+	{0x068001, 385},	/* INDF1 */
+	{0x05000E, 118},	/* TMR1L */
+	{0x060381, 385},	/* INDF1 */
+	{0x060300, 379},	/* INDF0 */
+	{0x06008C, 87},	/* TRISA */
+	{0x060701, 385},	/* INDF1 */
+	{0x05010D, 56},	/* EEADR */
+	{0x03000A, 62},	/* PCLATH */
+	{0x060013, 424},	/* PIR3 */
+	{0x060A08, 415},	/* BSR */
+	{0x050085, 87},	/* TRISA */
+	{0x008003, 14},	/* STATUS */
+	{0x060192, 372},	/* EEADRH */
+	{0x060007, 409},	/* FSR1H */
+	{0x040018, 169},	/* RCSTA */
+	{0x060E00, 379},	/* INDF0 */
+	{0x060806, 403},	/* FSR1L */
+	{0x060B0B, 69},	/* INTCON */
+	{0x060282, 10},	/* PCL */
+	{0x060488, 415},	/* BSR */
+	{0x050019, 175},	/* TXREG */
+	{0x06018C, 589},	/* ANSELA */
+	{0x060195, 99},	/* EECON1 */
+	{0x060B88, 415},	/* BSR */
+	{0x060215, 677},	/* SSP1CON1 */
+	{0x060B80, 379},	/* INDF0 */
+	{0x060587, 409},	/* FSR1H */
+	{0x060188, 415},	/* BSR */
+	{0x060389, 419},	/* WREG */
+	{0x06010C, 481},	/* LATA */
+	{0x060280, 379},	/* INDF0 */
+	{0x06010A, 62},	/* PCLATH */
+	{0x060F05, 397},	/* FSR0H */
+	{0x050082, 10},	/* PCL */
+	{0x060907, 409},	/* FSR1H */
+	{0x060686, 403},	/* FSR1L */
+	{0x060600, 379},	/* INDF0 */
+	{0x060F07, 409},	/* FSR1H */
+	{0x06050A, 62},	/* PCLATH */
+	{0x060006, 403},	/* FSR1L */
+	{0x060F83, 14},	/* STATUS */
+	{0x030004, 21},	/* FSR */
+	{0x060D01, 385},	/* INDF1 */
+	{0x060095, 76},	/* OPTION_REG */
+	{0x030081, 76},	/* OPTION_REG */
+	{0x060A04, 391},	/* FSR0L */
+	{0x04000E, 118},	/* TMR1L */
+	{0x060884, 391},	/* FSR0L */
+	{0x060809, 419},	/* WREG */
+	{0x060F08, 415},	/* BSR */
+	{0x060108, 415},	/* BSR */
+	{0x06060B, 69},	/* INTCON */
+	{0x060885, 397},	/* FSR0H */
+	{0x060709, 419},	/* WREG */
+	{0x060909, 419},	/* WREG */
+	{0x060682, 10},	/* PCL */
+	{0x060403, 14},	/* STATUS */
+	{0x06011E, 581},	/* APFCON1 */
+	{0x040181, 76},	/* OPTION_REG */
+	{0x060985, 397},	/* FSR0H */
+	{0x000000, 0},	/* INDF */
+	{0x060883, 14},	/* STATUS */
+	{0x060E06, 403},	/* FSR1L */
+	{0x060287, 409},	/* FSR1H */
+	{0x060C03, 14},	/* STATUS */
+	{0x060A87, 409},	/* FSR1H */
+	{0x040098, 207},	/* TXSTA */
+	{0x060380, 379},	/* INDF0 */
+	{0x060882, 10},	/* PCL */
+	{0x060B82, 10},	/* PCL */
+	{0x050006, 43},	/* PORTB */
+	{0x060F02, 10},	/* PCL */
+	{0x060E87, 409},	/* FSR1H */
+	{0x050091, 321},	/* SSPCON2 */
+	{0x060F04, 391},	/* FSR0L */
+	{0x060609, 419},	/* WREG */
+	{0x04008C, 193},	/* PIE1 */
+	{0x030003, 14},	/* STATUS */
+	{0x060C08, 415},	/* BSR */
+	{0x010001, 5},	/* TMR0 */
+	{0x060400, 379},	/* INDF0 */
+	{0x060483, 14},	/* STATUS */
+	{0x060C00, 379},	/* INDF0 */
+	{0x06048B, 69},	/* INTCON */
+	{0x05000B, 69},	/* INTCON */
+	{0x060805, 397},	/* FSR0H */
+	{0x020000, 0},	/* INDF */
+	{0x04000F, 124},	/* TMR1H */
+	{0x060E0A, 62},	/* PCLATH */
+	{0x05010A, 62},	/* PCLATH */
+	{0x060193, 610},	/* EEDATL */
+	{0x060C80, 379},	/* INDF0 */
+	{0x060681, 385},	/* INDF1 */
+	{0x04009F, 219},	/* VRCON */
+	{0x060080, 379},	/* INDF0 */
+	{0x050184, 21},	/* FSR */
+	{0x060589, 419},	/* WREG */
+	{0x060881, 385},	/* INDF1 */
+	{0x060584, 391},	/* FSR0L */
+	{0x05001F, 291},	/* ADCON0 */
+	{0x03008A, 62},	/* PCLATH */
+	{0x060C81, 385},	/* INDF1 */
+	{0x060C07, 409},	/* FSR1H */
+	{0x06001B, 203},	/* PR2 */
+	{0x020004, 21},	/* FSR */
+	{0x05008B, 69},	/* INTCON */
+	{0x020005, 37},	/* PORTA */
+	{0x060887, 409},	/* FSR1H */
+	{0x04008A, 62},	/* PCLATH */
+	{0x05000F, 124},	/* TMR1H */
+	{0x060803, 14},	/* STATUS */
+	{0x060C05, 397},	/* FSR0H */
+	{0x050002, 10},	/* PCL */
+	{0x060E03, 14},	/* STATUS */
+	{0x06009C, 284},	/* ADRESH */
+	{0x060C83, 14},	/* STATUS */
+	{0x06019E, 207},	/* TXSTA */
+	{0x060303, 14},	/* STATUS */
+	{0x06038B, 69},	/* INTCON */
+	{0x03800A, 62},	/* PCLATH */
+	{0x060304, 391},	/* FSR0L */
+	{0x060119, 551},	/* DACCON1 */
+	{0x05018D, 106},	/* EECON2 */
+	{0x050087, 298},	/* TRISC */
+	{0x040102, 10},	/* PCL */
+	{0x060109, 419},	/* WREG */
+	{0x068002, 10},	/* PCL */
+	{0x030086, 93},	/* TRISB */
+	{0x000001, 5},	/* TMR0 */
+	{0x060308, 415},	/* BSR */
+	{0x040005, 37},	/* PORTA */
+	{0x060002, 10},	/* PCL */
+	{0x060009, 419},	/* WREG */
+	{0x060F88, 415},	/* BSR */
+	{0x050102, 10},	/* PCL */
+	{0x060D8A, 62},	/* PCLATH */
+	{0x060199, 181},	/* RCREG */
+	{0x060787, 409},	/* FSR1H */
+	{0x060F00, 379},	/* INDF0 */
+	{0x060505, 397},	/* FSR0H */
+	{0x05018A, 62},	/* PCLATH */
+	{0x05000D, 243},	/* PIR2 */
+	{0x050104, 21},	/* FSR */
+	{0x040182, 10},	/* PCL */
+	{0x06078B, 69},	/* INTCON */
+	{0x06040A, 62},	/* PCLATH */
+	{0x060801, 385},	/* INDF1 */
+	{0x010002, 10},	/* PCL */
+	{0x060D0A, 62},	/* PCLATH */
+	{0x040084, 21},	/* FSR */
+	{0x060B06, 403},	/* FSR1L */
+	{0x060D83, 14},	/* STATUS */
+	{0x060B89, 419},	/* WREG */
+	{0x06058A, 62},	/* PCLATH */
+	{0x060503, 14},	/* STATUS */
+	{0x020003, 14},	/* STATUS */
+	{0x06040B, 69},	/* INTCON */
+	{0x060201, 385},	/* INDF1 */
+	{0x060789, 419},	/* WREG */
+	{0x050081, 76},	/* OPTION_REG */
+	{0x060502, 10},	/* PCL */
+	{0x060687, 409},	/* FSR1H */
+	{0x060F0B, 69},	/* INTCON */
+	{0x060113, 507},	/* CM2CON0 */
+	{0x04008E, 198},	/* PCON */
+	{0x060583, 14},	/* STATUS */
+	{0x068004, 391},	/* FSR0L */
+	{0x06060A, 62},	/* PCLATH */
+	{0x05008D, 316},	/* PIE2 */
+	{0x030089, 106},	/* EECON2 */
+	{0x060A80, 379},	/* INDF0 */
+	{0x060804, 391},	/* FSR0L */
+	{0x060684, 391},	/* FSR0L */
+	{0x04000B, 69},	/* INTCON */
+	{0x030001, 5},	/* TMR0 */
+	{0x060103, 14},	/* STATUS */
+	{0x060E84, 391},	/* FSR0L */
+	{0x060019, 434},	/* T1GCON */
+	{0x06000C, 37},	/* PORTA */
+	{0x028004, 21},	/* FSR */
+	{0x060D00, 379},	/* INDF0 */
+	{0x060406, 403},	/* FSR1L */
+	{0x050009, 237},	/* PORTE */
+	{0x060F86, 403},	/* FSR1L */
+	{0x06028A, 62},	/* PCLATH */
+	{0x060981, 385},	/* INDF1 */
+	{0x06090B, 69},	/* INTCON */
+	{0x060489, 419},	/* WREG */
+	{0x008005, 25},	/* OSCCAL */
+	{0x04001F, 187},	/* CMCON */
+	{0x060501, 385},	/* INDF1 */
+	{0x060098, 458},	/* OSCTUNE */
+	{0x040100, 0},	/* INDF */
+	{0x060D05, 397},	/* FSR0H */
+	{0x06030A, 62},	/* PCLATH */
+	{0x060580, 379},	/* INDF0 */
+	{0x060209, 419},	/* WREG */
+	{0x060E04, 391},	/* FSR0L */
+	{0x060D04, 391},	/* FSR0L */
+	{0x06019F, 631},	/* BAUDCON */
+	{0x010000, 0},	/* INDF */
+	{0x060D03, 14},	/* STATUS */
+	{0x060092, 316},	/* PIE2 */
+	{0x060011, 113},	/* PIR1 */
+	{0x060212, 652},	/* SSP1ADD */
+	{0x05010F, 372},	/* EEADRH */
+	{0x050094, 336},	/* SSPSTAT */
+	{0x050010, 130},	/* T1CON */
+	{0x060005, 397},	/* FSR0H */
+	{0x060185, 397},	/* FSR0H */
+	{0x060507, 409},	/* FSR1H */
+	{0x060A07, 409},	/* FSR1H */
+	{0x060C01, 385},	/* INDF1 */
+	{0x060486, 403},	/* FSR1L */
+	{0x060387, 409},	/* FSR1H */
+	{0x05009C, 187},	/* CMCON */
+	{0x060A0B, 69},	/* INTCON */
+	{0x050005, 37},	/* PORTA */
+	{0x018000, 0},	/* INDF */
+	{0x060089, 419},	/* WREG */
+	{0x040083, 14},	/* STATUS */
+	{0x040015, 147},	/* CCPR1L */
+	{0x060D02, 10},	/* PCL */
+	{0x06001A, 136},	/* TMR2 */
+	{0x060E85, 397},	/* FSR0H */
+	{0x060983, 14},	/* STATUS */
+	{0x060703, 14},	/* STATUS */
+	{0x060585, 397},	/* FSR0H */
+	{0x048000, 0},	/* INDF */
+	{0x050011, 136},	/* TMR2 */
+	{0x038004, 21},	/* FSR */
+	{0x04009C, 99},	/* EECON1 */
+	{0x060A05, 397},	/* FSR0H */
+	{0x020001, 5},	/* TMR0 */
+	{0x060689, 419},	/* WREG */
+	{0x050182, 10},	/* PCL */
+	{0x05800B, 69},	/* INTCON */
+	{0x030084, 21},	/* FSR */
+	{0x060F8A, 62},	/* PCLATH */
+	{0x060E8A, 62},	/* PCLATH */
+	{0x060C88, 415},	/* BSR */
+	{0x060208, 415},	/* BSR */
+	{0x060889, 419},	/* WREG */
+	{0x060900, 379},	/* INDF0 */
+	{0x050106, 43},	/* PORTB */
+	{0x050004, 21},	/* FSR */
+	{0x060205, 397},	/* FSR0H */
+	{0x040086, 93},	/* TRISB */
+	{0x04001A, 181},	/* RCREG */
+	{0x06080A, 62},	/* PCLATH */
+	{0x050099, 213},	/* SPBRG */
+	{0x050084, 21},	/* FSR */
+	{0x060C8A, 62},	/* PCLATH */
+	{0x010004, 21},	/* FSR */
+	{0x060211, 644},	/* SSP1BUF */
+	{0x060099, 466},	/* OSCCON */
+	{0x060214, 668},	/* SSP1STAT */
+	{0x060084, 391},	/* FSR0L */
+	{0x060F8B, 69},	/* INTCON */
+	{0x018001, 5},	/* TMR0 */
+	{0x04009B, 56},	/* EEADR */
+	{0x060307, 409},	/* FSR1H */
+	{0x06019A, 175},	/* TXREG */
+	{0x060607, 409},	/* FSR1H */
+	{0x060104, 391},	/* FSR0L */
+	{0x060F80, 379},	/* INDF0 */
+	{0x060C82, 10},	/* PCL */
+	{0x06010D, 486},	/* LATB */
+	{0x060485, 397},	/* FSR0H */
+	{0x05008E, 198},	/* PCON */
+	{0x040016, 154},	/* CCPR1H */
+	{0x050089, 310},	/* TRISE */
+	{0x060606, 403},	/* FSR1L */
+	{0x050092, 203},	/* PR2 */
+	{0x050183, 14},	/* STATUS */
+	{0x060107, 409},	/* FSR1H */
+	{0x010006, 32},	/* GPIO */
+	{0x060014, 429},	/* PIR4 */
+	{0x060D8B, 69},	/* INTCON */
+	{0x038002, 10},	/* PCL */
+	{0x040092, 203},	/* PR2 */
+	{0x06000B, 69},	/* INTCON */
+	{0x060309, 419},	/* WREG */
+	{0x060189, 419},	/* WREG */
+	{0x060D0B, 69},	/* INTCON */
+	{0x060A8B, 69},	/* INTCON */
+	{0x060115, 523},	/* CMOUT */
+	{0x06008B, 69},	/* INTCON */
+	{0x060E0B, 69},	/* INTCON */
+	{0x060112, 499},	/* CM1CON1 */
+	{0x068008, 415},	/* BSR */
+	{0x05009D, 344},	/* CVRCON */
+	{0x060707, 409},	/* FSR1H */
+	{0x060D85, 397},	/* FSR0H */
+	{0x050080, 0},	/* INDF */
+	{0x028002, 10},	/* PCL */
+	{0x040001, 5},	/* TMR0 */
+	{0x060017, 124},	/* TMR1H */
+};
+
+const char registerSymbolNames[] =
+	"INDF\0TMR0\0PCL\0STATUS\0FSR\0OSCCAL\0GPIO\0PORTA\0PORTB\0"
+	"EEDATA\0EEADR\0PCLATH\0INTCON\0OPTION_REG\0TRISA\0TRISB\0"
+	"EECON1\0EECON2\0PIR1\0TMR1L\0TMR1H\0T1CON\0TMR2\0T2CON\0"
+	"CCPR1L\0CCPR1H\0CCP1CON\0RCSTA\0TXREG\0RCREG\0CMCON\0PIE1\0"
+	"PCON\0PR2\0TXSTA\0SPBRG\0VRCON\0PORTC\0PORTD\0PORTE\0PIR2\0"
+	"SSPBUF\0SSPCON\0CCPR2L\0CCPR2H\0CCP2CON\0ADRESH\0ADCON0\0"
+	"TRISC\0TRISD\0TRISE\0PIE2\0SSPCON2\0SSPADD\0SSPSTAT\0CVRCON\0"
+	"ADRESL\0ADCON1\0EEDATH\0EEADRH\0INDF0\0INDF1\0FSR0L\0FSR0H\0"
+	"FSR1L\0FSR1H\0BSR\0WREG\0PIR3\0PIR4\0T1GCON\0PIE3\0PIE4\0"
+	"WDTCON\0OSCTUNE\0OSCCON\0OSCSTAT\0LATA\0LATB\0CM1CON0\0"
+	"CM1CON1\0CM2CON0\0CM2CON1\0CMOUT\0BORCON\0FVRCON\0DACCON0\0"
+	"DACCON1\0SRCON0\0SRCON1\0APFCON0\0APFCON1\0ANSELA\0ANSELB\0"
+	"EEADRL\0EEDATL\0SPBRGL\0SPBRGH\0BAUDCON\0WPUB\0SSP1BUF\0"
+	"SSP1ADD\0SSP1MSK\0SSP1STAT\0SSP1CON1\0SSP1CON2\0SSP1CON3\0";
+
@@ -61,6 +61,7 @@ int disassembleInstruction(disassembledInstruction *dInstruction, const assemble
 	dInstruction->address = aInstruction->address;
 	dInstruction->instruction = &(allInstructionSets[instructionSetIndex].instructionSet[instructionIndex]);
 	dInstruction->alternateInstruction = NULL;
+	dInstruction->resolvedOperands = 0;
 
 	/* Copy out each operand, extracting the operand data from the original
 	 * opcode using the operand mask. */
@@ -33,7 +33,7 @@
 /* Total number of assembly instructions */
 #define PIC_TOTAL_BASELINE_INSTRUCTIONS			34
 #define PIC_TOTAL_MIDRANGE_INSTRUCTIONS			38
-#define PIC_TOTAL_MIDRANGE_ENHANCED_INSTRUCTIONS	56
+#define PIC_TOTAL_MIDRANGE_ENHANCED_INSTRUCTIONS	54
 #define PIC_TOTAL_PIC18_INSTRUCTIONS			74
 
 /* Order of instruction sets held in allInstructionSets struct array */
@@ -99,6 +99,9 @@ struct _disassembledInstruction {
 	/* A pointer to an alternate disassembledInstruction,
 	 * so we can find all instructions with the same encoding. */
 	struct _disassembledInstruction *alternateInstruction;
+	/* Bit mask of the operands that hold full page or bank qualified
+	 * addresses, as resolved by the analysis in pic_analysis.c. */
+	int resolvedOperands;
 };
 typedef struct _disassembledInstruction disassembledInstruction;
 
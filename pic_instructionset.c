@@ -74,7 +74,7 @@ instructionInfo instructionSet_Baseline[PIC_TOTAL_BASELINE_INSTRUCTIONS] = {
 	{"sleep", 0x0003, 0, {0x0000, 0x0000, 0x0000}, {OPERAND_NONE, OPERAND_NONE, OPERAND_NONE}},
 	{"tris", 0x0000, 1, {0x0007, 0x0000, 0x0000}, {OPERAND_REGISTER, OPERAND_NONE, OPERAND_NONE}},
 	{"xorlw", 0x0f00, 1, {0x00ff, 0x0000, 0x0000}, {OPERAND_LITERAL, OPERAND_NONE, OPERAND_NONE}},
-	{"data", 0x0000, 1, {0x3fff, 0x0000, 0x0000}, {OPERAND_WORD_DATA, OPERAND_NONE, OPERAND_NONE}},
+	{"data", 0x0000, 1, {0xffff, 0x0000, 0x0000}, {OPERAND_WORD_DATA, OPERAND_NONE, OPERAND_NONE}},
 };
 
 instructionInfo instructionSet_MidRange[PIC_TOTAL_MIDRANGE_INSTRUCTIONS] = {
@@ -115,7 +115,7 @@ instructionInfo instructionSet_MidRange[PIC_TOTAL_MIDRANGE_INSTRUCTIONS] = {
 	{"sleep", 0x0063, 0, {0x0000, 0x0000, 0x0000}, {OPERAND_NONE, OPERAND_NONE, OPERAND_NONE}},
 	{"sublw", 0x3c00, 1, {0x00ff, 0x0100, 0x0000}, {OPERAND_LITERAL, OPERAND_NONE, OPERAND_NONE}},
 	{"xorlw", 0x3a00, 1, {0x00ff, 0x0000, 0x0000}, {OPERAND_LITERAL, OPERAND_NONE, OPERAND_NONE}},
-	{"data", 0x0000, 1, {0x3fff, 0x0000, 0x0000}, {OPERAND_WORD_DATA, OPERAND_NONE, OPERAND_NONE}},
+	{"data", 0x0000, 1, {0xffff, 0x0000, 0x0000}, {OPERAND_WORD_DATA, OPERAND_NONE, OPERAND_NONE}},
 };
 
 instructionInfo instructionSet_MidRange_Enhanced[PIC_TOTAL_MIDRANGE_ENHANCED_INSTRUCTIONS] = {
@@ -172,7 +172,7 @@ instructionInfo instructionSet_MidRange_Enhanced[PIC_TOTAL_MIDRANGE_ENHANCED_INS
 	{"sleep", 0x0063, 0, {0x0000, 0x0000, 0x0000}, {OPERAND_NONE, OPERAND_NONE, OPERAND_NONE}},
 	{"sublw", 0x3c00, 1, {0x00ff, 0x0100, 0x0000}, {OPERAND_LITERAL, OPERAND_NONE, OPERAND_NONE}},
 	{"xorlw", 0x3a00, 1, {0x00ff, 0x0000, 0x0000}, {OPERAND_LITERAL, OPERAND_NONE, OPERAND_NONE}},
-	{"data", 0x0000, 1, {0x3fff, 0x0000, 0x0000}, {OPERAND_WORD_DATA, OPERAND_NONE, OPERAND_NONE}},
+	{"data", 0x0000, 1, {0xffff, 0x0000, 0x0000}, {OPERAND_WORD_DATA, OPERAND_NONE, OPERAND_NONE}},
 };
 
 instructionInfo instructionSet_PIC18[PIC_TOTAL_PIC18_INSTRUCTIONS] = {
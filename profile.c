@@ -0,0 +1,466 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * profile.c - The --profile instrumentation: a monotonic clock charged to
+ *  one stage at a time, counters of the work done, and wrappers of the
+ *  input and output files that time their system calls.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#if defined(__x86_64__) || defined(__i386__)
+#define PROFILE_RDPMC
+#endif
+#endif
+#include "profile.h"
+#include "errorcodes.h"
+
+int profileMode = PROFILE_OFF;
+long profileCounters[PROFILE_NUM_COUNTERS];
+
+static double stageSeconds[PROFILE_NUM_STAGES];
+static int currentStage = PROFILE_STAGE_OTHER;
+static double startTime, lastSwitchTime;
+
+static const char *stageNames[PROFILE_NUM_STAGES] = {"other", "read", "parse", "analyze", "decode", "format", "write"};
+static const char *counterNames[PROFILE_NUM_COUNTERS] = {"records", "words", "instructions", "bytesIn", "bytesOut", "allocations"};
+static const char *counterLabels[PROFILE_NUM_COUNTERS] = {"Records", "Words", "Instructions", "Bytes in", "Bytes out", "Allocations"};
+
+/* Hardware performance counters, -1 where unavailable */
+static int perfEnabled = 0;
+static int perfFds[PROFILE_NUM_PERF_COUNTERS] = {-1, -1, -1, -1};
+static uint64_t perfLastValues[PROFILE_NUM_PERF_COUNTERS];
+static uint64_t perfStageCounts[PROFILE_NUM_STAGES][PROFILE_NUM_PERF_COUNTERS];
+static const char *perfCounterNames[PROFILE_NUM_PERF_COUNTERS] = {"cycles", "instructions", "branchMisses", "l1dMisses"};
+#ifdef PROFILE_RDPMC
+/* Pages of the counters mapped from the kernel, NULL where unmapped */
+static struct perf_event_mmap_page *perfPages[PROFILE_NUM_PERF_COUNTERS];
+static size_t perfPageSize;
+#endif
+
+#ifdef PROFILE_RDPMC
+/* Reads a counter in user space with rdpmc, as described in
+ * linux/perf_event.h. Returns -1 if the kernel doesn't allow it, or the
+ * counter isn't on the CPU right now, to fall back to a read(). */
+static int readPerfPage(int counter, uint64_t *value) {
+	volatile struct perf_event_mmap_page *page = perfPages[counter];
+	uint32_t seq, index, low, high;
+	uint64_t count;
+	int64_t pmc;
+
+	if (page == NULL)
+		return -1;
+	do {
+		seq = page->lock;
+		__asm__ __volatile__("" ::: "memory");
+		index = page->index;
+		if (!page->cap_user_rdpmc || index == 0)
+			return -1;
+		count = page->offset;
+		__asm__ __volatile__("rdpmc" : "=a" (low), "=d" (high) : "c" (index-1));
+		/* Sign extend the counter from its width */
+		pmc = (int64_t)(((uint64_t)high << 32) | low);
+		pmc = (int64_t)((uint64_t)pmc << (64 - page->pmc_width)) >> (64 - page->pmc_width);
+		count += pmc;
+		__asm__ __volatile__("" ::: "memory");
+	} while (page->lock != seq);
+
+	*value = count;
+	return 0;
+}
+#endif
+
+/* Reads the hardware performance counters and charges their increase since
+ * the last read to a stage. The counters are read with rdpmc where the
+ * kernel allows it, so that a stage switch doesn't cost system calls. */
+static void readPerfCounters(int stage) {
+#ifdef __linux__
+	uint64_t value;
+	int i;
+
+	for (i = 0; i < PROFILE_NUM_PERF_COUNTERS; i++) {
+		if (perfFds[i] < 0)
+			continue;
+#ifdef PROFILE_RDPMC
+		if (readPerfPage(i, &value) < 0 && read(perfFds[i], &value, sizeof(value)) != sizeof(value))
+			continue;
+#else
+		if (read(perfFds[i], &value, sizeof(value)) != sizeof(value))
+			continue;
+#endif
+		perfStageCounts[stage][i] += value - perfLastValues[i];
+		perfLastValues[i] = value;
+	}
+#else
+	(void)stage;
+#endif
+}
+
+/* Monotonic time in seconds */
+static double profileTime(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+/* Charges the time since the last switch to the current stage and makes
+ * stage the current one. Returns the previous stage, to switch back to. */
+int profileSwitch(int stage) {
+	double now = profileTime();
+	int previousStage = currentStage;
+
+	stageSeconds[currentStage] += now - lastSwitchTime;
+	lastSwitchTime = now;
+	if (perfEnabled)
+		readPerfCounters(currentStage);
+	currentStage = stage;
+
+	return previousStage;
+}
+
+/* Prints the profile when the program exits, after everything buffered
+ * has been written out. */
+static void printProfileAtExit(void) {
+	fflush(NULL);
+	printProfile(stderr, profileMode);
+}
+
+/* Starts profiling, printing the profile to stderr at exit in one of the
+ * PIC_Profile_Formats. */
+int startProfile(int format) {
+	if (format != PROFILE_TEXT && format != PROFILE_JSON)
+		return ERROR_INVALID_ARGUMENTS;
+
+	profileMode = format;
+	memset(profileCounters, 0, sizeof(profileCounters));
+	memset(stageSeconds, 0, sizeof(stageSeconds));
+	currentStage = PROFILE_STAGE_OTHER;
+	startTime = lastSwitchTime = profileTime();
+	if (atexit(printProfileAtExit) != 0)
+		return ERROR_IRRECOVERABLE;
+
+	return 0;
+}
+
+#ifdef __linux__
+/* Opens a counter of the user space of this process on any CPU. */
+static int openPerfCounter(uint32_t type, uint64_t config) {
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+/* Opens the hardware performance counters of the process, so the profile
+ * also counts cycles, instructions, branch misses and L1 data cache misses
+ * per stage. Prints a note and returns a negative number if the counters
+ * are unavailable; profiling then goes on with the timings only. A stage
+ * switch reads the counters with rdpmc where the kernel allows it, and
+ * costs a system call per counter otherwise. */
+int startPerfCounters(void) {
+#ifdef __linux__
+	int i, numOpen = 0;
+
+	perfFds[PROFILE_PERF_CYCLES] = openPerfCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+	perfFds[PROFILE_PERF_INSTRUCTIONS] = openPerfCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+	perfFds[PROFILE_PERF_BRANCH_MISSES] = openPerfCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+	perfFds[PROFILE_PERF_L1D_MISSES] = openPerfCounter(PERF_TYPE_HW_CACHE,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+
+	/* Virtual machines often lack some of the counters, the others are
+	 * still worth reporting */
+#ifdef PROFILE_RDPMC
+	perfPageSize = sysconf(_SC_PAGESIZE);
+#endif
+	for (i = 0; i < PROFILE_NUM_PERF_COUNTERS; i++) {
+		if (perfFds[i] >= 0) {
+			numOpen++;
+#ifdef PROFILE_RDPMC
+			/* The first page of the counter tells how to read it with
+			 * rdpmc; without it the counter is read with read() */
+			perfPages[i] = mmap(NULL, perfPageSize, PROT_READ, MAP_SHARED, perfFds[i], 0);
+			if (perfPages[i] == MAP_FAILED)
+				perfPages[i] = NULL;
+			if (readPerfPage(i, &perfLastValues[i]) == 0)
+				continue;
+#endif
+			if (read(perfFds[i], &perfLastValues[i], sizeof(uint64_t)) != sizeof(uint64_t))
+				perfLastValues[i] = 0;
+		}
+	}
+	if (numOpen == 0) {
+		perror("Note: Hardware performance counters are unavailable");
+		return ERROR_IRRECOVERABLE;
+	}
+	perfEnabled = 1;
+	return 0;
+#else
+	fprintf(stderr, "Note: Hardware performance counters are unavailable on this system.\n");
+	return ERROR_IRRECOVERABLE;
+#endif
+}
+
+/* Wrapped file, see profileFile() */
+struct _profiledFile {
+	FILE *file;
+	int fd;
+};
+typedef struct _profiledFile profiledFile;
+
+static ssize_t profiledRead(void *cookie, char *buffer, size_t size) {
+	profiledFile *pFile = cookie;
+	int previousStage;
+	ssize_t length;
+
+	previousStage = profileSwitch(PROFILE_STAGE_READ);
+	do {
+		length = read(pFile->fd, buffer, size);
+	} while (length < 0 && errno == EINTR);
+	profileSwitch(previousStage);
+
+	if (length > 0)
+		profileCounters[PROFILE_COUNTER_BYTES_IN] += length;
+	return length;
+}
+
+static ssize_t profiledWrite(void *cookie, const char *buffer, size_t size) {
+	profiledFile *pFile = cookie;
+	int previousStage;
+	size_t written = 0;
+	ssize_t length;
+
+	previousStage = profileSwitch(PROFILE_STAGE_WRITE);
+	while (written < size) {
+		length = write(pFile->fd, buffer+written, size-written);
+		if (length < 0 && errno == EINTR)
+			continue;
+		if (length <= 0)
+			break;
+		written += length;
+	}
+	profileSwitch(previousStage);
+
+	profileCounters[PROFILE_COUNTER_BYTES_OUT] += written;
+	/* Partial writes are errors for stdio */
+	return (written == size) ? (ssize_t)written : -1;
+}
+
+static int profiledClose(void *cookie) {
+	profiledFile *pFile = cookie;
+	int retVal;
+
+	retVal = fclose(pFile->file);
+	free(pFile);
+
+	return retVal;
+}
+
+/* Wraps a file so the time spent in its read or write system calls is
+ * charged to the I/O stages and its bytes are counted. Returns the file
+ * itself when profiling is off, or if it has no file descriptor, like a
+ * file in memory. */
+FILE *profileFile(FILE *file, const char *mode) {
+	cookie_io_functions_t functions = {profiledRead, profiledWrite, NULL, profiledClose};
+	profiledFile *pFile;
+	FILE *wrapped;
+
+	if (profileMode == PROFILE_OFF || file == NULL || fileno(file) < 0)
+		return file;
+
+	/* Nothing may be left in the buffers of the file, the wrapper goes
+	 * around them straight to the file descriptor */
+	fflush(file);
+
+	pFile = malloc(sizeof(profiledFile));
+	if (pFile == NULL)
+		return file;
+	pFile->file = file;
+	pFile->fd = fileno(file);
+
+	wrapped = fopencookie(pFile, mode, functions);
+	if (wrapped == NULL) {
+		free(pFile);
+		return file;
+	}
+
+	return wrapped;
+}
+
+/* Prints a performance counter value, or - if the counter is unavailable. */
+static int printPerfValue(FILE *out, int counter, uint64_t value, int width) {
+	if (perfFds[counter] < 0)
+		return fprintf(out, " %*s", width, "-");
+	return fprintf(out, " %*llu", width, (unsigned long long)value);
+}
+
+/* Prints the hardware performance counters of every stage, with the
+ * instructions per cycle, and the totals per decoded instruction. */
+static int printPerfCounters(FILE *out, int format) {
+	uint64_t totals[PROFILE_NUM_PERF_COUNTERS];
+	long numDecoded = profileCounters[PROFILE_COUNTER_INSTRUCTIONS];
+	double ipc;
+	int i, j, first, retVal = 0;
+
+	memset(totals, 0, sizeof(totals));
+	for (i = 0; i < PROFILE_NUM_STAGES; i++) {
+		for (j = 0; j < PROFILE_NUM_PERF_COUNTERS; j++)
+			totals[j] += perfStageCounts[i][j];
+	}
+
+	if (format == PROFILE_JSON) {
+		if (fprintf(out, ", \"perf\": {\"stages\": {") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		for (i = 0; i < PROFILE_NUM_STAGES && retVal == 0; i++) {
+			if (fprintf(out, "%s\"%s\": {", (i > 0) ? ", " : "", stageNames[i]) < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+			for (j = 0, first = 1; j < PROFILE_NUM_PERF_COUNTERS && retVal == 0; j++) {
+				if (perfFds[j] < 0)
+					continue;
+				if (fprintf(out, "%s\"%s\": %llu", first ? "" : ", ", perfCounterNames[j], (unsigned long long)perfStageCounts[i][j]) < 0)
+					retVal = ERROR_FILE_WRITING_ERROR;
+				first = 0;
+			}
+			if (retVal == 0 && perfFds[PROFILE_PERF_CYCLES] >= 0 && perfFds[PROFILE_PERF_INSTRUCTIONS] >= 0 && perfStageCounts[i][PROFILE_PERF_CYCLES] > 0) {
+				ipc = (double)perfStageCounts[i][PROFILE_PERF_INSTRUCTIONS]/perfStageCounts[i][PROFILE_PERF_CYCLES];
+				if (fprintf(out, ", \"ipc\": %.3f", ipc) < 0)
+					retVal = ERROR_FILE_WRITING_ERROR;
+			}
+			if (retVal == 0 && fprintf(out, "}") < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		if (retVal == 0 && fprintf(out, "}, \"perInstruction\": {") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		for (j = 0, first = 1; j < PROFILE_NUM_PERF_COUNTERS && retVal == 0; j++) {
+			if (perfFds[j] < 0 || j == PROFILE_PERF_INSTRUCTIONS)
+				continue;
+			if (fprintf(out, "%s\"%s\": %.4f", first ? "" : ", ", perfCounterNames[j], (numDecoded > 0) ? (double)totals[j]/numDecoded : 0.0) < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+			first = 0;
+		}
+		if (retVal == 0 && fprintf(out, "}}") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+	} else {
+		if (fprintf(out, "\nStage                  Cycles   Instructions    IPC  Branch misses     L1D misses\n") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		for (i = 0; i <= PROFILE_NUM_STAGES && retVal == 0; i++) {
+			const uint64_t *counts = (i < PROFILE_NUM_STAGES) ? perfStageCounts[i] : totals;
+
+			if (fprintf(out, "  %-10s", (i < PROFILE_NUM_STAGES) ? stageNames[i] : "total") < 0 ||
+			    printPerfValue(out, PROFILE_PERF_CYCLES, counts[PROFILE_PERF_CYCLES], 14) < 0 ||
+			    printPerfValue(out, PROFILE_PERF_INSTRUCTIONS, counts[PROFILE_PERF_INSTRUCTIONS], 14) < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+			if (retVal == 0) {
+				if (perfFds[PROFILE_PERF_CYCLES] >= 0 && perfFds[PROFILE_PERF_INSTRUCTIONS] >= 0 && counts[PROFILE_PERF_CYCLES] > 0)
+					retVal = fprintf(out, " %6.2f", (double)counts[PROFILE_PERF_INSTRUCTIONS]/counts[PROFILE_PERF_CYCLES]);
+				else
+					retVal = fprintf(out, " %6s", "-");
+				retVal = (retVal < 0) ? ERROR_FILE_WRITING_ERROR : 0;
+			}
+			if (retVal == 0 && (printPerfValue(out, PROFILE_PERF_BRANCH_MISSES, counts[PROFILE_PERF_BRANCH_MISSES], 14) < 0 ||
+			    printPerfValue(out, PROFILE_PERF_L1D_MISSES, counts[PROFILE_PERF_L1D_MISSES], 14) < 0 || fprintf(out, "\n") < 0))
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		if (retVal == 0 && numDecoded > 0) {
+			if (fprintf(out, "Per decoded instruction:") < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+			for (j = 0, first = 1; j < PROFILE_NUM_PERF_COUNTERS && retVal == 0; j++) {
+				if (perfFds[j] < 0 || j == PROFILE_PERF_INSTRUCTIONS)
+					continue;
+				if (fprintf(out, "%s %.3f %s", first ? "" : ",", (double)totals[j]/numDecoded,
+				    (j == PROFILE_PERF_CYCLES) ? "cycles" : (j == PROFILE_PERF_BRANCH_MISSES) ? "branch misses" : "L1D misses") < 0)
+					retVal = ERROR_FILE_WRITING_ERROR;
+				first = 0;
+			}
+			if (retVal == 0 && fprintf(out, "\n") < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+	}
+
+	return retVal;
+}
+
+/* Prints the stage times and counters. */
+int printProfile(FILE *out, int format) {
+	double totalSeconds;
+	int i, retVal = 0;
+
+	profileSwitch(currentStage);
+	totalSeconds = lastSwitchTime - startTime;
+
+	if (format == PROFILE_JSON) {
+		if (fprintf(out, "{\"seconds\": %.6f, \"stages\": {", totalSeconds) < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		for (i = 0; i < PROFILE_NUM_STAGES && retVal == 0; i++) {
+			if (fprintf(out, "%s\"%s\": %.6f", (i > 0) ? ", " : "", stageNames[i], stageSeconds[i]) < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		if (retVal == 0 && fprintf(out, "}, \"counters\": {") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		for (i = 0; i < PROFILE_NUM_COUNTERS && retVal == 0; i++) {
+			if (fprintf(out, "%s\"%s\": %ld", (i > 0) ? ", " : "", counterNames[i], profileCounters[i]) < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		if (retVal == 0 && fprintf(out, "}") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		if (retVal == 0 && perfEnabled)
+			retVal = printPerfCounters(out, format);
+		if (retVal == 0 && fprintf(out, "}\n") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+	} else {
+		if (fprintf(out, "; Profile\nStage            Seconds  Percent\n") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		for (i = 0; i < PROFILE_NUM_STAGES && retVal == 0; i++) {
+			if (fprintf(out, "  %-10s %11.6f  %5.1f%%\n", stageNames[i], stageSeconds[i],
+			    (totalSeconds > 0) ? 100.0*stageSeconds[i]/totalSeconds : 0.0) < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		if (retVal == 0 && fprintf(out, "  %-10s %11.6f\n\n", "total", totalSeconds) < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		for (i = 0; i < PROFILE_NUM_COUNTERS && retVal == 0; i++) {
+			if (fprintf(out, "%-14s %10ld\n", counterLabels[i], profileCounters[i]) < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		if (retVal == 0 && totalSeconds > 0 && fprintf(out, "Throughput     %10.2f MB/s in, %.0f words/s\n",
+		    profileCounters[PROFILE_COUNTER_BYTES_IN]/totalSeconds/1e6, profileCounters[PROFILE_COUNTER_WORDS]/totalSeconds) < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		if (retVal == 0 && perfEnabled)
+			retVal = printPerfCounters(out, format);
+	}
+
+	return retVal;
+}
+
@@ -0,0 +1,113 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * profile.h - Header file for the --profile instrumentation: time spent in
+ *  each stage of the disassembly, and counters of the work done.
+ *
+ */
+
+#ifndef PROFILE_DISASM_H
+#define PROFILE_DISASM_H
+
+#include <stdio.h>
+
+/* Stages the time is charged to. Only one stage runs at a time, so the
+ * stage times add up to the total and never count anything twice: the
+ * system calls reading the input and writing the output are charged to
+ * the I/O stages, even in the middle of parsing or formatting. */
+enum PIC_Profile_Stages {
+	PROFILE_STAGE_OTHER,
+	PROFILE_STAGE_READ,
+	PROFILE_STAGE_PARSE,
+	PROFILE_STAGE_ANALYZE,
+	PROFILE_STAGE_DECODE,
+	PROFILE_STAGE_FORMAT,
+	PROFILE_STAGE_WRITE,
+	PROFILE_NUM_STAGES,
+};
+
+/* Counters of the work done */
+enum PIC_Profile_Counters {
+	PROFILE_COUNTER_RECORDS,
+	PROFILE_COUNTER_WORDS,
+	PROFILE_COUNTER_INSTRUCTIONS,
+	PROFILE_COUNTER_BYTES_IN,
+	PROFILE_COUNTER_BYTES_OUT,
+	PROFILE_COUNTER_ALLOCATIONS,
+	PROFILE_NUM_COUNTERS,
+};
+
+/* Hardware performance counters sampled at every stage switch, when
+ * available */
+enum PIC_Profile_Perf_Counters {
+	PROFILE_PERF_CYCLES,
+	PROFILE_PERF_INSTRUCTIONS,
+	PROFILE_PERF_BRANCH_MISSES,
+	PROFILE_PERF_L1D_MISSES,
+	PROFILE_NUM_PERF_COUNTERS,
+};
+
+/* Formats of the profile printed at exit */
+enum PIC_Profile_Formats {
+	PROFILE_OFF,
+	PROFILE_TEXT,
+	PROFILE_JSON,
+};
+
+extern int profileMode;
+extern long profileCounters[PROFILE_NUM_COUNTERS];
+
+/* Charges the time since the last switch to the current stage and makes
+ * stage the current one. Returns the previous stage, to switch back to. */
+int profileSwitch(int stage);
+
+/* The instrumentation is a well predicted branch on profileMode when
+ * profiling is off, and compiles to nothing at all with -DNO_PROFILE. */
+#ifdef NO_PROFILE
+static inline int profileSwitchOff(int stage) { (void)stage; return 0; }
+#define PROFILE_SWITCH(stage)		profileSwitchOff(stage)
+#define PROFILE_COUNT(counter, n)	do { } while (0)
+#else
+#define PROFILE_SWITCH(stage)		(profileMode != PROFILE_OFF ? profileSwitch(stage) : 0)
+#define PROFILE_COUNT(counter, n)	do { if (profileMode != PROFILE_OFF) profileCounters[counter] += (n); } while (0)
+#endif
+
+/* Starts profiling, printing the profile to stderr at exit in one of the
+ * PIC_Profile_Formats. */
+int startProfile(int format);
+
+/* Opens the hardware performance counters of the process, so the profile
+ * also counts cycles, instructions, branch misses and L1 data cache misses
+ * per stage. Prints a note and returns a negative number if the counters
+ * are unavailable; profiling then goes on with the timings only. A stage
+ * switch reads the counters with rdpmc where the kernel allows it, and
+ * costs a system call per counter otherwise. */
+int startPerfCounters(void);
+
+/* Wraps a file so the time spent in its read or write system calls is
+ * charged to the I/O stages and its bytes are counted. Returns the file
+ * itself when profiling is off, or if it has no file descriptor, like a
+ * file in memory. */
+FILE *profileFile(FILE *file, const char *mode);
+
+/* Prints the stage times and counters. */
+int printProfile(FILE *out, int format);
+
+#endif
+
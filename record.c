@@ -0,0 +1,197 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * record.c - Structured output formats: JSON Lines with one object per
+ *  word, and a length prefixed binary record stream. Both are written from
+ *  the decoded instructions, never from the formatted text.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pic_disasm.h"
+#include "pic_device.h"
+#include "format.h"
+#include "record.h"
+#include "errorcodes.h"
+
+extern instructionSetInfo allInstructionSets[];
+
+/* Names of the PIC_Operand_Types in JSON records */
+static const char *operandTypeNames[] = {
+	"none", "register", "destination", "bit", "literal", "absolute_address",
+	"word_data", "relative_address", "signed_literal", "fsr_index",
+	"increment_mode", "indf_index"
+};
+
+/* Names of the PIC_Memory_Regions in JSON records */
+static const char *regionNames[] = {"program", "idlocs", "config", "eeprom", "unimplemented"};
+
+/* Returns the index of an instruction in its instruction set. */
+static int instructionId(const instructionInfo *instruction) {
+	int i;
+
+	for (i = 0; i <= PIC_PIC18; i++) {
+		if (instruction >= allInstructionSets[i].instructionSet &&
+		    instruction < allInstructionSets[i].instructionSet + allInstructionSets[i].numInstructions)
+			return instruction - allInstructionSets[i].instructionSet;
+	}
+	return RECORD_NO_INSTRUCTION;
+}
+
+/* Stores little endian integers into a record buffer */
+static unsigned char *putLE32(unsigned char *p, uint32_t data) {
+	p[0] = data & 0xFF;
+	p[1] = (data >> 8) & 0xFF;
+	p[2] = (data >> 16) & 0xFF;
+	p[3] = (data >> 24) & 0xFF;
+	return p+4;
+}
+static unsigned char *putLE16(unsigned char *p, uint16_t data) {
+	p[0] = data & 0xFF;
+	p[1] = (data >> 8) & 0xFF;
+	return p+2;
+}
+
+/* Writes a binary record with the common fields and operands. */
+static int writeBinaryRecord(FILE *out, const assembledInstruction *aInstruction, int id, int region, const disassembledInstruction *dInstruction) {
+	unsigned char record[1 + 10 + PIC_MAX_NUM_OPERANDS*5];
+	unsigned char *p = record+1;
+	int numOperands, i;
+
+	numOperands = (dInstruction != NULL) ? dInstruction->instruction->numOperands : 0;
+	p = putLE32(p, aInstruction->address);
+	p = putLE16(p, aInstruction->opcode);
+	*p++ = id;
+	*p++ = region;
+	*p++ = (dInstruction != NULL) ? dInstruction->resolvedOperands : 0;
+	*p++ = numOperands;
+	for (i = 0; i < numOperands; i++) {
+		*p++ = dInstruction->instruction->operandTypes[i];
+		p = putLE32(p, (uint32_t)dInstruction->operands[i]);
+	}
+	record[0] = (p - record) - 1;
+
+	if (fwrite(record, 1, p - record, out) != (size_t)(p - record))
+		return ERROR_FILE_WRITING_ERROR;
+	return 0;
+}
+
+/* Writes the header of the record stream, if the output format has one. */
+int writeRecordHeader(FILE *out, int archSelect, formattingOptions fOptions) {
+	unsigned char header[8];
+	int i;
+
+	if (fOptions.outputFormat != OUTPUT_FORMAT_BINARY)
+		return 0;
+
+	memcpy(header, RECORD_MAGIC, 4);
+	header[4] = RECORD_VERSION;
+	header[5] = archSelect;
+	header[6] = allInstructionSets[archSelect].numInstructions;
+	header[7] = 0;
+	if (fwrite(header, 1, sizeof(header), out) != sizeof(header))
+		return ERROR_FILE_WRITING_ERROR;
+	for (i = 0; i < allInstructionSets[archSelect].numInstructions; i++) {
+		if (fputs(allInstructionSets[archSelect].instructionSet[i].mnemonic, out) == EOF || fputc('\0', out) == EOF)
+			return ERROR_FILE_WRITING_ERROR;
+	}
+
+	return 0;
+}
+
+/* Writes a disassembled instruction as a JSON object on a single line, or
+ * as a binary record, depending on fOptions.outputFormat. */
+int writeInstructionRecord(FILE *out, const assembledInstruction *aInstruction, const disassembledInstruction *dInstruction, formattingOptions fOptions) {
+	const char *registerName;
+	int i, type, retVal;
+
+	if (fOptions.outputFormat == OUTPUT_FORMAT_BINARY)
+		return writeBinaryRecord(out, aInstruction, instructionId(dInstruction->instruction), REGION_PROGRAM, dInstruction);
+
+	retVal = fprintf(out, "{\"address\": %lu, \"opcode\": %u, \"mnemonic\": \"%s\", \"operands\": [",
+		(unsigned long)aInstruction->address, aInstruction->opcode, dInstruction->instruction->mnemonic);
+	for (i = 0; i < dInstruction->instruction->numOperands && retVal >= 0; i++) {
+		type = dInstruction->instruction->operandTypes[i];
+		retVal = fprintf(out, "%s{\"type\": \"%s\", ", (i > 0) ? ", " : "", operandTypeNames[type]);
+		if (retVal < 0)
+			break;
+
+		switch (type) {
+			case OPERAND_REGISTER_DEST:
+				retVal = fprintf(out, "\"value\": \"%s\"", (dInstruction->operands[i] == 0) ? OPERAND_REGISTER_DEST_W : OPERAND_REGISTER_DEST_F);
+				break;
+			case OPERAND_RELATIVE_ADDRESS:
+				retVal = fprintf(out, "\"value\": %ld, \"target\": %ld", (long)dInstruction->operands[i],
+					(long)dInstruction->address + dInstruction->operands[i] + 1);
+				break;
+			default:
+				retVal = fprintf(out, "\"value\": %ld", (long)dInstruction->operands[i]);
+				break;
+		}
+
+		/* Resolved operands hold full addresses, and registers may
+		 * have a name on the selected device */
+		if (retVal >= 0 && (dInstruction->resolvedOperands & (1<<i)))
+			retVal = fprintf(out, ", \"resolved\": true");
+		if (retVal >= 0 && type == OPERAND_REGISTER && fOptions.deviceIndex >= 0) {
+			registerName = lookupRegisterName(fOptions.deviceIndex, dInstruction->operands[i], dInstruction->resolvedOperands & (1<<i));
+			if (registerName != NULL)
+				retVal = fprintf(out, ", \"name\": \"%s\"", registerName);
+		}
+		if (retVal >= 0)
+			retVal = fprintf(out, "}");
+	}
+	if (retVal >= 0)
+		retVal = fprintf(out, "]}\n");
+
+	return (retVal < 0) ? ERROR_FILE_WRITING_ERROR : 0;
+}
+
+/* Writes a word outside of program memory (in one of the
+ * PIC_Memory_Regions other than REGION_PROGRAM) as a record. Configuration
+ * words come with their decoded settings in JSON. */
+int writeMemoryWordRecord(FILE *out, const assembledInstruction *aInstruction, int region, formattingOptions fOptions) {
+	const deviceInfo *device;
+	const configSetting *setting;
+	int retVal, i, n;
+
+	if (fOptions.outputFormat == OUTPUT_FORMAT_BINARY)
+		return writeBinaryRecord(out, aInstruction, RECORD_NO_INSTRUCTION, region, NULL);
+
+	retVal = fprintf(out, "{\"address\": %lu, \"opcode\": %u, \"region\": \"%s\"",
+		(unsigned long)aInstruction->address, aInstruction->opcode, regionNames[region]);
+	if (retVal >= 0 && region == REGION_CONFIG) {
+		device = &allDevices[fOptions.deviceIndex];
+		retVal = fprintf(out, ", \"settings\": {");
+		for (i = 0, n = 0; i < device->numConfigSettings && retVal >= 0; i++) {
+			setting = &configSettings[device->firstConfigSetting + i];
+			if (setting->address != aInstruction->address || (aInstruction->opcode & setting->mask) != setting->value)
+				continue;
+			retVal = fprintf(out, "%s\"%s\": \"%s\"", (n++ > 0) ? ", " : "", setting->field, setting->setting);
+		}
+		if (retVal >= 0)
+			retVal = fprintf(out, "}");
+	}
+	if (retVal >= 0)
+		retVal = fprintf(out, "}\n");
+
+	return (retVal < 0) ? ERROR_FILE_WRITING_ERROR : 0;
+}
+
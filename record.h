@@ -0,0 +1,71 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * record.h - Header file for the structured output formats, which write
+ *  the decoded instructions as records instead of assembly text.
+ *
+ */
+
+#ifndef RECORD_DISASM_H
+#define RECORD_DISASM_H
+
+#include <stdio.h>
+#include "pic_disasm.h"
+#include "format.h"
+
+/* Binary record stream layout, all integers little endian:
+ *
+ * Header:
+ *   char     magic[4]		"vPIC"
+ *   uint8    version		RECORD_VERSION
+ *   uint8    archSelect	index of the instruction set
+ *   uint8    numInstructions	number of instruction set entries
+ *   uint8    reserved
+ *   then numInstructions NUL terminated mnemonics, so instruction ids
+ *   can be named without a copy of the instruction set tables.
+ *
+ * Record, one per word:
+ *   uint8    length		number of bytes following the length byte
+ *   uint32   address
+ *   uint16   opcode
+ *   uint8    instruction id	index into the mnemonics, or RECORD_NO_INSTRUCTION
+ *   uint8    region		one of the PIC_Memory_Regions
+ *   uint8    resolved		bit mask of the resolved operands
+ *   uint8    numOperands
+ *   then for each operand:
+ *   uint8    type		one of the PIC_Operand_Types
+ *   int32    value
+ */
+#define RECORD_MAGIC			"vPIC"
+#define RECORD_VERSION			1
+#define RECORD_NO_INSTRUCTION		0xFF
+
+/* Writes the header of the record stream, if the output format has one. */
+int writeRecordHeader(FILE *out, int archSelect, formattingOptions fOptions);
+
+/* Writes a disassembled instruction as a JSON object on a single line, or
+ * as a binary record, depending on fOptions.outputFormat. */
+int writeInstructionRecord(FILE *out, const assembledInstruction *aInstruction, const disassembledInstruction *dInstruction, formattingOptions fOptions);
+
+/* Writes a word outside of program memory (in one of the
+ * PIC_Memory_Regions other than REGION_PROGRAM) as a record. */
+int writeMemoryWordRecord(FILE *out, const assembledInstruction *aInstruction, int region, formattingOptions fOptions);
+
+#endif
+
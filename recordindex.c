@@ -0,0 +1,429 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * recordindex.c - Sidecar record offset index of program files. The index
+ *  splits a file into blocks of records, each with its byte offset, the
+ *  range of word addresses it holds and the extended address in effect at
+ *  its start, so only the blocks of an address range are read and parsed.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include "file.h"
+#include "errorcodes.h"
+#include "recordindex.h"
+
+/* Magic bytes at the start of an index file */
+#define RECORD_INDEX_MAGIC	"vPICidx1"
+
+enum {
+	RECORD_INDEX_IHEX,
+	RECORD_INDEX_SRECORD,
+};
+
+/* Header of an index file, followed by the blocks. The size and
+ * modification time are those of the program file it was built from. */
+struct _recordIndexHeader {
+	char magic[8];
+	uint64_t fileSize;
+	int64_t mtimeSeconds;
+	int64_t mtimeNanoseconds;
+	uint32_t fileType;
+	uint32_t numBlocks;
+};
+typedef struct _recordIndexHeader recordIndexHeader;
+
+/* A block of records. Blocks with no words have a firstWord greater than
+ * their lastWord. */
+struct _recordBlock {
+	uint64_t offset;
+	uint32_t length;
+	uint32_t firstWord;
+	uint32_t lastWord;
+	/* Upper address bits set by the extended address records before the block */
+	uint32_t addressOffset;
+};
+typedef struct _recordBlock recordBlock;
+
+/* Structure to hold an index while it is built or used */
+struct _recordIndex {
+	recordIndexHeader header;
+	recordBlock *blocks;
+	int capacity;
+};
+typedef struct _recordIndex recordIndex;
+
+/* Parses n hexadecimal digits, returns -1 if one of them isn't one */
+static int parseHexDigits(const char *text, int n, uint32_t *value) {
+	int i;
+
+	*value = 0;
+	for (i = 0; i < n; i++) {
+		if (text[i] >= '0' && text[i] <= '9')
+			*value = (*value << 4) | (text[i] - '0');
+		else if (text[i] >= 'A' && text[i] <= 'F')
+			*value = (*value << 4) | (text[i] - 'A' + 10);
+		else if (text[i] >= 'a' && text[i] <= 'f')
+			*value = (*value << 4) | (text[i] - 'a' + 10);
+		else
+			return -1;
+	}
+	return 0;
+}
+
+/* Counts the words a data record appends to the program image, carrying
+ * the byte of odd length records over to the next record the same way
+ * readIHexFile() and readSRecordFile() do. */
+static int countRecordWords(int dataLen, int *carry) {
+	int i, n;
+
+	n = 0;
+	for (i = 0; i < dataLen; i += 2) {
+		if (i+1 >= dataLen) {
+			/* The readers reject the record */
+			if (dataLen % 2 == 0)
+				break;
+			*carry = 1;
+			continue;
+		}
+		if (*carry) {
+			*carry = 0;
+			i--;
+		}
+		n++;
+	}
+	return n;
+}
+
+/* Appends a block to the index, growing the blocks array as necessary. */
+static int appendBlock(recordIndex *index, const recordBlock *block) {
+	recordBlock *newBlocks;
+	int newCapacity;
+
+	if ((int)index->header.numBlocks == index->capacity) {
+		newCapacity = (index->capacity == 0) ? 256 : index->capacity*2;
+		newBlocks = realloc(index->blocks, newCapacity*sizeof(recordBlock));
+		if (newBlocks == NULL)
+			return ERROR_MEMORY_ALLOCATION_ERROR;
+		index->blocks = newBlocks;
+		index->capacity = newCapacity;
+	}
+	index->blocks[index->header.numBlocks++] = *block;
+
+	return 0;
+}
+
+/* Scans the records of a program file into blocks. Only the record
+ * headers are parsed; the records are checked when they are read. A block
+ * only ends where no odd byte is carried over to the next record. */
+static int buildRecordIndex(recordIndex *index, FILE *fileIn, int fileType) {
+	recordBlock block;
+	char *line;
+	size_t lineCapacity;
+	ssize_t length;
+	uint32_t dataLen, address, type, value;
+	uint32_t addressOffset, firstWord;
+	int carry, addressDigits, n;
+
+	memset(&block, 0, sizeof(block));
+	block.firstWord = UINT32_MAX;
+	addressOffset = 0;
+	carry = 0;
+
+	line = NULL;
+	lineCapacity = 0;
+	while ((length = getline(&line, &lineCapacity, fileIn)) > 0) {
+		if (block.length >= RECORD_INDEX_BLOCK_SIZE && !carry) {
+			if (appendBlock(index, &block) < 0) {
+				free(line);
+				return ERROR_MEMORY_ALLOCATION_ERROR;
+			}
+			block.offset += block.length;
+			block.length = 0;
+			block.firstWord = UINT32_MAX;
+			block.lastWord = 0;
+			block.addressOffset = addressOffset;
+		}
+		block.length += length;
+
+		n = 0;
+		firstWord = 0;
+		if (fileType == RECORD_INDEX_IHEX && line[0] == ':' && length >= 11 &&
+		    parseHexDigits(line+1, 2, &dataLen) == 0 && parseHexDigits(line+3, 4, &address) == 0 &&
+		    parseHexDigits(line+7, 2, &type) == 0) {
+			if ((type == 0x02 || type == 0x04) && dataLen == 2 && length >= 13 && parseHexDigits(line+9, 4, &value) == 0)
+				addressOffset = (type == 0x02) ? (value << 4) : (value << 16);
+			else if (type == 0x00) {
+				firstWord = (addressOffset + address)/2;
+				n = countRecordWords(dataLen, &carry);
+			}
+		} else if (fileType == RECORD_INDEX_SRECORD && line[0] == 'S' && line[1] >= '1' && line[1] <= '3' &&
+		    length >= 4 && parseHexDigits(line+2, 2, &dataLen) == 0) {
+			addressDigits = 2*(line[1] - '0' + 1);
+			if (length >= 4+addressDigits && parseHexDigits(line+4, addressDigits, &address) == 0 &&
+			    dataLen >= (uint32_t)addressDigits/2 + 1) {
+				firstWord = address/2;
+				n = countRecordWords(dataLen - addressDigits/2 - 1, &carry);
+			}
+		}
+
+		if (n > 0) {
+			if (firstWord < block.firstWord)
+				block.firstWord = firstWord;
+			if (firstWord + n-1 > block.lastWord)
+				block.lastWord = firstWord + n-1;
+		}
+	}
+	free(line);
+
+	if (ferror(fileIn))
+		return ERROR_FILE_READING_ERROR;
+	if (block.length > 0 && appendBlock(index, &block) < 0)
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+
+	return 0;
+}
+
+/* Reads an index file, returns 1 if it is missing or doesn't belong to
+ * the program file any more. The blocks are checked against the size of
+ * the index and of the program file, so a damaged index is rebuilt. */
+static int loadRecordIndex(recordIndex *index, const char *indexName, const recordIndexHeader *expected) {
+	struct stat indexStat;
+	FILE *fileIn;
+	size_t numBlocks, i;
+	int retVal;
+
+	fileIn = fopen(indexName, "rb");
+	if (fileIn == NULL)
+		return 1;
+
+	retVal = 1;
+	if (fstat(fileno(fileIn), &indexStat) == 0 && (size_t)indexStat.st_size >= sizeof(recordIndexHeader) &&
+	    fread(&index->header, sizeof(recordIndexHeader), 1, fileIn) == 1 &&
+	    memcmp(&index->header, expected, offsetof(recordIndexHeader, numBlocks)) == 0) {
+		numBlocks = index->header.numBlocks;
+		/* The blocks must fill the rest of the index exactly */
+		if (numBlocks != ((size_t)indexStat.st_size - sizeof(recordIndexHeader)) / sizeof(recordBlock) ||
+		    ((size_t)indexStat.st_size - sizeof(recordIndexHeader)) % sizeof(recordBlock) != 0 || numBlocks >= INT32_MAX) {
+			fclose(fileIn);
+			index->header.numBlocks = 0;
+			return 1;
+		}
+		index->blocks = malloc((numBlocks+1) * sizeof(recordBlock));
+		if (index->blocks == NULL)
+			retVal = ERROR_MEMORY_ALLOCATION_ERROR;
+		else if (fread(index->blocks, sizeof(recordBlock), numBlocks, fileIn) == numBlocks)
+			retVal = 0;
+		index->capacity = numBlocks+1;
+
+		/* The blocks must follow each other inside the program file, so
+		 * any run of them can be read in one piece */
+		for (i = 0; retVal == 0 && i < numBlocks; i++) {
+			if (index->blocks[i].offset != ((i > 0) ? index->blocks[i-1].offset + index->blocks[i-1].length : 0) ||
+			    index->blocks[i].offset > expected->fileSize ||
+			    index->blocks[i].length > expected->fileSize - index->blocks[i].offset)
+				retVal = 1;
+		}
+	}
+	fclose(fileIn);
+
+	if (retVal != 0) {
+		free(index->blocks);
+		index->blocks = NULL;
+		index->capacity = 0;
+		index->header.numBlocks = 0;
+	}
+	return retVal;
+}
+
+/* Writes an index file through a temporary file, so concurrent runs
+ * never read a partial index. */
+static int saveRecordIndex(const recordIndex *index, const char *indexName) {
+	char *tempName;
+	FILE *fileOut;
+	int failed;
+
+	if (asprintf(&tempName, "%s.tmp", indexName) < 0)
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	fileOut = fopen(tempName, "wb");
+	if (fileOut == NULL) {
+		free(tempName);
+		return ERROR_FILE_WRITING_ERROR;
+	}
+
+	failed = (fwrite(&index->header, sizeof(recordIndexHeader), 1, fileOut) != 1);
+	if (!failed && index->header.numBlocks > 0)
+		failed = (fwrite(index->blocks, sizeof(recordBlock), index->header.numBlocks, fileOut) != index->header.numBlocks);
+	if (fclose(fileOut) != 0)
+		failed = 1;
+	if (!failed && rename(tempName, indexName) < 0)
+		failed = 1;
+	if (failed)
+		remove(tempName);
+	free(tempName);
+
+	return failed ? ERROR_FILE_WRITING_ERROR : 0;
+}
+
+/* Reads the records of consecutive blocks into the program image. An
+ * extended address record in front of the Intel HEX records restores the
+ * upper address bits in effect at the first block. */
+static int readBlocks(programImage *image, FILE *fileIn, int fileType, const recordBlock *first, uint64_t length) {
+	char *buffer;
+	FILE *blockIn;
+	size_t prefixLength;
+	uint32_t value;
+	int type, retVal;
+
+	buffer = malloc(length + 16);
+	if (buffer == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for program image!\n");
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+
+	prefixLength = 0;
+	if (fileType == RECORD_INDEX_IHEX && first->addressOffset != 0) {
+		if ((first->addressOffset & 0xFFFF) == 0) {
+			type = 0x04;
+			value = first->addressOffset >> 16;
+		} else {
+			type = 0x02;
+			value = first->addressOffset >> 4;
+		}
+		prefixLength = sprintf(buffer, ":020000%02X%04X%02X\n", type, value,
+			(-(2 + type + (value >> 8) + (value & 0xFF))) & 0xFF);
+	}
+
+	if (fseek(fileIn, first->offset, SEEK_SET) < 0 || fread(buffer+prefixLength, 1, length, fileIn) != length) {
+		perror("Error: Cannot read program file");
+		free(buffer);
+		return ERROR_FILE_READING_ERROR;
+	}
+
+	blockIn = fmemopen(buffer, prefixLength+length, "r");
+	if (blockIn == NULL) {
+		perror("Error: Cannot read program file from memory");
+		free(buffer);
+		return ERROR_FILE_READING_ERROR;
+	}
+	if (fileType == RECORD_INDEX_IHEX)
+		retVal = readIHexFile(image, blockIn);
+	else
+		retVal = readSRecordFile(image, blockIn);
+	fclose(blockIn);
+	free(buffer);
+
+	return retVal;
+}
+
+/* Reads the words with an address from start to end of an Intel HEX or
+ * Motorola S-Record program file into the program image, seeking to the
+ * blocks of records that hold them with the index file next to it. The
+ * index is built first if it is missing, or if the size or modification
+ * time of the program file changed. Returns 1 without reading anything if
+ * the file can't be indexed, like standard input or a compressed file. */
+int readIndexedRange(programImage *image, const char *fileName, const char *fileType, uint32_t start, uint32_t end) {
+	recordIndexHeader expected;
+	recordIndex index;
+	struct stat fileStat;
+	char *indexName;
+	FILE *fileIn;
+	uint32_t i, j;
+	uint64_t length;
+	int c, type, retVal;
+
+	if (strcmp(fileName, "-") == 0)
+		return 1;
+	fileIn = fopen(fileName, "r");
+	if (fileIn == NULL) {
+		perror("Error: Cannot open program file for disassembly");
+		return ERROR_FILE_READING_ERROR;
+	}
+
+	/* Only plain record files can be seeked in */
+	c = fgetc(fileIn);
+	if (c == ':' && (fileType[0] == '\0' || strcasecmp(fileType, "ihex") == 0))
+		type = RECORD_INDEX_IHEX;
+	else if (c == 'S' && (fileType[0] == '\0' || strcasecmp(fileType, "srecord") == 0))
+		type = RECORD_INDEX_SRECORD;
+	else
+		type = -1;
+	if (type < 0 || fstat(fileno(fileIn), &fileStat) < 0 || !S_ISREG(fileStat.st_mode)) {
+		fclose(fileIn);
+		return 1;
+	}
+	rewind(fileIn);
+
+	memset(&expected, 0, sizeof(expected));
+	memcpy(expected.magic, RECORD_INDEX_MAGIC, sizeof(expected.magic));
+	expected.fileSize = fileStat.st_size;
+	expected.mtimeSeconds = fileStat.st_mtim.tv_sec;
+	expected.mtimeNanoseconds = fileStat.st_mtim.tv_nsec;
+	expected.fileType = type;
+
+	if (asprintf(&indexName, "%s%s", fileName, RECORD_INDEX_SUFFIX) < 0) {
+		fclose(fileIn);
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+
+	/* Build the index on first use, or if the program file changed */
+	memset(&index, 0, sizeof(index));
+	retVal = loadRecordIndex(&index, indexName, &expected);
+	if (retVal == 1) {
+		index.header = expected;
+		retVal = buildRecordIndex(&index, fileIn, type);
+		if (retVal == ERROR_MEMORY_ALLOCATION_ERROR)
+			fprintf(stderr, "Error allocating sufficient memory for the record index!\n");
+		else if (retVal < 0)
+			perror("Error: Cannot read program file");
+		else if (saveRecordIndex(&index, indexName) < 0)
+			fprintf(stderr, "Warning: Cannot write the record index %s.\n", indexName);
+	} else if (retVal < 0) {
+		fprintf(stderr, "Error allocating sufficient memory for the record index!\n");
+	}
+	free(indexName);
+
+	/* Read every run of consecutive blocks that hold words of the range */
+	for (i = 0; i < index.header.numBlocks && retVal == 0; i = j) {
+		if (index.blocks[i].firstWord > end || index.blocks[i].lastWord < start || index.blocks[i].firstWord > index.blocks[i].lastWord) {
+			j = i+1;
+			continue;
+		}
+		length = index.blocks[i].length;
+		for (j = i+1; j < index.header.numBlocks; j++) {
+			if (index.blocks[j].firstWord > end || index.blocks[j].lastWord < start || index.blocks[j].firstWord > index.blocks[j].lastWord)
+				break;
+			length += index.blocks[j].length;
+		}
+		retVal = readBlocks(image, fileIn, type, &index.blocks[i], length);
+	}
+
+	free(index.blocks);
+	fclose(fileIn);
+	if (retVal < 0)
+		return retVal;
+
+	selectProgramImageRange(image, start, end);
+	return 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * recordindex.h - Header file for the sidecar record offset index of
+ *  program files, which lets an address range be read without parsing
+ *  the whole file.
+ *
+ */
+
+#ifndef RECORDINDEX_DISASM_H
+#define RECORDINDEX_DISASM_H
+
+#include <stdint.h>
+#include "image.h"
+
+/* Suffix of the index file next to a program file */
+#define RECORD_INDEX_SUFFIX		".idx"
+
+/* Number of bytes of records after which a new block of the index starts */
+#define RECORD_INDEX_BLOCK_SIZE		4096
+
+/* Reads the words with an address from start to end of an Intel HEX or
+ * Motorola S-Record program file into the program image, seeking to the
+ * blocks of records that hold them with the index file next to it. The
+ * index is built first if it is missing, or if the size or modification
+ * time of the program file changed. Returns 1 without reading anything if
+ * the file can't be indexed, like standard input or a compressed file. */
+int readIndexedRange(programImage *image, const char *fileName, const char *fileType, uint32_t start, uint32_t end);
+
+#endif
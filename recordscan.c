@@ -0,0 +1,344 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * recordscan.c - Record scanner for Intel HEX and Motorola S-Record files
+ *  in memory. Unlike the libGIS readers it keeps track of line numbers and
+ *  byte offsets, and skips malformed records instead of stopping, so all
+ *  of the errors of a file can be reported at once.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include "pic_disasm.h"
+#include "errorcodes.h"
+#include "profile.h"
+#include "recordscan.h"
+
+/* Value of every hex digit character, -1 for the other characters */
+static signed char hexValues[256];
+static int hexValuesReady = 0;
+
+static void initHexValues(void) {
+	int i;
+
+	for (i = 0; i < 256; i++)
+		hexValues[i] = -1;
+	for (i = 0; i < 10; i++)
+		hexValues['0'+i] = i;
+	for (i = 0; i < 6; i++) {
+		hexValues['A'+i] = 10+i;
+		hexValues['a'+i] = 10+i;
+	}
+	hexValuesReady = 1;
+}
+
+/* Starts a scan through the records of a file in memory. fileType is
+ * "ihex", "srecord", or empty to recognize the file type by its first
+ * character. Returns a negative error code if it can't be recognized. */
+int initRecordScanner(recordScanner *scanner, const char *data, size_t size, const char *fileType, const char *fileName, FILE *errorOut) {
+	if (!hexValuesReady)
+		initHexValues();
+
+	memset(scanner, 0, sizeof(recordScanner));
+	scanner->data = data;
+	scanner->size = size;
+	scanner->line = 1;
+	scanner->fileName = fileName;
+	scanner->errorOut = errorOut;
+
+	if (strcasecmp(fileType, "ihex") == 0 || (fileType[0] == '\0' && size > 0 && data[0] == ':'))
+		scanner->fileType = RECORD_SCAN_IHEX;
+	else if (strcasecmp(fileType, "srecord") == 0 || (fileType[0] == '\0' && size > 0 && data[0] == 'S'))
+		scanner->fileType = RECORD_SCAN_SRECORD;
+	else
+		return ERROR_INVALID_ARGUMENTS;
+
+	return 0;
+}
+
+/* Reports and counts an error at a record. */
+void reportRecordError(recordScanner *scanner, long line, size_t offset, const char *format, ...) {
+	va_list args;
+
+	scanner->numErrors++;
+	fprintf(scanner->errorOut, "%s:%ld: (byte %zu) ", scanner->fileName, line, offset);
+	va_start(args, format);
+	vfprintf(scanner->errorOut, format, args);
+	va_end(args);
+	fputc('\n', scanner->errorOut);
+}
+
+/* Decodes n bytes of hex digit pairs, returns -1 if there is a character
+ * that isn't a hex digit. */
+static int decodeHexBytes(const char *text, int n, uint8_t *bytes) {
+	const unsigned char *p = (const unsigned char *)text;
+	int i, high, low;
+
+	for (i = 0; i < n; i++) {
+		high = hexValues[p[2*i]];
+		low = hexValues[p[2*i+1]];
+		if ((high | low) < 0)
+			return -1;
+		bytes[i] = (high << 4) | low;
+	}
+	return 0;
+}
+
+/* Parses an Intel HEX record of length characters, returns an error
+ * message or NULL. */
+static const char *parseIHexRecord(const char *text, size_t length, scannedRecord *record) {
+	uint8_t bytes[1+2+1+255+1];
+	unsigned int sum;
+	int i, n;
+
+	if (text[0] != ':')
+		return "record doesn't start with ':'";
+	if (length < 11)
+		return "record is too short";
+	if ((length-1) % 2 != 0 || length > 1 + 2*sizeof(bytes))
+		return "record length doesn't match its byte count";
+	n = (length-1)/2;
+	if (decodeHexBytes(text+1, n, bytes) < 0)
+		return "record holds a character that isn't a hex digit";
+	if (bytes[0] != n-5)
+		return "record length doesn't match its byte count";
+	for (i = 0, sum = 0; i < n; i++)
+		sum += bytes[i];
+	if ((sum & 0xFF) != 0)
+		return "record checksum mismatch";
+	if (bytes[3] > 5)
+		return "unknown record type";
+
+	record->type = bytes[3];
+	record->address = ((uint32_t)bytes[1] << 8) | bytes[2];
+	record->dataLen = bytes[0];
+	memcpy(record->data, bytes+4, record->dataLen);
+	return NULL;
+}
+
+/* Parses a Motorola S-Record record of length characters, returns an
+ * error message or NULL. */
+static const char *parseSRecord(const char *text, size_t length, scannedRecord *record) {
+	/* Address length of each record type, 0 for the reserved S4 */
+	static const int addressLengths[10] = {2, 2, 3, 4, 0, 2, 3, 4, 3, 2};
+	uint8_t bytes[1+255];
+	unsigned int sum;
+	int i, n, type, addressLen;
+
+	if (text[0] != 'S')
+		return "record doesn't start with 'S'";
+	if (length < 4)
+		return "record is too short";
+	if (text[1] < '0' || text[1] > '9' || addressLengths[text[1]-'0'] == 0)
+		return "unknown record type";
+	type = text[1]-'0';
+	addressLen = addressLengths[type];
+	if ((length-2) % 2 != 0 || length > 2 + 2*sizeof(bytes))
+		return "record length doesn't match its byte count";
+	n = (length-2)/2;
+	if (decodeHexBytes(text+2, n, bytes) < 0)
+		return "record holds a character that isn't a hex digit";
+	if (bytes[0] != n-1 || n-2 < addressLen)
+		return "record length doesn't match its byte count";
+	for (i = 0, sum = 0; i < n; i++)
+		sum += bytes[i];
+	if ((sum & 0xFF) != 0xFF)
+		return "record checksum mismatch";
+
+	record->type = type;
+	record->address = 0;
+	for (i = 0; i < addressLen; i++)
+		record->address = (record->address << 8) | bytes[1+i];
+	record->dataLen = n-2-addressLen;
+	memcpy(record->data, bytes+1+addressLen, record->dataLen);
+	return NULL;
+}
+
+/* Reads the next well formed record. Every malformed record is reported
+ * with its line number and byte offset, and the scan goes on at the next
+ * record start code. Returns 1 for a record, or 0 at the end of the file. */
+int nextScannedRecord(recordScanner *scanner, scannedRecord *record) {
+	const char *data = scanner->data;
+	const char *newline, *next, *message;
+	size_t start, end;
+	char startCode;
+
+	startCode = (scanner->fileType == RECORD_SCAN_IHEX) ? ':' : 'S';
+
+	while (1) {
+		/* Skip the empty lines */
+		while (scanner->position < scanner->size && (data[scanner->position] == '\r' || data[scanner->position] == '\n')) {
+			if (data[scanner->position] == '\n')
+				scanner->line++;
+			scanner->position++;
+		}
+		if (scanner->position >= scanner->size)
+			return 0;
+
+		start = scanner->position;
+		newline = memchr(data+start, '\n', scanner->size-start);
+		end = (newline != NULL) ? (size_t)(newline-data) : scanner->size;
+		if (end > start && data[end-1] == '\r')
+			end--;
+
+		if (scanner->fileType == RECORD_SCAN_IHEX)
+			message = parseIHexRecord(data+start, end-start, record);
+		else
+			message = parseSRecord(data+start, end-start, record);
+		if (message == NULL) {
+			record->line = scanner->line;
+			record->offset = start;
+			scanner->position = end;
+			scanner->numRecords++;
+			return 1;
+		}
+
+		/* Go on at the next start code on the line, which can't be part
+		 * of a record, or else at the next line */
+		reportRecordError(scanner, scanner->line, start, "%s", message);
+		next = memchr(data+start+1, startCode, end-start-1);
+		scanner->position = (next != NULL) ? (size_t)(next-data) : end;
+	}
+}
+
+/* Sets the extended address of an Intel HEX extended address record, and
+ * finds the byte address of a data record. Returns 1 for a data record. */
+static int scannedDataAddress(recordScanner *scanner, const scannedRecord *record, uint32_t *byteAddress) {
+	if (scanner->fileType == RECORD_SCAN_SRECORD) {
+		*byteAddress = record->address;
+		return (record->type >= 1 && record->type <= 3);
+	}
+
+	if (record->type == 0x02 || record->type == 0x04) {
+		if (record->dataLen != 2)
+			reportRecordError(scanner, record->line, record->offset, "extended address record without 2 data bytes");
+		else if (record->type == 0x02)
+			scanner->addressOffset = (((uint32_t)record->data[0] << 8) | record->data[1]) << 4;
+		else
+			scanner->addressOffset = (((uint32_t)record->data[0] << 8) | record->data[1]) << 16;
+	}
+	*byteAddress = scanner->addressOffset + record->address;
+	return (record->type == 0x00);
+}
+
+/* Pairs up the bytes of a data record into words the way the readers do,
+ * carrying the last byte of an odd length record over to the next one.
+ * Reports the bytes that can't be paired. Returns the number of words. */
+static int pairScannedWords(recordScanner *scanner, const scannedRecord *record, uint16_t *words) {
+	int i, numWords;
+
+	numWords = 0;
+	for (i = 0; i < record->dataLen; i += 2) {
+		if (i+1 >= record->dataLen) {
+			if (record->dataLen % 2 == 0) {
+				reportRecordError(scanner, record->line, record->offset, "byte left over from the previous record can't be paired");
+				scanner->numAlignmentErrors++;
+				scanner->carry = 0;
+			} else {
+				if (scanner->carry) {
+					reportRecordError(scanner, record->line, record->offset, "byte left over from the previous record is dropped");
+					scanner->numAlignmentErrors++;
+				}
+				scanner->carry = 1;
+				scanner->carriedByte = record->data[i];
+			}
+			break;
+		}
+		if (scanner->carry) {
+			words[numWords++] = ((uint16_t)record->data[i] << 8) | scanner->carriedByte;
+			scanner->carry = 0;
+			i--;
+		} else {
+			words[numWords++] = ((uint16_t)record->data[i+1] << 8) | record->data[i];
+		}
+	}
+	return numWords;
+}
+
+/* Checks every record of the scan, and that the data records hold whole
+ * words at word addresses that fit the core of the architecture, without
+ * decoding anything. Prints every error and a summary line to the error
+ * output of the scanner. Returns the number of errors. */
+long validateRecords(recordScanner *scanner, int archSelect) {
+	scannedRecord record;
+	uint32_t byteAddress, wordMask;
+	uint16_t words[128];
+	int i, numWords;
+
+	/* Baseline instructions are 12 bits wide, the others 14 bits */
+	wordMask = (archSelect == PIC_BASELINE) ? 0xF000 : 0xC000;
+
+	while (nextScannedRecord(scanner, &record) == 1) {
+		if (!scannedDataAddress(scanner, &record, &byteAddress))
+			continue;
+
+		if (!scanner->carry && byteAddress % 2 != 0)
+			reportRecordError(scanner, record.line, record.offset, "data record at odd byte address 0x%X", byteAddress);
+
+		numWords = pairScannedWords(scanner, &record, words);
+		for (i = 0; i < numWords; i++) {
+			if ((words[i] & wordMask) != 0) {
+				reportRecordError(scanner, record.line, record.offset, "word 0x%04X is wider than the %d-bit core",
+					words[i], (archSelect == PIC_BASELINE) ? 12 : 14);
+				break;
+			}
+		}
+	}
+
+	fprintf(scanner->errorOut, "%s: %ld records, %ld errors\n", scanner->fileName, scanner->numRecords, scanner->numErrors);
+	return scanner->numErrors;
+}
+
+/* Reads the words of every well formed record of the scan into the program
+ * image, like readIHexFile() and readSRecordFile(), but skips the malformed
+ * records and the bytes that can't be paired into words instead of
+ * stopping. Prints every error and a summary line to the error output of
+ * the scanner. Returns a negative error code if it runs out of memory. */
+int readScannedRecords(recordScanner *scanner, programImage *image) {
+	scannedRecord record;
+	uint32_t byteAddress;
+	uint16_t words[128];
+	int i, numWords, previousStage;
+	int retVal = 0;
+
+	previousStage = PROFILE_SWITCH(PROFILE_STAGE_PARSE);
+	while (retVal == 0 && nextScannedRecord(scanner, &record) == 1) {
+		PROFILE_COUNT(PROFILE_COUNTER_RECORDS, 1);
+		if (!scannedDataAddress(scanner, &record, &byteAddress))
+			continue;
+
+		numWords = pairScannedWords(scanner, &record, words);
+		for (i = 0; i < numWords; i++) {
+			if (appendProgramImage(image, byteAddress/2 + i, words[i]) < 0) {
+				fprintf(stderr, "Error allocating sufficient memory for program image!\n");
+				retVal = ERROR_MEMORY_ALLOCATION_ERROR;
+				break;
+			}
+		}
+	}
+	PROFILE_SWITCH(previousStage);
+
+	fprintf(scanner->errorOut, "%s: %ld records read, %ld bad records skipped, %ld alignment errors\n", scanner->fileName,
+		scanner->numRecords, scanner->numErrors - scanner->numAlignmentErrors, scanner->numAlignmentErrors);
+	return retVal;
+}
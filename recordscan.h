@@ -0,0 +1,99 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * recordscan.h - Header file for the record scanner, which reads the
+ *  records of an Intel HEX or Motorola S-Record file from memory, reports
+ *  every malformed record and goes on with the next one.
+ *
+ */
+
+#ifndef RECORDSCAN_DISASM_H
+#define RECORDSCAN_DISASM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "image.h"
+
+/* Enumeration for the file types of the record scanner */
+enum {
+	RECORD_SCAN_IHEX,
+	RECORD_SCAN_SRECORD,
+};
+
+/* Structure to hold a well formed record. The address is the address
+ * field of the record, without Intel HEX extended addresses. */
+struct _scannedRecord {
+	int type;
+	uint32_t address;
+	uint8_t data[256];
+	int dataLen;
+	/* Line number and byte offset of the start code in the file */
+	long line;
+	size_t offset;
+};
+typedef struct _scannedRecord scannedRecord;
+
+/* Structure to hold the state of a scan through a file in memory */
+struct _recordScanner {
+	const char *data;
+	size_t size, position;
+	long line;
+	int fileType;
+	/* Errors are printed to errorOut, prefixed with the file name */
+	const char *fileName;
+	FILE *errorOut;
+	long numRecords, numErrors;
+	/* Decoding state of the data records: the Intel HEX extended address,
+	 * the byte carried over from an odd length record, and the number of
+	 * bytes that couldn't be paired into words */
+	uint32_t addressOffset;
+	int carry;
+	uint8_t carriedByte;
+	long numAlignmentErrors;
+};
+typedef struct _recordScanner recordScanner;
+
+/* Starts a scan through the records of a file in memory. fileType is
+ * "ihex", "srecord", or empty to recognize the file type by its first
+ * character. Returns a negative error code if it can't be recognized. */
+int initRecordScanner(recordScanner *scanner, const char *data, size_t size, const char *fileType, const char *fileName, FILE *errorOut);
+
+/* Reads the next well formed record. Every malformed record is reported
+ * with its line number and byte offset, and the scan goes on at the next
+ * record start code. Returns 1 for a record, or 0 at the end of the file. */
+int nextScannedRecord(recordScanner *scanner, scannedRecord *record);
+
+/* Reports and counts an error at a record. */
+void reportRecordError(recordScanner *scanner, long line, size_t offset, const char *format, ...);
+
+/* Checks every record of the scan, and that the data records hold whole
+ * words at word addresses that fit the core of the architecture, without
+ * decoding anything. Prints every error and a summary line to the error
+ * output of the scanner. Returns the number of errors. */
+long validateRecords(recordScanner *scanner, int archSelect);
+
+/* Reads the words of every well formed record of the scan into the program
+ * image, like readIHexFile() and readSRecordFile(), but skips the malformed
+ * records and the bytes that can't be paired into words instead of
+ * stopping. Prints every error and a summary line to the error output of
+ * the scanner. Returns a negative error code if it runs out of memory. */
+int readScannedRecords(recordScanner *scanner, programImage *image);
+
+#endif
@@ -0,0 +1,347 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * search.c - Masked instruction pattern search over the raw instruction
+ *  words of program images, without disassembling them.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "pic_disasm.h"
+#include "format.h"
+#include "image.h"
+#include "search.h"
+#include "errorcodes.h"
+
+extern instructionSetInfo allInstructionSets[];
+
+/* Longest instruction accepted in a search pattern */
+#define SEARCH_MAX_ELEMENT_LENGTH	128
+
+/* Compiles a single instruction of a search pattern. */
+static int compileElement(char *element, int archSelect, uint16_t *mask, uint16_t *value);
+/* Places the bits of data into the bit positions set in mask, the inverse
+ * of extractDataFromMask() in pic_disasm.c. */
+static uint16_t insertDataIntoMask(uint16_t data, uint16_t mask);
+/* Returns the index of the first word at or after start matching the
+ * mask and value pair, or numWords if there is none. */
+static int findCandidate(const uint16_t *words, int start, int numWords, uint16_t mask, uint16_t value);
+/* Removes leading and trailing whitespace from a string, in place. */
+static char *trimWhitespace(char *s);
+
+/* Comparison for sorting the instructions by address, keeping the
+ * original file order of instructions with the same address. */
+static int compareAddress(const void *a, const void *b) {
+	const assembledInstruction *x = *(const assembledInstruction **)a;
+	const assembledInstruction *y = *(const assembledInstruction **)b;
+
+	if (x->address != y->address)
+		return (x->address < y->address) ? -1 : 1;
+	return (x < y) ? -1 : (x > y);
+}
+
+/* Compiles a pattern of instructions separated by semicolons, such as
+ * "movlw *; movwf 0x0B; bsf *, 7", into per instruction mask and value
+ * pairs. Each instruction is a mnemonic with optional operands, where *
+ * or a left out operand matches any value, a value/mask pair such as
+ * 0x0080/0x3F80, a single opcode word, or * to match any word. */
+int compileSearchPattern(searchPattern *pattern, const char *patternText, int archSelect) {
+	char element[SEARCH_MAX_ELEMENT_LENGTH];
+	const char *p, *end;
+	size_t length;
+	int retVal;
+
+	if (pattern == NULL || patternText == NULL)
+		return ERROR_INVALID_ARGUMENTS;
+	if (archSelect < PIC_BASELINE || archSelect > PIC_PIC18)
+		return ERROR_INVALID_ARGUMENTS;
+
+	pattern->length = 0;
+	for (p = patternText; ; p = end+1) {
+		end = strchr(p, ';');
+		length = (end != NULL) ? (size_t)(end-p) : strlen(p);
+		if (length >= sizeof(element)) {
+			fprintf(stderr, "Search pattern instruction is too long!\n");
+			return ERROR_INVALID_ARGUMENTS;
+		}
+		memcpy(element, p, length);
+		element[length] = '\0';
+
+		/* Allow a trailing semicolon */
+		if (trimWhitespace(element)[0] == '\0' && end == NULL && pattern->length > 0)
+			break;
+		if (pattern->length == SEARCH_MAX_PATTERN_LENGTH) {
+			fprintf(stderr, "Search pattern is longer than %d instructions!\n", SEARCH_MAX_PATTERN_LENGTH);
+			return ERROR_INVALID_ARGUMENTS;
+		}
+
+		retVal = compileElement(trimWhitespace(element), archSelect, &pattern->masks[pattern->length], &pattern->values[pattern->length]);
+		if (retVal < 0) {
+			fprintf(stderr, "Invalid search pattern instruction \"%.*s\"!\n", (int)length, p);
+			return retVal;
+		}
+		pattern->length++;
+
+		if (end == NULL)
+			break;
+	}
+
+	return 0;
+}
+
+/* Searches the instruction words of a program image for runs of
+ * consecutive addresses matching the pattern, and prints the address of
+ * every match prefixed with the image name. Returns the number of
+ * matches, or a negative error code. */
+int searchProgramImage(FILE *fileOut, const char *imageName, const programImage *image, const searchPattern *pattern, formattingOptions fOptions) {
+	const assembledInstruction **sorted;
+	uint32_t *addresses;
+	uint16_t *words;
+	int numWords, numMatches, i, j, k;
+
+	if (image == NULL || pattern == NULL || pattern->length == 0)
+		return ERROR_INVALID_ARGUMENTS;
+
+	/* Lay the instruction words out by address, so the pattern can be
+	 * matched against a flat array. Where an address appears more than
+	 * once the last one read from the file is the one that counts. */
+	sorted = malloc((image->numInstructions+1)*sizeof(assembledInstruction *));
+	addresses = malloc((image->numInstructions+1)*sizeof(uint32_t));
+	words = malloc((image->numInstructions+4)*sizeof(uint16_t));
+	if (sorted == NULL || addresses == NULL || words == NULL) {
+		free(sorted);
+		free(addresses);
+		free(words);
+		fprintf(stderr, "Error allocating sufficient memory for search!\n");
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+	for (i = 0; i < image->numInstructions; i++)
+		sorted[i] = &image->instructions[i];
+	qsort(sorted, image->numInstructions, sizeof(assembledInstruction *), compareAddress);
+	for (i = 0, numWords = 0; i < image->numInstructions; i++) {
+		if (i+1 < image->numInstructions && sorted[i+1]->address == sorted[i]->address)
+			continue;
+		addresses[numWords] = sorted[i]->address;
+		words[numWords] = sorted[i]->opcode;
+		numWords++;
+	}
+	free(sorted);
+
+	/* Find the candidates for the first instruction of the pattern with
+	 * the fast filter, then check the rest of the pattern in place. */
+	numMatches = 0;
+	for (i = 0; i+pattern->length <= numWords; i++) {
+		i = findCandidate(words, i, numWords-pattern->length+1, pattern->masks[0], pattern->values[0]);
+		if (i+pattern->length > numWords)
+			break;
+
+		for (k = 1, j = i+1; k < pattern->length; k++, j++) {
+			if (addresses[j] != addresses[i]+k || (words[j] & pattern->masks[k]) != pattern->values[k])
+				break;
+		}
+		if (k < pattern->length)
+			continue;
+
+		if (fprintf(fileOut, "%s:%0*X\n", imageName, fOptions.addressFieldWidth, addresses[i]) < 0) {
+			fprintf(stderr, "Error writing search results to file!\n");
+			free(addresses);
+			free(words);
+			return ERROR_FILE_WRITING_ERROR;
+		}
+		numMatches++;
+	}
+
+	free(addresses);
+	free(words);
+
+	return numMatches;
+}
+
+/* Compiles a single instruction of a search pattern. */
+static int compileElement(char *element, int archSelect, uint16_t *mask, uint16_t *value) {
+	instructionInfo *instructionSet = allInstructionSets[archSelect].instructionSet;
+	char *operandText, *next, *end;
+	uint16_t wordMask, operandMask;
+	long operand;
+	int i, j, k, bits, signedOperand;
+
+	switch (archSelect) {
+		case PIC_BASELINE:
+			wordMask = 0x0FFF;
+			break;
+		case PIC_PIC18:
+			wordMask = 0xFFFF;
+			break;
+		default:
+			wordMask = 0x3FFF;
+			break;
+	}
+
+	/* Any word */
+	if (strcmp(element, "*") == 0) {
+		*mask = *value = 0;
+		return 0;
+	}
+
+	/* An opcode word, or an opcode value and mask pair */
+	if (isdigit((unsigned char)element[0])) {
+		*value = strtoul(element, &end, 0);
+		*mask = wordMask;
+		if (*end == '/')
+			*mask = strtoul(end+1, &end, 0);
+		if (*trimWhitespace(end) != '\0')
+			return ERROR_INVALID_ARGUMENTS;
+		*value &= *mask;
+		return 0;
+	}
+
+	/* A mnemonic, with the first instruction of that name, leaving out the
+	 * "data" pseudo-instruction at the end of the instruction set */
+	for (operandText = element; *operandText != '\0' && !isspace((unsigned char)*operandText); operandText++)
+		;
+	if (*operandText != '\0')
+		*operandText++ = '\0';
+	for (i = 0; i < allInstructionSets[archSelect].numInstructions-1; i++) {
+		if (strcasecmp(instructionSet[i].mnemonic, element) == 0)
+			break;
+	}
+	if (i == allInstructionSets[archSelect].numInstructions-1)
+		return ERROR_INVALID_ARGUMENTS;
+
+	/* Match the opcode bits, along with any operand that is given */
+	*mask = wordMask;
+	for (k = 0; k < PIC_MAX_NUM_OPERANDS; k++)
+		*mask &= ~instructionSet[i].operandMasks[k];
+	*value = instructionSet[i].opcodeMask & *mask;
+
+	operandText = trimWhitespace(operandText);
+	for (k = 0; *operandText != '\0'; k++, operandText = next) {
+		next = strchr(operandText, ',');
+		if (next != NULL)
+			*next++ = '\0';
+		else
+			next = operandText + strlen(operandText);
+		operandText = trimWhitespace(operandText);
+
+		if (k >= instructionSet[i].numOperands)
+			return ERROR_INVALID_ARGUMENTS;
+		if (strcmp(operandText, "*") == 0)
+			continue;
+
+		operandMask = instructionSet[i].operandMasks[k];
+		if (instructionSet[i].operandTypes[k] == OPERAND_REGISTER_DEST && strcasecmp(operandText, "W") == 0) {
+			operand = 0;
+		} else if (instructionSet[i].operandTypes[k] == OPERAND_REGISTER_DEST && strcasecmp(operandText, "F") == 0) {
+			operand = 1;
+		} else {
+			operand = strtol(operandText, &end, 0);
+			if (end == operandText || *end != '\0')
+				return ERROR_INVALID_ARGUMENTS;
+		}
+
+		/* Check that the operand fits its field. Register operands
+		 * may be given as full banked addresses, of which only the
+		 * offset into the bank is encoded. */
+		bits = 0;
+		for (j = 0; j < 16; j++) {
+			if (operandMask & (1 << j))
+				bits++;
+		}
+		signedOperand = (instructionSet[i].operandTypes[k] == OPERAND_RELATIVE_ADDRESS ||
+				 instructionSet[i].operandTypes[k] == OPERAND_SIGNED_LITERAL);
+		if (instructionSet[i].operandTypes[k] == OPERAND_REGISTER)
+			operand &= (1L << bits) - 1;
+		else if (signedOperand && (operand < -(1L << (bits-1)) || operand >= (1L << (bits-1))))
+			return ERROR_INVALID_ARGUMENTS;
+		else if (!signedOperand && (operand < 0 || operand >= (1L << bits)))
+			return ERROR_INVALID_ARGUMENTS;
+
+		*mask |= operandMask;
+		*value |= insertDataIntoMask((uint16_t)operand, operandMask);
+	}
+
+	return 0;
+}
+
+/* Places the bits of data into the bit positions set in mask, the inverse
+ * of extractDataFromMask() in pic_disasm.c. */
+static uint16_t insertDataIntoMask(uint16_t data, uint16_t mask) {
+	int i, j;
+	uint16_t result = 0;
+
+	/* i counts through every bit of the mask,
+	 * j counts through every bit of the data we're copying in. */
+	for (i = 0, j = 0; i < 16; i++) {
+		if (mask & (1<<i)) {
+			if (data & (1<<j))
+				result |= (1<<i);
+			j++;
+		}
+	}
+
+	return result;
+}
+
+/* Returns the index of the first word at or after start matching the
+ * mask and value pair, or numWords if there is none. Four words are
+ * tested at a time in the lanes of a 64-bit integer: a lane of the masked
+ * and compared words is zero only on a match, and the lane's top bit is
+ * set in "zero" exactly then. Instruction words never use bit 15 of a
+ * lane except on PIC18, where the lanes are tested one by one. */
+static int findCandidate(const uint16_t *words, int start, int numWords, uint16_t mask, uint16_t value) {
+	const uint64_t lowBits = 0x7FFF7FFF7FFF7FFFULL;
+	uint64_t mask4, value4, block, diff, zero;
+	int i = start;
+
+	if ((mask & 0x8000) == 0) {
+		mask4 = (uint64_t)mask * 0x0001000100010001ULL;
+		value4 = (uint64_t)value * 0x0001000100010001ULL;
+		for (; i+4 <= numWords; i += 4) {
+			memcpy(&block, &words[i], sizeof(block));
+			diff = (block & mask4) ^ value4;
+			zero = ~(((diff & lowBits) + lowBits) | diff | lowBits);
+			if (zero != 0)
+				break;
+		}
+	}
+
+	for (; i < numWords; i++) {
+		if ((words[i] & mask) == value)
+			return i;
+	}
+
+	return numWords;
+}
+
+/* Removes leading and trailing whitespace from a string, in place. */
+static char *trimWhitespace(char *s) {
+	char *end;
+
+	while (isspace((unsigned char)*s))
+		s++;
+	for (end = s + strlen(s); end > s && isspace((unsigned char)end[-1]); end--)
+		;
+	*end = '\0';
+
+	return s;
+}
+
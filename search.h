@@ -0,0 +1,58 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * search.h - Header file for the masked instruction pattern search.
+ *
+ */
+
+#ifndef SEARCH_DISASM_H
+#define SEARCH_DISASM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "format.h"
+#include "image.h"
+
+/* Maximum number of instructions in a search pattern */
+#define SEARCH_MAX_PATTERN_LENGTH	64
+
+/* Structure to hold a compiled search pattern: the instruction word at
+ * position i of a match must satisfy (word & masks[i]) == values[i]. */
+struct _searchPattern {
+	uint16_t masks[SEARCH_MAX_PATTERN_LENGTH];
+	uint16_t values[SEARCH_MAX_PATTERN_LENGTH];
+	int length;
+};
+typedef struct _searchPattern searchPattern;
+
+/* Compiles a pattern of instructions separated by semicolons, such as
+ * "movlw *; movwf 0x0B; bsf *, 7", into per instruction mask and value
+ * pairs. Each instruction is a mnemonic with optional operands, where *
+ * or a left out operand matches any value, a value/mask pair such as
+ * 0x0080/0x3F80, a single opcode word, or * to match any word. */
+int compileSearchPattern(searchPattern *pattern, const char *patternText, int archSelect);
+
+/* Searches the instruction words of a program image for runs of
+ * consecutive addresses matching the pattern, and prints the address of
+ * every match prefixed with the image name. Returns the number of
+ * matches, or a negative error code. */
+int searchProgramImage(FILE *fileOut, const char *imageName, const programImage *image, const searchPattern *pattern, formattingOptions fOptions);
+
+#endif
+
@@ -0,0 +1,445 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * signature.c - Identification of known library functions, such as the
+ *  compiler's multiply and divide helpers, by their masked instruction
+ *  signatures. Signatures are compiled from a source file into a compact
+ *  on-disk index that is searched with a hash of the first instructions
+ *  of every function candidate.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "pic_disasm.h"
+#include "pic_analysis.h"
+#include "search.h"
+#include "signature.h"
+#include "errorcodes.h"
+
+extern instructionSetInfo allInstructionSets[];
+
+/* Layout of the on-disk index */
+#define SIGNATURE_MAGIC			"vPSG"
+#define SIGNATURE_HEADER_SIZE		16
+#define SIGNATURE_ENTRY_SIZE		16
+#define SIGNATURE_WORD_SIZE		4
+
+/* Longest line accepted in a signature database source file */
+#define SIGNATURE_MAX_LINE_LENGTH	1024
+
+/* Structure for a signature while the database is being built */
+struct _signatureSource {
+	uint32_t key;
+	int archSelect;
+	int length;
+	uint32_t firstWord;
+	uint32_t nameOffset;
+};
+typedef struct _signatureSource signatureSource;
+
+/* Computes the key of a function from the instruction set indices of its
+ * first SIGNATURE_KEY_LENGTH instructions. */
+static uint32_t signatureKey(int archSelect, const int *instructionIndices);
+/* Returns the index of an opcode's instruction in the instruction set. */
+static int instructionIndex(uint16_t opcode, int archSelect);
+/* Grows an array to hold at least needed elements. */
+static int growArray(void **array, int *capacity, int needed, size_t elementSize);
+
+/* Little endian access to the on-disk index */
+static uint32_t getLE32(const unsigned char *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static uint16_t getLE16(const unsigned char *p) {
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+static int putLE32(FILE *fileOut, uint32_t data) {
+	unsigned char p[4];
+	p[0] = data & 0xFF;
+	p[1] = (data >> 8) & 0xFF;
+	p[2] = (data >> 16) & 0xFF;
+	p[3] = (data >> 24) & 0xFF;
+	return (fwrite(p, 1, 4, fileOut) == 4) ? 0 : ERROR_FILE_WRITING_ERROR;
+}
+static int putLE16(FILE *fileOut, uint16_t data) {
+	unsigned char p[2];
+	p[0] = data & 0xFF;
+	p[1] = (data >> 8) & 0xFF;
+	return (fwrite(p, 1, 2, fileOut) == 2) ? 0 : ERROR_FILE_WRITING_ERROR;
+}
+
+/* Comparison for sorting the signatures by key, and the longest first
+ * among signatures with the same key, so the most specific match wins. */
+static int compareSignatures(const void *a, const void *b) {
+	const signatureSource *x = (const signatureSource *)a;
+	const signatureSource *y = (const signatureSource *)b;
+
+	if (x->key != y->key)
+		return (x->key < y->key) ? -1 : 1;
+	return y->length - x->length;
+}
+
+/* Compiles a signature database source file, with one function per line
+ * in the form "<architecture> <name> <pattern>" where the pattern is in
+ * the --search syntax, into the on-disk index. */
+int buildSignatureDatabase(FILE *fileOut, FILE *fileIn) {
+	char line[SIGNATURE_MAX_LINE_LENGTH];
+	char *arch, *name, *patternText, *p;
+	signatureSource *signatures = NULL;
+	uint16_t *masks = NULL, *values = NULL;
+	char *names = NULL;
+	int numSignatures = 0, signaturesCapacity = 0;
+	int numWords = 0, wordsCapacity = 0, masksCapacity = 0;
+	int namesSize = 0, namesCapacity = 0;
+	int indices[SIGNATURE_KEY_LENGTH];
+	searchPattern pattern;
+	signatureSource *signature;
+	uint16_t wordMask, opcodeBits;
+	int lineNumber = 0, archSelect, i, k, retVal = 0;
+
+	while (fgets(line, sizeof(line), fileIn) != NULL) {
+		lineNumber++;
+		if ((p = strchr(line, '#')) != NULL)
+			*p = '\0';
+
+		/* Split off the architecture and function name */
+		arch = strtok(line, " \t\r\n");
+		if (arch == NULL)
+			continue;
+		name = strtok(NULL, " \t\r\n");
+		patternText = strtok(NULL, "\r\n");
+		if (name == NULL || patternText == NULL) {
+			fprintf(stderr, "Signature source line %d: expected <architecture> <name> <pattern>!\n", lineNumber);
+			retVal = ERROR_INVALID_ARGUMENTS;
+			goto cleanup;
+		}
+
+		if (strcasecmp(arch, "baseline") == 0)
+			archSelect = PIC_BASELINE;
+		else if (strcasecmp(arch, "midrange") == 0)
+			archSelect = PIC_MIDRANGE;
+		else if (strcasecmp(arch, "enhanced") == 0)
+			archSelect = PIC_MIDRANGE_ENHANCED;
+		else {
+			fprintf(stderr, "Signature source line %d: unknown architecture %s!\n", lineNumber, arch);
+			retVal = ERROR_INVALID_ARGUMENTS;
+			goto cleanup;
+		}
+		wordMask = (archSelect == PIC_BASELINE) ? 0x0FFF : 0x3FFF;
+
+		retVal = compileSearchPattern(&pattern, patternText, archSelect);
+		if (retVal == 0 && pattern.length < SIGNATURE_KEY_LENGTH) {
+			fprintf(stderr, "Signature is shorter than %d instructions!\n", SIGNATURE_KEY_LENGTH);
+			retVal = ERROR_INVALID_ARGUMENTS;
+		}
+		/* The instructions hashed into the key must be known */
+		for (k = 0; k < SIGNATURE_KEY_LENGTH && retVal == 0; k++) {
+			indices[k] = instructionIndex(pattern.values[k], archSelect);
+			opcodeBits = wordMask;
+			for (i = 0; i < PIC_MAX_NUM_OPERANDS; i++)
+				opcodeBits &= ~allInstructionSets[archSelect].instructionSet[indices[k]].operandMasks[i];
+			if ((pattern.masks[k] & opcodeBits) != opcodeBits) {
+				fprintf(stderr, "The first %d instructions of a signature must have a mnemonic!\n", SIGNATURE_KEY_LENGTH);
+				retVal = ERROR_INVALID_ARGUMENTS;
+			}
+		}
+		if (retVal < 0) {
+			fprintf(stderr, "Signature source line %d: invalid signature for %s!\n", lineNumber, name);
+			goto cleanup;
+		}
+
+		if (growArray((void **)&signatures, &signaturesCapacity, numSignatures+1, sizeof(signatureSource)) < 0 ||
+		    growArray((void **)&values, &wordsCapacity, numWords+pattern.length, sizeof(uint16_t)) < 0 ||
+		    growArray((void **)&masks, &masksCapacity, numWords+pattern.length, sizeof(uint16_t)) < 0 ||
+		    growArray((void **)&names, &namesCapacity, namesSize+strlen(name)+1, sizeof(char)) < 0) {
+			fprintf(stderr, "Error allocating sufficient memory for signature database!\n");
+			retVal = ERROR_MEMORY_ALLOCATION_ERROR;
+			goto cleanup;
+		}
+
+		signature = &signatures[numSignatures++];
+		signature->key = signatureKey(archSelect, indices);
+		signature->archSelect = archSelect;
+		signature->length = pattern.length;
+		signature->firstWord = numWords;
+		signature->nameOffset = namesSize;
+		memcpy(&values[numWords], pattern.values, pattern.length*sizeof(uint16_t));
+		memcpy(&masks[numWords], pattern.masks, pattern.length*sizeof(uint16_t));
+		numWords += pattern.length;
+		strcpy(&names[namesSize], name);
+		namesSize += strlen(name)+1;
+	}
+	if (ferror(fileIn)) {
+		perror("Error reading signature database source file");
+		retVal = ERROR_FILE_READING_ERROR;
+		goto cleanup;
+	}
+
+	if (numSignatures > 0)
+		qsort(signatures, numSignatures, sizeof(signatureSource), compareSignatures);
+
+	/* Write out the index */
+	if (fwrite(SIGNATURE_MAGIC, 1, 4, fileOut) != 4)
+		retVal = ERROR_FILE_WRITING_ERROR;
+	if (retVal == 0)
+		retVal = putLE32(fileOut, numSignatures);
+	if (retVal == 0)
+		retVal = putLE32(fileOut, numWords);
+	if (retVal == 0)
+		retVal = putLE32(fileOut, namesSize);
+	for (i = 0; i < numSignatures && retVal == 0; i++) {
+		retVal = putLE32(fileOut, signatures[i].key);
+		if (retVal == 0)
+			retVal = putLE32(fileOut, signatures[i].firstWord);
+		if (retVal == 0)
+			retVal = putLE32(fileOut, signatures[i].nameOffset);
+		if (retVal == 0)
+			retVal = putLE16(fileOut, signatures[i].length);
+		if (retVal == 0)
+			retVal = putLE16(fileOut, signatures[i].archSelect);
+	}
+	for (i = 0; i < numWords && retVal == 0; i++) {
+		retVal = putLE16(fileOut, values[i]);
+		if (retVal == 0)
+			retVal = putLE16(fileOut, masks[i]);
+	}
+	if (retVal == 0 && namesSize > 0 && fwrite(names, 1, namesSize, fileOut) != (size_t)namesSize)
+		retVal = ERROR_FILE_WRITING_ERROR;
+	if (retVal < 0)
+		fprintf(stderr, "Error writing signature database to file!\n");
+
+	cleanup:
+	free(signatures);
+	free(values);
+	free(masks);
+	free(names);
+
+	return retVal;
+}
+
+/* Reads and checks an on-disk signature database index. */
+int loadSignatureDatabase(signatureDatabase *database, FILE *fileIn) {
+	unsigned char *data = NULL, *newData;
+	size_t size = 0, capacity = 0, n;
+	uint32_t numWords, namesSize, i;
+	const unsigned char *entry;
+
+	memset(database, 0, sizeof(signatureDatabase));
+
+	/* Read the whole index, it is small */
+	do {
+		if (size == capacity) {
+			capacity = (capacity == 0) ? 4096 : capacity*2;
+			newData = realloc(data, capacity);
+			if (newData == NULL) {
+				free(data);
+				fprintf(stderr, "Error allocating sufficient memory for signature database!\n");
+				return ERROR_MEMORY_ALLOCATION_ERROR;
+			}
+			data = newData;
+		}
+		n = fread(data+size, 1, capacity-size, fileIn);
+		size += n;
+	} while (n > 0);
+	if (ferror(fileIn)) {
+		free(data);
+		perror("Error reading signature database");
+		return ERROR_FILE_READING_ERROR;
+	}
+
+	/* Check that the sections add up and every entry is in bounds */
+	if (size < SIGNATURE_HEADER_SIZE || memcmp(data, SIGNATURE_MAGIC, 4) != 0)
+		goto invalid;
+	database->numSignatures = getLE32(data+4);
+	numWords = getLE32(data+8);
+	namesSize = getLE32(data+12);
+	if ((uint64_t)SIGNATURE_HEADER_SIZE + (uint64_t)database->numSignatures*SIGNATURE_ENTRY_SIZE +
+	    (uint64_t)numWords*SIGNATURE_WORD_SIZE + namesSize != size)
+		goto invalid;
+	database->entries = data + SIGNATURE_HEADER_SIZE;
+	database->words = database->entries + database->numSignatures*SIGNATURE_ENTRY_SIZE;
+	database->names = (const char *)(database->words + numWords*SIGNATURE_WORD_SIZE);
+	if (namesSize > 0 && database->names[namesSize-1] != '\0')
+		goto invalid;
+	for (i = 0; i < database->numSignatures; i++) {
+		entry = database->entries + i*SIGNATURE_ENTRY_SIZE;
+		if ((uint64_t)getLE32(entry+4) + getLE16(entry+12) > numWords || getLE32(entry+8) >= namesSize ||
+		    getLE16(entry+12) < SIGNATURE_KEY_LENGTH || getLE16(entry+14) > PIC_MIDRANGE_ENHANCED)
+			goto invalid;
+		if (i > 0 && getLE32(entry) < getLE32(entry-SIGNATURE_ENTRY_SIZE))
+			goto invalid;
+	}
+
+	database->data = data;
+	return 0;
+
+	invalid:
+	free(data);
+	memset(database, 0, sizeof(signatureDatabase));
+	fprintf(stderr, "Invalid signature database!\n");
+	return ERROR_FILE_READING_ERROR;
+}
+
+/* Frees the memory held by a signature database. */
+void freeSignatureDatabase(signatureDatabase *database) {
+	free(database->data);
+	memset(database, 0, sizeof(signatureDatabase));
+}
+
+/* Matches the signature database against the start of every basic block
+ * of an analyzed program image, with one hash lookup per block. Library
+ * functions are entered by a call, so they always start a block. */
+int matchSignatures(signatureMatches *matches, const signatureDatabase *database, const programAnalysis *analysis) {
+	const analyzedInstruction *instructions = analysis->instructions;
+	const unsigned char *entry, *word;
+	int indices[SIGNATURE_KEY_LENGTH];
+	uint32_t key, low, high, mid;
+	int b, start, length, i, k;
+
+	memset(matches, 0, sizeof(signatureMatches));
+	matches->addresses = malloc((analysis->numBlocks+1)*sizeof(uint32_t));
+	matches->names = malloc((analysis->numBlocks+1)*sizeof(const char *));
+	if (matches->addresses == NULL || matches->names == NULL) {
+		freeSignatureMatches(matches);
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+
+	for (b = 0; b < analysis->numBlocks; b++) {
+		start = analysis->blocks[b].start;
+		if (start+SIGNATURE_KEY_LENGTH > analysis->numInstructions ||
+		    instructions[start+SIGNATURE_KEY_LENGTH-1].address != instructions[start].address+SIGNATURE_KEY_LENGTH-1)
+			continue;
+		for (k = 0; k < SIGNATURE_KEY_LENGTH; k++)
+			indices[k] = instructionIndex(instructions[start+k].opcode, analysis->archSelect);
+		key = signatureKey(analysis->archSelect, indices);
+
+		/* Find the first entry with the key */
+		low = 0;
+		high = database->numSignatures;
+		while (low < high) {
+			mid = (low+high)/2;
+			if (getLE32(database->entries + mid*SIGNATURE_ENTRY_SIZE) < key)
+				low = mid+1;
+			else
+				high = mid;
+		}
+
+		/* Check every signature with the key, longest first */
+		for (; low < database->numSignatures; low++) {
+			entry = database->entries + low*SIGNATURE_ENTRY_SIZE;
+			if (getLE32(entry) != key)
+				break;
+			length = getLE16(entry+12);
+			if (getLE16(entry+14) != analysis->archSelect || start+length > analysis->numInstructions)
+				continue;
+			word = database->words + getLE32(entry+4)*SIGNATURE_WORD_SIZE;
+			for (i = 0; i < length; i++, word += SIGNATURE_WORD_SIZE) {
+				if (instructions[start+i].address != instructions[start].address+i ||
+				    (instructions[start+i].opcode & getLE16(word+2)) != getLE16(word))
+					break;
+			}
+			if (i == length) {
+				matches->addresses[matches->numMatches] = instructions[start].address;
+				matches->names[matches->numMatches] = database->names + getLE32(entry+8);
+				matches->numMatches++;
+				break;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/* Returns the name of the function recognized at an address, or NULL. */
+const char *lookupSignatureMatch(const signatureMatches *matches, uint32_t address) {
+	int low, high, mid;
+
+	low = 0;
+	high = matches->numMatches;
+	while (low < high) {
+		mid = (low+high)/2;
+		if (matches->addresses[mid] < address)
+			low = mid+1;
+		else
+			high = mid;
+	}
+	if (low < matches->numMatches && matches->addresses[low] == address)
+		return matches->names[low];
+
+	return NULL;
+}
+
+/* Frees the memory held by the recognized functions. */
+void freeSignatureMatches(signatureMatches *matches) {
+	free(matches->addresses);
+	free(matches->names);
+	memset(matches, 0, sizeof(signatureMatches));
+}
+
+/* Computes the key of a function from the instruction set indices of its
+ * first SIGNATURE_KEY_LENGTH instructions, FNV-1a with a final mix. */
+static uint32_t signatureKey(int archSelect, const int *instructionIndices) {
+	uint32_t hash = 0x811C9DC5;
+	int k;
+
+	hash = (hash ^ archSelect) * 0x01000193;
+	for (k = 0; k < SIGNATURE_KEY_LENGTH; k++)
+		hash = (hash ^ instructionIndices[k]) * 0x01000193;
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6B;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35;
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+/* Returns the index of an opcode's instruction in the instruction set. */
+static int instructionIndex(uint16_t opcode, int archSelect) {
+	disassembledInstruction dInstruction;
+	assembledInstruction aInstruction;
+
+	aInstruction.address = 0;
+	aInstruction.opcode = opcode;
+	if (disassembleInstruction(&dInstruction, &aInstruction, archSelect) < 0)
+		return -1;
+
+	return dInstruction.instruction - allInstructionSets[archSelect].instructionSet;
+}
+
+/* Grows an array to hold at least needed elements. */
+static int growArray(void **array, int *capacity, int needed, size_t elementSize) {
+	void *newArray;
+	int newCapacity;
+
+	if (needed <= *capacity)
+		return 0;
+	for (newCapacity = (*capacity == 0) ? 64 : *capacity; newCapacity < needed; newCapacity *= 2)
+		;
+	newArray = realloc(*array, newCapacity*elementSize);
+	if (newArray == NULL)
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	*array = newArray;
+	*capacity = newCapacity;
+
+	return 0;
+}
+
@@ -0,0 +1,81 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * signature.h - Header file for the identification of known library
+ *  functions by their masked instruction signatures.
+ *
+ */
+
+#ifndef SIGNATURE_DISASM_H
+#define SIGNATURE_DISASM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "pic_analysis.h"
+
+/* Number of leading instructions of a function that are hashed into the
+ * key of its signature. Signatures must be at least this long, and these
+ * instructions may only leave out operands, not opcode bits. */
+#define SIGNATURE_KEY_LENGTH		4
+
+/* Structure to hold a signature database, as read from its on-disk index.
+ * The index is kept in memory as is: a header, the signature entries
+ * sorted by key, the mask and value pairs of the signature words, and the
+ * function names, all little endian. */
+struct _signatureDatabase {
+	unsigned char *data;
+	uint32_t numSignatures;
+	const unsigned char *entries;
+	const unsigned char *words;
+	const char *names;
+};
+typedef struct _signatureDatabase signatureDatabase;
+
+/* Structure to hold the functions recognized in a program image, sorted
+ * by address. The names point into the signature database. */
+struct _signatureMatches {
+	uint32_t *addresses;
+	const char **names;
+	int numMatches;
+};
+typedef struct _signatureMatches signatureMatches;
+
+/* Compiles a signature database source file, with one function per line
+ * in the form "<architecture> <name> <pattern>" where the pattern is in
+ * the --search syntax, into the on-disk index. */
+int buildSignatureDatabase(FILE *fileOut, FILE *fileIn);
+
+/* Reads and checks an on-disk signature database index. */
+int loadSignatureDatabase(signatureDatabase *database, FILE *fileIn);
+
+/* Frees the memory held by a signature database. */
+void freeSignatureDatabase(signatureDatabase *database);
+
+/* Matches the signature database against the start of every basic block
+ * of an analyzed program image, with one hash lookup per block. */
+int matchSignatures(signatureMatches *matches, const signatureDatabase *database, const programAnalysis *analysis);
+
+/* Returns the name of the function recognized at an address, or NULL. */
+const char *lookupSignatureMatch(const signatureMatches *matches, uint32_t address);
+
+/* Frees the memory held by the recognized functions. */
+void freeSignatureMatches(signatureMatches *matches);
+
+#endif
+
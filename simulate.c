@@ -0,0 +1,843 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * simulate.c - Instruction set simulator of the mid-range and enhanced
+ *  mid-range cores. The program memory is decoded once with the
+ *  disassembler's instruction tables into an array of handler addresses
+ *  and operands, and the simulation jumps from handler to handler
+ *  (direct threading with the labels as values extension of GCC).
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "simulate.h"
+#include "pic_device.h"
+#include "errorcodes.h"
+
+extern instructionSetInfo allInstructionSets[];
+
+/* Core registers, at the same offset in every bank */
+#define SIM_INDF		0x00
+#define SIM_PCL			0x02
+#define SIM_STATUS		0x03
+#define SIM_FSR			0x04	/* FSR0L on the enhanced mid-range */
+#define SIM_BSR			0x08
+#define SIM_WREG		0x09
+#define SIM_PCLATH		0x0A
+#define SIM_INTCON		0x0B
+#define SIM_NUM_CORE_REGISTERS	0x0C
+/* Registers written by the option and tris instructions */
+#define SIM_OPTION_REG		0x81
+#define SIM_TRIS		0x80
+
+/* STATUS bits */
+#define SIM_STATUS_C		0x01
+#define SIM_STATUS_DC		0x02
+#define SIM_STATUS_Z		0x04
+#define SIM_STATUS_PD		0x08
+#define SIM_STATUS_TO		0x10
+
+/* Values of simulator.shared */
+#define SIM_SHARED		1
+#define SIM_SHARED_INDIRECT	2
+
+/* Address of the byte for the accesses that don't hit data memory */
+#define SIM_NO_ADDRESS		SIM_DATA_MEMORY_SIZE
+
+/* Operations of the simulator, one per instruction, with the operations
+ * up to OP_RESET named as the instructions in operationNames */
+enum PIC_Simulator_Operations {
+	OP_ADDWF, OP_ANDWF, OP_CLRF, OP_CLRW, OP_COMF, OP_DECF, OP_DECFSZ,
+	OP_INCF, OP_INCFSZ, OP_IORWF, OP_MOVF, OP_MOVWF, OP_NOP, OP_OPTION,
+	OP_RLF, OP_RRF, OP_SUBWF, OP_SWAPF, OP_TRIS, OP_XORWF, OP_BCF, OP_BSF,
+	OP_BTFSC, OP_BTFSS, OP_ADDLW, OP_ANDLW, OP_CALL, OP_CLRWDT, OP_GOTO,
+	OP_IORLW, OP_MOVLW, OP_RETFIE, OP_RETLW, OP_RETURN, OP_SLEEP, OP_SUBLW,
+	OP_XORLW, OP_ADDWFC, OP_SUBWFB, OP_LSLF, OP_LSRF, OP_ASRF, OP_MOVLB,
+	OP_MOVLP, OP_BRA, OP_BRW, OP_CALLW, OP_ADDFSR,
+	/* The indexed forms of moviw and movwi follow their increment forms */
+	OP_MOVIW, OP_MOVIW_INDEXED, OP_MOVWI, OP_MOVWI_INDEXED,
+	OP_RESET,
+	/* Words that are not any instruction */
+	OP_DATA,
+	/* Words with a stop address */
+	OP_STOP,
+	SIM_NUM_OPERATIONS,
+};
+
+static const char *operationNames[OP_DATA] = {
+	"addwf", "andwf", "clrf", "clrw", "comf", "decf", "decfsz",
+	"incf", "incfsz", "iorwf", "movf", "movwf", "nop", "option",
+	"rlf", "rrf", "subwf", "swapf", "tris", "xorwf", "bcf", "bsf",
+	"btfsc", "btfss", "addlw", "andlw", "call", "clrwdt", "goto",
+	"iorlw", "movlw", "retfie", "retlw", "return", "sleep", "sublw",
+	"xorlw", "addwfc", "subwfb", "lslf", "lsrf", "asrf", "movlb",
+	"movlp", "bra", "brw", "callw", "addfsr",
+	"moviw", "moviw", "movwi", "movwi",
+	"reset",
+};
+
+static const char *stopReasonNames[] = {"not stopped", "reached stop address", "reached cycle limit", "register condition met", "sleep", "invalid instruction"};
+
+/* Looks up the operation simulating an instruction of the instruction set. */
+static int lookupOperation(const instructionInfo *instruction);
+/* Resets the registers of the simulated core. */
+static void resetSimulator(simulator *sim);
+/* Data memory address of an indirect access through INDF (mid-range) or
+ * INDFn (enhanced mid-range). */
+static uint32_t indirectAddress(simulator *sim, uint32_t f);
+/* Data memory address of a 16-bit FSR value of the enhanced mid-range. */
+static uint32_t linearAddress(simulator *sim, uint32_t fsr);
+/* Writes to the core registers and the watched register, returns the
+ * possibly changed program counter. */
+static uint32_t writeSpecial(simulator *sim, uint32_t address, uint8_t value, uint32_t pc, uint64_t *cycles);
+
+
+/* Pre-decodes the program memory of a program image for the mid-range or
+ * enhanced mid-range core, with every word not in the image erased
+ * (0x3FFF), and resets the simulated core. deviceIndex is -1 if no device
+ * is selected, otherwise the program memory is sized to the device's. */
+int initSimulator(simulator *sim, const programImage *image, int archSelect, int deviceIndex) {
+	const instructionInfo *instructionSet;
+	int operations[PIC_TOTAL_PIC18_INSTRUCTIONS], fixed[PIC_TOTAL_PIC18_INSTRUCTIONS];
+	disassembledInstruction dInstruction;
+	assembledInstruction aInstruction;
+	simInstruction *insn;
+	uint32_t size, address;
+	int i, k, numFixed;
+
+	if (archSelect != PIC_MIDRANGE && archSelect != PIC_MIDRANGE_ENHANCED)
+		return ERROR_INVALID_ARGUMENTS;
+
+	memset(sim, 0, sizeof(*sim));
+	sim->archSelect = archSelect;
+	sim->watchAddress = -1;
+	sim->maxCycles = SIM_DEFAULT_MAX_CYCLES;
+
+	/* The program counter wraps around at the end of the program memory
+	 * of the device, or the largest program memory of the core */
+	size = (archSelect == PIC_MIDRANGE) ? 0x2000 : 0x8000;
+	if (deviceIndex >= 0 && allDevices[deviceIndex].programMemorySize < size &&
+	    (allDevices[deviceIndex].programMemorySize & (allDevices[deviceIndex].programMemorySize-1)) == 0)
+		size = allDevices[deviceIndex].programMemorySize;
+	sim->pcMask = size-1;
+
+	sim->program = malloc(size * sizeof(simInstruction));
+	sim->programWords = malloc(size * sizeof(uint16_t));
+	if (sim->program == NULL || sim->programWords == NULL) {
+		freeSimulator(sim);
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+
+	for (address = 0; address < size; address++)
+		sim->programWords[address] = 0x3FFF;
+	for (i = 0; i < image->numInstructions; i++) {
+		if (image->instructions[i].address < size)
+			sim->programWords[image->instructions[i].address] = image->instructions[i].opcode & 0x3FFF;
+	}
+
+	instructionSet = allInstructionSets[archSelect].instructionSet;
+	numFixed = 0;
+	for (i = 0; i < allInstructionSets[archSelect].numInstructions; i++) {
+		operations[i] = lookupOperation(&instructionSet[i]);
+		if ((instructionSet[i].operandMasks[0] | instructionSet[i].operandMasks[1] | instructionSet[i].operandMasks[2]) == 0)
+			fixed[numFixed++] = i;
+	}
+
+	/* Decode every word once, keeping the operands in the fields the
+	 * operations expect them in */
+	for (address = 0; address < size; address++) {
+		insn = &sim->program[address];
+		memset(insn, 0, sizeof(*insn));
+		aInstruction.address = address;
+		aInstruction.opcode = sim->programWords[address];
+		if (disassembleInstruction(&dInstruction, &aInstruction, archSelect) < 0) {
+			freeSimulator(sim);
+			return ERROR_IRRECOVERABLE;
+		}
+		insn->operation = operations[dInstruction.instruction - instructionSet];
+
+		/* Instructions without operands are matched exactly, because
+		 * the decoding order shadows some of them (sleep decodes as
+		 * tris 0x03) */
+		for (k = 0; k < numFixed; k++) {
+			if (instructionSet[fixed[k]].opcodeMask == aInstruction.opcode) {
+				insn->operation = operations[fixed[k]];
+				break;
+			}
+		}
+		if (k < numFixed)
+			continue;
+		for (k = 0; k < dInstruction.instruction->numOperands; k++) {
+			switch (dInstruction.instruction->operandTypes[k]) {
+				case OPERAND_REGISTER:
+					insn->f = dInstruction.operands[k];
+					break;
+				case OPERAND_REGISTER_DEST:
+				case OPERAND_BIT:
+				case OPERAND_FSR_INDEX:
+				case OPERAND_INDF_INDEX:
+					insn->arg = dInstruction.operands[k];
+					break;
+				default:
+					insn->k = dInstruction.operands[k];
+					break;
+			}
+		}
+	}
+
+	/* Core registers are in every bank, and so is the common RAM at
+	 * the end of the banks */
+	for (k = 0x70; k < 0x80; k++)
+		sim->shared[k] = SIM_SHARED;
+	if (archSelect == PIC_MIDRANGE) {
+		sim->shared[SIM_INDF] = SIM_SHARED_INDIRECT;
+		sim->shared[SIM_PCL] = sim->shared[SIM_STATUS] = sim->shared[SIM_FSR] = SIM_SHARED;
+		sim->shared[SIM_PCLATH] = sim->shared[SIM_INTCON] = SIM_SHARED;
+		sim->stackSize = 8;
+		sim->wAddress = SIM_DATA_MEMORY_SIZE+1;
+	} else {
+		for (k = 0; k < SIM_NUM_CORE_REGISTERS; k++)
+			sim->shared[k] = SIM_SHARED;
+		sim->shared[0] = sim->shared[1] = SIM_SHARED_INDIRECT;
+		sim->stackSize = 16;
+		sim->wAddress = SIM_WREG;
+	}
+
+	resetSimulator(sim);
+
+	return 0;
+}
+
+/* Parses stop conditions separated by commas: "pc=<address>" to stop
+ * when the address is reached, "cycles=<count>" to stop after that many
+ * cycles, and "<register>=<value>" to stop when the value is written to
+ * the register, given by its address or, if deviceIndex is not -1, by
+ * its name. The simulation always stops at sleep. */
+int parseStopConditions(simulator *sim, const char *conditions, int deviceIndex) {
+	char condition[64], *value, *end;
+	const char *next;
+	unsigned long long number;
+	long address;
+	size_t length;
+
+	for (; *conditions != '\0'; conditions = next) {
+		next = strchr(conditions, ',');
+		length = (next != NULL) ? (size_t)(next - conditions) : strlen(conditions);
+		next = (next != NULL) ? next+1 : conditions+length;
+		if (length == 0)
+			continue;
+		if (length >= sizeof(condition)) {
+			fprintf(stderr, "Error: Stop condition too long!\n");
+			return ERROR_INVALID_ARGUMENTS;
+		}
+		memcpy(condition, conditions, length);
+		condition[length] = '\0';
+
+		value = strchr(condition, '=');
+		if (value == NULL) {
+			fprintf(stderr, "Error: Invalid stop condition \"%s\"!\n", condition);
+			return ERROR_INVALID_ARGUMENTS;
+		}
+		*value++ = '\0';
+		number = strtoull(value, &end, 0);
+		if (*value == '\0' || *end != '\0') {
+			fprintf(stderr, "Error: Invalid value in stop condition \"%s\"!\n", condition);
+			return ERROR_INVALID_ARGUMENTS;
+		}
+
+		if (strcmp(condition, "pc") == 0) {
+			if (number > sim->pcMask) {
+				fprintf(stderr, "Error: Stop address 0x%llX is beyond the program memory!\n", number);
+				return ERROR_INVALID_ARGUMENTS;
+			}
+			sim->program[number].stop = 1;
+		} else if (strcmp(condition, "cycles") == 0) {
+			sim->maxCycles = number;
+		} else {
+			if (sim->watchAddress >= 0) {
+				fprintf(stderr, "Error: Only one register stop condition is supported!\n");
+				return ERROR_INVALID_ARGUMENTS;
+			}
+			address = strtol(condition, &end, 0);
+			if (condition[0] == '\0' || *end != '\0')
+				address = (deviceIndex >= 0) ? lookupRegisterAddress(deviceIndex, condition) : -1;
+			if (address < 0 || address >= SIM_DATA_MEMORY_SIZE || number > 0xFF) {
+				fprintf(stderr, "Error: Invalid register stop condition \"%s=%s\"!\n", condition, value);
+				return ERROR_INVALID_ARGUMENTS;
+			}
+			sim->watchAddress = address;
+			sim->watchValue = number;
+		}
+	}
+
+	return 0;
+}
+
+/* The data memory address of a file register operand: the registers in
+ * every bank are kept in bank 0. */
+static inline uint32_t fileAddress(simulator *sim, uint32_t f) {
+	if (sim->shared[f] == SIM_SHARED)
+		return f;
+	if (sim->shared[f] == SIM_SHARED_INDIRECT)
+		return indirectAddress(sim, f);
+	if (sim->archSelect == PIC_MIDRANGE)
+		return ((uint32_t)(sim->data[SIM_STATUS] & 0x60) << 2) | f;
+	return ((uint32_t)(sim->data[SIM_BSR] & 0x1F) << 7) | f;
+}
+
+/* Reads a file register, PCL reads as the low byte of the address of the
+ * next instruction. */
+static inline uint8_t readFile(const simulator *sim, uint32_t address, uint32_t pc) {
+	if (address == SIM_PCL)
+		return (pc+1) & 0xFF;
+	return sim->data[address];
+}
+
+/* Runs the simulation until a stop condition is met, returns one of the
+ * PIC_Simulator_Stop_Reasons. */
+int runSimulator(simulator *sim) {
+	static const void *const handlers[SIM_NUM_OPERATIONS] = {
+		&&op_addwf, &&op_andwf, &&op_clrf, &&op_clrw, &&op_comf, &&op_decf, &&op_decfsz,
+		&&op_incf, &&op_incfsz, &&op_iorwf, &&op_movf, &&op_movwf, &&op_nop, &&op_option,
+		&&op_rlf, &&op_rrf, &&op_subwf, &&op_swapf, &&op_tris, &&op_xorwf, &&op_bcf, &&op_bsf,
+		&&op_btfsc, &&op_btfss, &&op_addlw, &&op_andlw, &&op_call, &&op_clrwdt, &&op_goto,
+		&&op_iorlw, &&op_movlw, &&op_retfie, &&op_retlw, &&op_return, &&op_sleep, &&op_sublw,
+		&&op_xorlw, &&op_addwfc, &&op_subwfb, &&op_lslf, &&op_lsrf, &&op_asrf, &&op_movlb,
+		&&op_movlp, &&op_bra, &&op_brw, &&op_callw, &&op_addfsr,
+		&&op_moviw, &&op_moviw_indexed, &&op_movwi, &&op_movwi_indexed,
+		&&op_reset, &&op_data, &&op_stop,
+	};
+	const simInstruction *insn;
+	simInstruction *program;
+	uint8_t *data;
+	uint32_t pc, pcMask, address, fsr, stackMask;
+	uint64_t cycles, instructions, firstInstruction, maxCycles;
+	unsigned int a, w, r, c;
+	struct timespec start, end;
+	uint32_t i;
+
+	/* Fill in the handlers the first time around, words with a stop
+	 * address go through op_stop */
+	program = sim->program;
+	if (!sim->threaded) {
+		for (i = 0; i <= sim->pcMask; i++)
+			program[i].handler = handlers[program[i].stop ? OP_STOP : program[i].operation];
+		sim->threaded = 1;
+	}
+
+	data = sim->data;
+	pc = sim->pc;
+	pcMask = sim->pcMask;
+	stackMask = sim->stackSize-1;
+	cycles = sim->cycles;
+	instructions = firstInstruction = sim->instructions;
+	maxCycles = sim->maxCycles;
+	sim->stopReason = SIM_STOP_NONE;
+
+/* W, which is memory mapped on the enhanced mid-range */
+#define W		data[sim->wAddress]
+#define STATUS		data[SIM_STATUS]
+#define PCLATH		data[SIM_PCLATH]
+#define FLAGS(mask, value)	(STATUS = (STATUS & ~(mask)) | (value))
+#define ZERO(r)		((((r) & 0xFF) == 0) ? SIM_STATUS_Z : 0)
+/* Jumps to the handler of the instruction at pc */
+#define DISPATCH()	do { \
+		if (cycles >= maxCycles) \
+			goto stop; \
+		insn = &program[pc]; \
+		goto *insn->handler; \
+	} while (0)
+#define NEXT(n)		do { pc = (pc+1) & pcMask; cycles += (n); instructions++; DISPATCH(); } while (0)
+#define SKIP()		do { pc = (pc+2) & pcMask; cycles += 2; instructions++; DISPATCH(); } while (0)
+#define JUMP(target)	do { pc = (target) & pcMask; cycles += 2; instructions++; DISPATCH(); } while (0)
+#define PUSH(value)	do { sim->stack[sim->stackPointer] = (value) & pcMask; sim->stackPointer = (sim->stackPointer+1) & stackMask; } while (0)
+#define POP()		(sim->stackPointer = (sim->stackPointer+stackMask) & stackMask, sim->stack[sim->stackPointer])
+/* Writes a file register. Writes to PCL jump, and writes to the watched
+ * register may stop the simulation. */
+#define WRITE(address, value)	do { \
+		data[address] = (value); \
+		if ((address) < SIM_NUM_CORE_REGISTERS || (int32_t)(address) == sim->watchAddress) { \
+			pc = writeSpecial(sim, (address), (value), pc, &cycles); \
+			if (sim->stopReason != SIM_STOP_NONE) \
+				maxCycles = 0; \
+		} \
+	} while (0)
+/* Stores the result of a byte oriented file register operation in W or
+ * back in the file register */
+#define STORE(address, value)	do { \
+		if (insn->arg) \
+			WRITE(address, (value) & 0xFF); \
+		else \
+			W = (value); \
+	} while (0)
+/* The file register operand and its value */
+#define OPERAND()	do { address = fileAddress(sim, insn->f); a = readFile(sim, address, pc); } while (0)
+/* The 16-bit FSRn of the enhanced mid-range */
+#define FSR(n)		(data[SIM_FSR + 2*(n)] | (data[SIM_FSR + 2*(n) + 1] << 8))
+#define SET_FSR(n, value)	do { data[SIM_FSR + 2*(n)] = (value) & 0xFF; data[SIM_FSR + 2*(n) + 1] = ((value) >> 8) & 0xFF; } while (0)
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	DISPATCH();
+
+	/* Byte oriented file register operations */
+op_addwf:
+	OPERAND();
+	w = W;
+	r = a + w;
+	STORE(address, r);
+	FLAGS(SIM_STATUS_C | SIM_STATUS_DC | SIM_STATUS_Z, ((r > 0xFF) ? SIM_STATUS_C : 0) | ((((a & 0xF) + (w & 0xF)) > 0xF) ? SIM_STATUS_DC : 0) | ZERO(r));
+	NEXT(1);
+op_addwfc:
+	OPERAND();
+	w = W;
+	c = STATUS & SIM_STATUS_C;
+	r = a + w + c;
+	STORE(address, r);
+	FLAGS(SIM_STATUS_C | SIM_STATUS_DC | SIM_STATUS_Z, ((r > 0xFF) ? SIM_STATUS_C : 0) | ((((a & 0xF) + (w & 0xF) + c) > 0xF) ? SIM_STATUS_DC : 0) | ZERO(r));
+	NEXT(1);
+op_subwf:
+	OPERAND();
+	w = W;
+	r = a - w;
+	STORE(address, r & 0xFF);
+	FLAGS(SIM_STATUS_C | SIM_STATUS_DC | SIM_STATUS_Z, ((a >= w) ? SIM_STATUS_C : 0) | (((a & 0xF) >= (w & 0xF)) ? SIM_STATUS_DC : 0) | ZERO(r));
+	NEXT(1);
+op_subwfb:
+	OPERAND();
+	w = W;
+	c = (STATUS & SIM_STATUS_C) ? 0 : 1;
+	r = a - w - c;
+	STORE(address, r & 0xFF);
+	FLAGS(SIM_STATUS_C | SIM_STATUS_DC | SIM_STATUS_Z, ((a >= w + c) ? SIM_STATUS_C : 0) | (((a & 0xF) >= (w & 0xF) + c) ? SIM_STATUS_DC : 0) | ZERO(r));
+	NEXT(1);
+op_andwf:
+	OPERAND();
+	r = a & W;
+	STORE(address, r);
+	FLAGS(SIM_STATUS_Z, ZERO(r));
+	NEXT(1);
+op_iorwf:
+	OPERAND();
+	r = a | W;
+	STORE(address, r);
+	FLAGS(SIM_STATUS_Z, ZERO(r));
+	NEXT(1);
+op_xorwf:
+	OPERAND();
+	r = a ^ W;
+	STORE(address, r);
+	FLAGS(SIM_STATUS_Z, ZERO(r));
+	NEXT(1);
+op_clrf:
+	address = fileAddress(sim, insn->f);
+	WRITE(address, 0);
+	FLAGS(SIM_STATUS_Z, SIM_STATUS_Z);
+	NEXT(1);
+op_clrw:
+	W = 0;
+	FLAGS(SIM_STATUS_Z, SIM_STATUS_Z);
+	NEXT(1);
+op_comf:
+	OPERAND();
+	r = ~a & 0xFF;
+	STORE(address, r);
+	FLAGS(SIM_STATUS_Z, ZERO(r));
+	NEXT(1);
+op_decf:
+	OPERAND();
+	r = (a - 1) & 0xFF;
+	STORE(address, r);
+	FLAGS(SIM_STATUS_Z, ZERO(r));
+	NEXT(1);
+op_incf:
+	OPERAND();
+	r = (a + 1) & 0xFF;
+	STORE(address, r);
+	FLAGS(SIM_STATUS_Z, ZERO(r));
+	NEXT(1);
+op_decfsz:
+	OPERAND();
+	r = (a - 1) & 0xFF;
+	STORE(address, r);
+	if (r == 0)
+		SKIP();
+	NEXT(1);
+op_incfsz:
+	OPERAND();
+	r = (a + 1) & 0xFF;
+	STORE(address, r);
+	if (r == 0)
+		SKIP();
+	NEXT(1);
+op_movf:
+	OPERAND();
+	STORE(address, a);
+	FLAGS(SIM_STATUS_Z, ZERO(a));
+	NEXT(1);
+op_movwf:
+	address = fileAddress(sim, insn->f);
+	WRITE(address, W);
+	NEXT(1);
+op_rlf:
+	OPERAND();
+	r = ((a << 1) | (STATUS & SIM_STATUS_C)) & 0xFF;
+	STORE(address, r);
+	FLAGS(SIM_STATUS_C, (a >> 7) ? SIM_STATUS_C : 0);
+	NEXT(1);
+op_rrf:
+	OPERAND();
+	r = (a >> 1) | ((STATUS & SIM_STATUS_C) << 7);
+	STORE(address, r);
+	FLAGS(SIM_STATUS_C, (a & 1) ? SIM_STATUS_C : 0);
+	NEXT(1);
+op_lslf:
+	OPERAND();
+	r = (a << 1) & 0xFF;
+	STORE(address, r);
+	FLAGS(SIM_STATUS_C | SIM_STATUS_Z, ((a >> 7) ? SIM_STATUS_C : 0) | ZERO(r));
+	NEXT(1);
+op_lsrf:
+	OPERAND();
+	r = a >> 1;
+	STORE(address, r);
+	FLAGS(SIM_STATUS_C | SIM_STATUS_Z, ((a & 1) ? SIM_STATUS_C : 0) | ZERO(r));
+	NEXT(1);
+op_asrf:
+	OPERAND();
+	r = (a >> 1) | (a & 0x80);
+	STORE(address, r);
+	FLAGS(SIM_STATUS_C | SIM_STATUS_Z, ((a & 1) ? SIM_STATUS_C : 0) | ZERO(r));
+	NEXT(1);
+op_swapf:
+	OPERAND();
+	r = ((a << 4) | (a >> 4)) & 0xFF;
+	STORE(address, r);
+	NEXT(1);
+
+	/* Bit oriented file register operations */
+op_bcf:
+	OPERAND();
+	WRITE(address, a & ~(1 << insn->arg) & 0xFF);
+	NEXT(1);
+op_bsf:
+	OPERAND();
+	WRITE(address, a | (1 << insn->arg));
+	NEXT(1);
+op_btfsc:
+	OPERAND();
+	if (!(a & (1 << insn->arg)))
+		SKIP();
+	NEXT(1);
+op_btfss:
+	OPERAND();
+	if (a & (1 << insn->arg))
+		SKIP();
+	NEXT(1);
+
+	/* Literal operations */
+op_addlw:
+	a = insn->k;
+	w = W;
+	r = a + w;
+	W = r & 0xFF;
+	FLAGS(SIM_STATUS_C | SIM_STATUS_DC | SIM_STATUS_Z, ((r > 0xFF) ? SIM_STATUS_C : 0) | ((((a & 0xF) + (w & 0xF)) > 0xF) ? SIM_STATUS_DC : 0) | ZERO(r));
+	NEXT(1);
+op_sublw:
+	a = insn->k;
+	w = W;
+	r = a - w;
+	W = r & 0xFF;
+	FLAGS(SIM_STATUS_C | SIM_STATUS_DC | SIM_STATUS_Z, ((a >= w) ? SIM_STATUS_C : 0) | (((a & 0xF) >= (w & 0xF)) ? SIM_STATUS_DC : 0) | ZERO(r));
+	NEXT(1);
+op_andlw:
+	W &= insn->k;
+	FLAGS(SIM_STATUS_Z, ZERO(W));
+	NEXT(1);
+op_iorlw:
+	W |= insn->k;
+	FLAGS(SIM_STATUS_Z, ZERO(W));
+	NEXT(1);
+op_xorlw:
+	W ^= insn->k;
+	FLAGS(SIM_STATUS_Z, ZERO(W));
+	NEXT(1);
+op_movlw:
+	W = insn->k;
+	NEXT(1);
+op_movlb:
+	data[SIM_BSR] = insn->k & 0x1F;
+	NEXT(1);
+op_movlp:
+	PCLATH = insn->k & 0x7F;
+	NEXT(1);
+
+	/* Control operations, the page of call and goto comes from PCLATH */
+op_goto:
+	JUMP(((uint32_t)PCLATH << 8 & ~0x7FFU) | insn->k);
+op_call:
+	PUSH(pc+1);
+	JUMP(((uint32_t)PCLATH << 8 & ~0x7FFU) | insn->k);
+op_bra:
+	JUMP(pc + 1 + insn->k);
+op_brw:
+	JUMP(pc + 1 + W);
+op_callw:
+	PUSH(pc+1);
+	JUMP(((uint32_t)PCLATH << 8) | W);
+op_return:
+	JUMP(POP());
+op_retlw:
+	W = insn->k;
+	JUMP(POP());
+op_retfie:
+	data[SIM_INTCON] |= 0x80;
+	JUMP(POP());
+op_reset:
+	resetSimulator(sim);
+	JUMP(0);
+
+	/* Indirect operations of the enhanced mid-range */
+op_addfsr:
+	fsr = FSR(insn->arg) + insn->k;
+	SET_FSR(insn->arg, fsr);
+	NEXT(1);
+op_moviw:
+op_movwi:
+	fsr = FSR(insn->arg);
+	/* ++FSRn, --FSRn, FSRn++, FSRn-- */
+	if (insn->k == 0)
+		fsr++;
+	else if (insn->k == 1)
+		fsr--;
+	address = linearAddress(sim, fsr & 0xFFFF);
+	if (insn->k == 2)
+		fsr++;
+	else if (insn->k == 3)
+		fsr--;
+	SET_FSR(insn->arg, fsr);
+	if (insn->operation == OP_MOVWI) {
+		WRITE(address, W);
+	} else {
+		W = readFile(sim, address, pc);
+		FLAGS(SIM_STATUS_Z, ZERO(W));
+	}
+	NEXT(1);
+op_moviw_indexed:
+	address = linearAddress(sim, (FSR(insn->arg) + insn->k) & 0xFFFF);
+	W = readFile(sim, address, pc);
+	FLAGS(SIM_STATUS_Z, ZERO(W));
+	NEXT(1);
+op_movwi_indexed:
+	address = linearAddress(sim, (FSR(insn->arg) + insn->k) & 0xFFFF);
+	WRITE(address, W);
+	NEXT(1);
+
+	/* Miscellaneous operations */
+op_nop:
+	NEXT(1);
+op_clrwdt:
+	FLAGS(SIM_STATUS_TO | SIM_STATUS_PD, SIM_STATUS_TO | SIM_STATUS_PD);
+	NEXT(1);
+op_option:
+	data[SIM_OPTION_REG] = W;
+	NEXT(1);
+op_tris:
+	data[SIM_TRIS | insn->f] = W;
+	NEXT(1);
+op_sleep:
+	FLAGS(SIM_STATUS_TO | SIM_STATUS_PD, SIM_STATUS_TO);
+	sim->stopReason = SIM_STOP_SLEEP;
+	maxCycles = 0;
+	NEXT(1);
+op_data:
+	sim->stopReason = SIM_STOP_INVALID_INSTRUCTION;
+	goto stop;
+op_stop:
+	/* Resuming from a stop address executes its instruction */
+	if (instructions != firstInstruction) {
+		sim->stopReason = SIM_STOP_ADDRESS;
+		goto stop;
+	}
+	goto *handlers[insn->operation];
+
+stop:
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	sim->seconds += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	sim->pc = pc;
+	sim->cycles = cycles;
+	sim->instructions = instructions;
+	if (sim->stopReason == SIM_STOP_NONE)
+		sim->stopReason = SIM_STOP_CYCLES;
+
+	return sim->stopReason;
+
+#undef W
+#undef STATUS
+#undef PCLATH
+#undef FLAGS
+#undef ZERO
+#undef DISPATCH
+#undef NEXT
+#undef SKIP
+#undef JUMP
+#undef PUSH
+#undef POP
+#undef WRITE
+#undef STORE
+#undef OPERAND
+#undef FSR
+#undef SET_FSR
+}
+
+/* Prints why the simulation stopped, the registers and the non-zero
+ * data memory, the cycles and the speed of the simulation. */
+int printSimulatorState(FILE *out, const simulator *sim) {
+	int i, j, depth;
+
+	fprintf(out, "Stopped at 0x%04X: %s\n", sim->pc, stopReasonNames[sim->stopReason]);
+	fprintf(out, "W 0x%02X  STATUS 0x%02X  PCLATH 0x%02X", sim->data[sim->wAddress], sim->data[SIM_STATUS], sim->data[SIM_PCLATH]);
+	if (sim->archSelect == PIC_MIDRANGE)
+		fprintf(out, "  FSR 0x%02X\n", sim->data[SIM_FSR]);
+	else
+		fprintf(out, "  BSR 0x%02X  FSR0 0x%04X  FSR1 0x%04X\n", sim->data[SIM_BSR], sim->data[SIM_FSR] | (sim->data[SIM_FSR+1] << 8), sim->data[SIM_FSR+2] | (sim->data[SIM_FSR+3] << 8));
+
+	/* The stack from the top */
+	depth = (sim->instructions > 0) ? sim->stackPointer : 0;
+	fprintf(out, "Stack");
+	for (i = depth-1; i >= 0; i--)
+		fprintf(out, " 0x%04X", sim->stack[i]);
+	fprintf(out, (depth == 0) ? " empty\n" : "\n");
+
+	/* The rows of data memory with a non-zero byte */
+	for (i = 0; i < SIM_DATA_MEMORY_SIZE; i += 16) {
+		for (j = 0; j < 16 && sim->data[i+j] == 0; j++)
+			;
+		if (j == 16)
+			continue;
+		fprintf(out, "%03X:", i);
+		for (j = 0; j < 16; j++)
+			fprintf(out, " %02X", sim->data[i+j]);
+		fprintf(out, "\n");
+	}
+
+	fprintf(out, "%llu cycles, %llu instructions", (unsigned long long)sim->cycles, (unsigned long long)sim->instructions);
+	if (sim->seconds > 0)
+		fprintf(out, " in %.3f s, %.1f MIPS", sim->seconds, sim->instructions / sim->seconds / 1e6);
+	if (fprintf(out, "\n") < 0)
+		return ERROR_FILE_WRITING_ERROR;
+
+	return 0;
+}
+
+/* Frees the pre-decoded program memory of the simulator. */
+void freeSimulator(simulator *sim) {
+	free(sim->program);
+	free(sim->programWords);
+	sim->program = NULL;
+	sim->programWords = NULL;
+}
+
+/* Looks up the operation simulating an instruction of the instruction set. */
+static int lookupOperation(const instructionInfo *instruction) {
+	int i;
+
+	for (i = 0; i < OP_DATA; i++) {
+		if (strcmp(operationNames[i], instruction->mnemonic) == 0)
+			break;
+	}
+	if ((i == OP_MOVIW || i == OP_MOVWI) && instruction->operandTypes[1] == OPERAND_SIGNED_LITERAL)
+		i++;
+
+	return i;
+}
+
+/* Resets the registers of the simulated core: the program counter, the
+ * stack, and the data memory, with TO and PD set in STATUS. */
+static void resetSimulator(simulator *sim) {
+	memset(sim->data, 0, sizeof(sim->data));
+	sim->data[SIM_STATUS] = SIM_STATUS_TO | SIM_STATUS_PD;
+	sim->pc = 0;
+	sim->stackPointer = 0;
+}
+
+/* Data memory address of an indirect access through INDF (mid-range) or
+ * INDFn (enhanced mid-range). */
+static uint32_t indirectAddress(simulator *sim, uint32_t f) {
+	uint32_t address;
+
+	if (sim->archSelect == PIC_MIDRANGE_ENHANCED)
+		return linearAddress(sim, sim->data[SIM_FSR + 2*f] | (sim->data[SIM_FSR + 2*f + 1] << 8));
+
+	/* IRP selects the bank pair */
+	address = ((uint32_t)(sim->data[SIM_STATUS] & 0x80) << 1) | sim->data[SIM_FSR];
+	if (sim->shared[address & 0x7F] == SIM_SHARED)
+		return address & 0x7F;
+	/* INDF through itself reads as 0 */
+	if (sim->shared[address & 0x7F] == SIM_SHARED_INDIRECT) {
+		sim->data[SIM_NO_ADDRESS] = 0;
+		return SIM_NO_ADDRESS;
+	}
+
+	return address;
+}
+
+/* Data memory address of a 16-bit FSR value of the enhanced mid-range:
+ * traditional data memory below 0x1000, the linear view of the general
+ * purpose registers at 0x2000, and program memory from 0x8000, which
+ * reads as the low byte of the word and can't be written. */
+static uint32_t linearAddress(simulator *sim, uint32_t fsr) {
+	uint32_t offset;
+
+	if (fsr < SIM_DATA_MEMORY_SIZE) {
+		if (sim->shared[fsr & 0x7F] == SIM_SHARED)
+			return fsr & 0x7F;
+		if (sim->shared[fsr & 0x7F] != SIM_SHARED_INDIRECT)
+			return fsr;
+		sim->data[SIM_NO_ADDRESS] = 0;
+	} else if (fsr >= 0x2000 && fsr < 0x2000 + 32*80) {
+		/* 80 general purpose registers from 0x20 of every bank */
+		offset = fsr - 0x2000;
+		return ((offset / 80) << 7) | (0x20 + offset % 80);
+	} else if (fsr >= 0x8000) {
+		sim->data[SIM_NO_ADDRESS] = sim->programWords[(fsr - 0x8000) & sim->pcMask] & 0xFF;
+	} else {
+		sim->data[SIM_NO_ADDRESS] = 0;
+	}
+
+	return SIM_NO_ADDRESS;
+}
+
+/* Writes to the core registers and the watched register, returns the
+ * possibly changed program counter: writing PCL jumps to PCLATH:PCL,
+ * taking another cycle. */
+static uint32_t writeSpecial(simulator *sim, uint32_t address, uint8_t value, uint32_t pc, uint64_t *cycles) {
+	if ((int32_t)address == sim->watchAddress && value == sim->watchValue)
+		sim->stopReason = SIM_STOP_REGISTER;
+
+	if (address == SIM_PCL) {
+		(*cycles)++;
+		/* The caller moves on to the next address */
+		return ((((uint32_t)sim->data[SIM_PCLATH] << 8) | value) - 1) & sim->pcMask;
+	}
+
+	return pc;
+}
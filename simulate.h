@@ -0,0 +1,129 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * simulate.h - Header file for the instruction set simulator of the
+ *  mid-range and enhanced mid-range cores.
+ *
+ */
+
+#ifndef SIMULATE_DISASM_H
+#define SIMULATE_DISASM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "pic_disasm.h"
+#include "image.h"
+
+/* Data memory of the largest core, 32 banks of 128 bytes on the enhanced
+ * mid-range */
+#define SIM_DATA_MEMORY_SIZE		4096
+/* Levels of the hardware stack of the largest core */
+#define SIM_MAX_STACK_SIZE		16
+/* Cycles simulated if no other stop condition is given */
+#define SIM_DEFAULT_MAX_CYCLES		10000000ULL
+
+/* Reasons for the simulation to stop */
+enum PIC_Simulator_Stop_Reasons {
+	SIM_STOP_NONE,
+	SIM_STOP_ADDRESS,
+	SIM_STOP_CYCLES,
+	SIM_STOP_REGISTER,
+	SIM_STOP_SLEEP,
+	/* A word that is not any instruction */
+	SIM_STOP_INVALID_INSTRUCTION,
+};
+
+/* Structure for each pre-decoded word of program memory: the address of
+ * the code simulating its instruction, and its operands. */
+struct _simInstruction {
+	const void *handler;
+	/* One of the operations in simulate.c */
+	uint8_t operation;
+	/* Stop before executing this word */
+	uint8_t stop;
+	/* Destination (0 for W), bit number, FSR number, or increment mode */
+	uint8_t arg;
+	/* File register offset into the bank */
+	uint8_t f;
+	/* Literal, address, or signed offset */
+	int16_t k;
+};
+typedef struct _simInstruction simInstruction;
+
+/* Structure to hold the state of a simulated core. */
+struct _simulator {
+	int archSelect;
+	/* Pre-decoded program memory, pcMask+1 words */
+	simInstruction *program;
+	uint16_t *programWords;
+	uint32_t pcMask;
+	/* Set once the handlers of the program are filled in */
+	int threaded;
+
+	/* Registers: data memory, with one byte for the accesses that don't
+	 * hit it and one for W on the mid-range (where W isn't memory mapped),
+	 * the program counter and the stack */
+	uint8_t data[SIM_DATA_MEMORY_SIZE+2];
+	uint32_t wAddress;
+	/* For each offset into a bank, whether the register is in every bank
+	 * (1) or is an indirect access register (2) */
+	uint8_t shared[128];
+	uint32_t pc;
+	uint32_t stack[SIM_MAX_STACK_SIZE];
+	int stackSize;
+	int stackPointer;
+
+	uint64_t cycles;
+	uint64_t instructions;
+	/* Time spent in runSimulator() */
+	double seconds;
+
+	/* Stop conditions */
+	uint64_t maxCycles;
+	int32_t watchAddress;
+	uint8_t watchValue;
+	int stopReason;
+};
+typedef struct _simulator simulator;
+
+/* Pre-decodes the program memory of a program image for the mid-range or
+ * enhanced mid-range core, with every word not in the image erased
+ * (0x3FFF), and resets the simulated core. deviceIndex is -1 if no device
+ * is selected, otherwise the program memory is sized to the device's. */
+int initSimulator(simulator *sim, const programImage *image, int archSelect, int deviceIndex);
+
+/* Parses stop conditions separated by commas: "pc=<address>" to stop
+ * when the address is reached, "cycles=<count>" to stop after that many
+ * cycles, and "<register>=<value>" to stop when the value is written to
+ * the register, given by its address or, if deviceIndex is not -1, by
+ * its name. The simulation always stops at sleep. */
+int parseStopConditions(simulator *sim, const char *conditions, int deviceIndex);
+
+/* Runs the simulation until a stop condition is met, returns one of the
+ * PIC_Simulator_Stop_Reasons. */
+int runSimulator(simulator *sim);
+
+/* Prints why the simulation stopped, the registers and the non-zero
+ * data memory, the cycles and the speed of the simulation. */
+int printSimulatorState(FILE *out, const simulator *sim);
+
+/* Frees the pre-decoded program memory of the simulator. */
+void freeSimulator(simulator *sim);
+
+#endif
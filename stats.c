@@ -0,0 +1,286 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * stats.c - Instruction statistics of program images: an opcode histogram,
+ *  the data word ratio, branch density and memory region usage, gathered
+ *  from the decoded instructions without formatting them.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pic_disasm.h"
+#include "pic_device.h"
+#include "image.h"
+#include "stats.h"
+#include "errorcodes.h"
+
+extern instructionSetInfo allInstructionSets[];
+
+/* Instruction classes counted by the statistics */
+enum Statistics_Instruction_Classes {
+	CLASS_OTHER,
+	CLASS_BRANCH,
+	CLASS_SKIP,
+	CLASS_DATA,
+};
+
+/* Mnemonics of the jumps, calls and returns, and the conditional skips */
+static const char *branchMnemonics[] = {"goto", "call", "bra", "brw", "callw", "return", "retlw", "retfie", "reset", NULL};
+static const char *skipMnemonics[] = {"btfsc", "btfss", "decfsz", "incfsz", NULL};
+
+/* Names of the PIC_Memory_Regions */
+static const char *regionNames[] = {"program", "idlocs", "config", "eeprom", "unimplemented"};
+
+/* Returns whether a mnemonic is in a NULL terminated list. */
+static int isMnemonicIn(const char *mnemonic, const char **list) {
+	int i;
+
+	for (i = 0; list[i] != NULL; i++) {
+		if (strcmp(mnemonic, list[i]) == 0)
+			return 1;
+	}
+	return 0;
+}
+
+/* Prints a string as a JSON string literal. */
+static int printJSONString(FILE *fileOut, const char *s) {
+	if (fputc('"', fileOut) == EOF)
+		return ERROR_FILE_WRITING_ERROR;
+	for (; *s != '\0'; s++) {
+		if (*s == '"' || *s == '\\') {
+			if (fprintf(fileOut, "\\%c", *s) < 0)
+				return ERROR_FILE_WRITING_ERROR;
+		} else if ((unsigned char)*s < 0x20) {
+			if (fprintf(fileOut, "\\u%04x", (unsigned char)*s) < 0)
+				return ERROR_FILE_WRITING_ERROR;
+		} else if (fputc(*s, fileOut) == EOF) {
+			return ERROR_FILE_WRITING_ERROR;
+		}
+	}
+	if (fputc('"', fileOut) == EOF)
+		return ERROR_FILE_WRITING_ERROR;
+	return 0;
+}
+
+/* Decodes every word of a program image and counts the instructions,
+ * without disassembling them to text. deviceIndex is -1 if no device is
+ * selected. */
+int collectStatistics(programStatistics *statistics, const programImage *image, int archSelect, int deviceIndex) {
+	disassembledInstruction dInstruction;
+	uint8_t classes[PIC_TOTAL_PIC18_INSTRUCTIONS];
+	instructionInfo *instructionSet;
+	int16_t *decoded;
+	const assembledInstruction *aInstruction;
+	int i, index, region, retVal;
+
+	if (statistics == NULL || image == NULL)
+		return ERROR_INVALID_ARGUMENTS;
+	if (archSelect != PIC_BASELINE && archSelect != PIC_MIDRANGE && archSelect != PIC_MIDRANGE_ENHANCED)
+		return ERROR_INVALID_ARGUMENTS;
+
+	memset(statistics, 0, sizeof(programStatistics));
+	statistics->archSelect = archSelect;
+	statistics->deviceIndex = deviceIndex;
+
+	instructionSet = allInstructionSets[archSelect].instructionSet;
+	for (i = 0; i < allInstructionSets[archSelect].numInstructions; i++) {
+		if (i == allInstructionSets[archSelect].numInstructions-1)
+			classes[i] = CLASS_DATA;
+		else if (isMnemonicIn(instructionSet[i].mnemonic, branchMnemonics))
+			classes[i] = CLASS_BRANCH;
+		else if (isMnemonicIn(instructionSet[i].mnemonic, skipMnemonics))
+			classes[i] = CLASS_SKIP;
+		else
+			classes[i] = CLASS_OTHER;
+	}
+
+	/* Programs repeat the same few hundred opcodes over and over, so
+	 * remember the instruction of every opcode once it's decoded. */
+	decoded = malloc(0x10000*sizeof(int16_t));
+	if (decoded == NULL)
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	memset(decoded, 0xFF, 0x10000*sizeof(int16_t));
+
+	for (i = 0; i < image->numInstructions; i++) {
+		aInstruction = &image->instructions[i];
+
+		if (statistics->numWords == 0 || aInstruction->address < statistics->lowestAddress)
+			statistics->lowestAddress = aInstruction->address;
+		if (statistics->numWords == 0 || aInstruction->address > statistics->highestAddress)
+			statistics->highestAddress = aInstruction->address;
+		statistics->numWords++;
+
+		/* Only words in program memory are instructions */
+		if (deviceIndex >= 0) {
+			region = lookupMemoryRegion(deviceIndex, aInstruction->address);
+			statistics->regionCounts[region]++;
+			if (region != REGION_PROGRAM)
+				continue;
+		}
+
+		index = decoded[aInstruction->opcode];
+		if (index < 0) {
+			retVal = disassembleInstruction(&dInstruction, aInstruction, archSelect);
+			if (retVal < 0) {
+				free(decoded);
+				return retVal;
+			}
+			index = dInstruction.instruction - instructionSet;
+			decoded[aInstruction->opcode] = index;
+		}
+
+		statistics->numInstructions++;
+		statistics->instructionCounts[index]++;
+		switch (classes[index]) {
+			case CLASS_BRANCH:
+				statistics->numBranches++;
+				break;
+			case CLASS_SKIP:
+				statistics->numSkips++;
+				break;
+			case CLASS_DATA:
+				statistics->numDataWords++;
+				break;
+			default:
+				break;
+		}
+	}
+
+	free(decoded);
+
+	return 0;
+}
+
+/* Percentage of a count, 0 if the total is 0 */
+static double percent(long count, long total) {
+	return (total > 0) ? 100.0*count/total : 0.0;
+}
+
+/* Prints the statistics as a table, or as a single line JSON object. The
+ * histogram is sorted by count, and instructions sharing a mnemonic (the
+ * two forms of moviw and movwi) are counted together. */
+int printStatistics(FILE *fileOut, const char *imageName, const programStatistics *statistics, int json) {
+	instructionInfo *instructionSet = allInstructionSets[statistics->archSelect].instructionSet;
+	int numInstructions = allInstructionSets[statistics->archSelect].numInstructions;
+	const char *mnemonics[PIC_TOTAL_PIC18_INSTRUCTIONS];
+	long counts[PIC_TOTAL_PIC18_INSTRUCTIONS], count;
+	const char *mnemonic;
+	int numMnemonics, i, j, retVal;
+	const deviceInfo *device = NULL;
+
+	if (statistics->deviceIndex >= 0)
+		device = &allDevices[statistics->deviceIndex];
+
+	/* Merge the counts by mnemonic, then insertion sort them by count */
+	numMnemonics = 0;
+	for (i = 0; i < numInstructions; i++) {
+		for (j = 0; j < numMnemonics; j++) {
+			if (strcmp(mnemonics[j], instructionSet[i].mnemonic) == 0)
+				break;
+		}
+		if (j == numMnemonics) {
+			mnemonics[numMnemonics] = instructionSet[i].mnemonic;
+			counts[numMnemonics++] = 0;
+		}
+		counts[j] += statistics->instructionCounts[i];
+	}
+	for (i = 1; i < numMnemonics; i++) {
+		mnemonic = mnemonics[i];
+		count = counts[i];
+		for (j = i; j > 0 && counts[j-1] < count; j--) {
+			mnemonics[j] = mnemonics[j-1];
+			counts[j] = counts[j-1];
+		}
+		mnemonics[j] = mnemonic;
+		counts[j] = count;
+	}
+
+	if (json) {
+		retVal = (fprintf(fileOut, "{\"file\": ") < 0) ? ERROR_FILE_WRITING_ERROR : 0;
+		if (retVal == 0)
+			retVal = printJSONString(fileOut, imageName);
+		if (retVal == 0 && fprintf(fileOut, ", \"words\": %ld, \"instructions\": %ld, \"dataWords\": %ld, \"branches\": %ld, \"skips\": %ld",
+		    statistics->numWords, statistics->numInstructions, statistics->numDataWords, statistics->numBranches, statistics->numSkips) < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		if (retVal == 0 && statistics->numWords > 0 && fprintf(fileOut, ", \"lowestAddress\": %lu, \"highestAddress\": %lu",
+		    (unsigned long)statistics->lowestAddress, (unsigned long)statistics->highestAddress) < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		if (retVal == 0 && device != NULL) {
+			if (fprintf(fileOut, ", \"device\": \"%s\", \"programMemorySize\": %lu, \"regions\": {",
+			    device->name, (unsigned long)device->programMemorySize) < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+			for (i = 0; i <= REGION_UNIMPLEMENTED && retVal == 0; i++) {
+				if (fprintf(fileOut, "%s\"%s\": %ld", (i > 0) ? ", " : "", regionNames[i], statistics->regionCounts[i]) < 0)
+					retVal = ERROR_FILE_WRITING_ERROR;
+			}
+			if (retVal == 0 && fprintf(fileOut, "}") < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		if (retVal == 0 && fprintf(fileOut, ", \"histogram\": {") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		for (i = 0, j = 0; i < numMnemonics && retVal == 0; i++) {
+			if (counts[i] == 0)
+				continue;
+			if (fprintf(fileOut, "%s\"%s\": %ld", (j++ > 0) ? ", " : "", mnemonics[i], counts[i]) < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		if (retVal == 0 && fprintf(fileOut, "}}\n") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+	} else {
+		retVal = 0;
+		if (fprintf(fileOut, "; Statistics of %s\n", imageName) < 0 ||
+		    fprintf(fileOut, "Words:          %8ld\n", statistics->numWords) < 0 ||
+		    fprintf(fileOut, "Instructions:   %8ld\n", statistics->numInstructions) < 0 ||
+		    fprintf(fileOut, "Data words:     %8ld  %5.1f%%\n", statistics->numDataWords, percent(statistics->numDataWords, statistics->numInstructions)) < 0 ||
+		    fprintf(fileOut, "Branches:       %8ld  %5.1f%%\n", statistics->numBranches, percent(statistics->numBranches, statistics->numInstructions)) < 0 ||
+		    fprintf(fileOut, "Skips:          %8ld  %5.1f%%\n", statistics->numSkips, percent(statistics->numSkips, statistics->numInstructions)) < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		if (retVal == 0 && statistics->numWords > 0 && fprintf(fileOut, "Address range:  %04X-%04X\n",
+		    (unsigned int)statistics->lowestAddress, (unsigned int)statistics->highestAddress) < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		if (retVal == 0 && device != NULL) {
+			if (fprintf(fileOut, "\nRegion usage (%s):\n", device->name) < 0 ||
+			    fprintf(fileOut, "  program       %8ld of %ld words  %5.1f%%\n", statistics->regionCounts[REGION_PROGRAM],
+			    (long)device->programMemorySize, percent(statistics->regionCounts[REGION_PROGRAM], device->programMemorySize)) < 0 ||
+			    fprintf(fileOut, "  idlocs        %8ld of %d words\n", statistics->regionCounts[REGION_ID_LOCATIONS], device->idLocations.size) < 0 ||
+			    fprintf(fileOut, "  config        %8ld of %d words\n", statistics->regionCounts[REGION_CONFIG], device->configWords.size) < 0 ||
+			    fprintf(fileOut, "  eeprom        %8ld of %d bytes\n", statistics->regionCounts[REGION_EEPROM], device->eeprom.size) < 0 ||
+			    fprintf(fileOut, "  unimplemented %8ld words\n", statistics->regionCounts[REGION_UNIMPLEMENTED]) < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		if (retVal == 0 && fprintf(fileOut, "\nInstruction        Count  Percent\n") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		for (i = 0; i < numMnemonics && retVal == 0; i++) {
+			if (counts[i] == 0)
+				continue;
+			if (fprintf(fileOut, "  %-12s %8ld  %5.1f%%\n", mnemonics[i], counts[i], percent(counts[i], statistics->numInstructions)) < 0)
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		if (retVal == 0 && fprintf(fileOut, "\n") < 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+	}
+
+	if (retVal < 0)
+		fprintf(stderr, "Error writing statistics to file!\n");
+
+	return retVal;
+}
+
@@ -0,0 +1,64 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * stats.h - Header file for the instruction statistics of program images,
+ *  gathered from the decoded instructions without formatting them.
+ *
+ */
+
+#ifndef STATS_DISASM_H
+#define STATS_DISASM_H
+
+#include <stdio.h>
+#include "pic_disasm.h"
+#include "pic_device.h"
+#include "image.h"
+
+/* Structure to hold the statistics of a program image. */
+struct _programStatistics {
+	int archSelect;
+	int deviceIndex;
+	/* Words read from the program file */
+	long numWords;
+	/* Words decoded as instructions, that is all words in program memory,
+	 * or all words if no device is selected */
+	long numInstructions;
+	/* Count of each instruction of the instruction set, by index */
+	long instructionCounts[PIC_TOTAL_PIC18_INSTRUCTIONS];
+	/* Words not recognized as any instruction */
+	long numDataWords;
+	/* Jumps, calls and returns, and conditional skips */
+	long numBranches;
+	long numSkips;
+	/* Words in each of the PIC_Memory_Regions, if a device is selected */
+	long regionCounts[REGION_UNIMPLEMENTED+1];
+	uint32_t lowestAddress, highestAddress;
+};
+typedef struct _programStatistics programStatistics;
+
+/* Decodes every word of a program image and counts the instructions,
+ * without disassembling them to text. deviceIndex is -1 if no device is
+ * selected. */
+int collectStatistics(programStatistics *statistics, const programImage *image, int archSelect, int deviceIndex);
+
+/* Prints the statistics as a table, or as a single line JSON object. */
+int printStatistics(FILE *fileOut, const char *imageName, const programStatistics *statistics, int json);
+
+#endif
+
@@ -26,19 +26,52 @@
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
+#include <unistd.h>
 #include "file.h"
+#include "diff.h"
+#include "search.h"
+#include "signature.h"
+#include "stats.h"
+#include "columns.h"
+#include "assemble.h"
+#include "simulate.h"
+#include "cache.h"
+#include "decompress.h"
+#include "incremental.h"
+#include "recordindex.h"
+#include "view.h"
+#include "convert.h"
+#include "recordscan.h"
+#include "archdetect.h"
+#include "profile.h"
+#include "pic_device.h"
 #include "errorcodes.h"
 
+/* Program version, also part of the result cache keys */
+#define PROGRAM_VERSION		"1.3 - 04/03/2011"
+
 /* Flags for some long options that don't have a short option equivilant */
 static int no_addresses = 0;				/* Flag for --no-addresses */
 static int literal_base = 0;				/* Value of the literal base (hex, bin, dec) */
 static int literal_ascii_comment = 0;			/* Flag for --literal-ascii */
 static int no_destination_comments = 0;			/* Flag for --no-destination-comments */
 static int original_opcode = 0;				/* Flag for --original */
+static int resolve_addresses = 0;			/* Flag for --resolve-addresses */
+static int diff_mode = 0;				/* Flag for --diff */
+static int verify_roundtrip = 0;			/* Flag for --verify-roundtrip */
+static int validate_mode = 0;				/* Flag for --validate */
+static int keep_going = 0;				/* Flag for --keep-going */
+
+/* Policy for overlapping records selected with --overlap, -1 for none */
+static int overlapPolicy = -1;
+
+/* Address range selected with --start and --end */
+static uint32_t rangeStart = 0, rangeEnd = UINT32_MAX;
 
 static struct option long_options[] = {
 	{"address-label", required_argument, NULL, 'l'},
 	{"arch", required_argument, NULL, 'a'},
+	{"device", required_argument, NULL, 'd'},
 	{"out-file", required_argument, NULL, 'o'},
 	{"file-type", required_argument, NULL, 't'},
 	{"no-addresses", no_argument, &no_addresses, 1},
@@ -48,19 +81,57 @@ static struct option long_options[] = {
 	{"literal-ascii", no_argument, &literal_ascii_comment, 1},
 	{"original", no_argument, &original_opcode, 1},
 	{"no-destination-comments", no_argument, &no_destination_comments, 1},
+	{"resolve-addresses", no_argument, &resolve_addresses, 1},
+	{"diff", no_argument, &diff_mode, 1},
+	{"verify-roundtrip", no_argument, &verify_roundtrip, 1},
+	{"validate", no_argument, &validate_mode, 1},
+	{"keep-going", no_argument, &keep_going, 1},
+	{"overlap", required_argument, NULL, 'O'},
+	{"simulate", optional_argument, NULL, 'S'},
+	{"cache", required_argument, NULL, 'K'},
+	{"incremental", required_argument, NULL, 'I'},
+	{"start", required_argument, NULL, 'b'},
+	{"end", required_argument, NULL, 'e'},
+	{"view", optional_argument, NULL, 'V'},
+	{"convert", required_argument, NULL, 'c'},
+	{"patch", required_argument, NULL, 'p'},
+	{"search", required_argument, NULL, 's'},
+	{"signatures", required_argument, NULL, 'g'},
+	{"build-signatures", required_argument, NULL, 'G'},
+	{"stats", optional_argument, NULL, 'T'},
+	{"export-columns", required_argument, NULL, 'X'},
+	{"profile", optional_argument, NULL, 'P'},
+	{"perf-counters", no_argument, NULL, 'C'},
+	{"output-format", required_argument, NULL, 'F'},
 	{"help", no_argument, NULL, 'h'},
 	{"version", no_argument, NULL, 'v'},
 	{NULL, 0, NULL, 0}
 };
 
 static void printUsage(FILE *stream, const char *programName) {
+	int i;
+
 	fprintf(stream, "Usage: %s <option(s)> <file>\n", programName);
+	fprintf(stream, "       %s --diff <option(s)> <old file> <new file>\n", programName);
+	fprintf(stream, "       %s --search <pattern> <option(s)> <file(s)>\n", programName);
+	fprintf(stream, "       %s --stats[=json] <option(s)> <file(s)>\n", programName);
+	fprintf(stream, "       %s --export-columns <directory> <option(s)> <file(s)>\n", programName);
+	fprintf(stream, "       %s --verify-roundtrip <option(s)> <file>\n", programName);
+	fprintf(stream, "       %s --validate <option(s)> <file(s)>\n", programName);
+	fprintf(stream, "       %s --simulate[=<stop conditions>] <option(s)> <file>\n", programName);
+	fprintf(stream, "       %s --view[=<cache KB>] <option(s)> <file>\n", programName);
+	fprintf(stream, "       %s --convert <format> [--patch <patches>] -o <output file> <file>\n", programName);
+	fprintf(stream, "       %s --build-signatures <source file> -o <signature database>\n", programName);
 	fprintf(stream, " Disassembles PIC program file <file>. Use - for standard input.\n");
 	fprintf(stream, " Written by Vanya A. Sergeev - <vsergeev@gmail.com>.\n\n");
 	fprintf(stream, " Additional Options:\n\
   -o, --out-file <output file>	Write to output file instead of standard output.\n\
   -a, --arch <architecture>	Specify the 8-bit PIC architecture to use\n\
-				during disassembly.\n\
+				during disassembly, or auto to pick the\n\
+				one the program decodes best under.\n\
+  -d, --device <device>		Specify the PIC device, to print special\n\
+				function register names (implies\n\
+				--resolve-addresses).\n\
   -t, --file-type <type>	Specify the file type of the object file.\n\
   -l, --address-label <prefix> 	Create ghetto address labels with\n\
 				the specified label prefix.\n\
@@ -75,41 +146,354 @@ static void printUsage(FILE *stream, const char *programName) {
   --literal-dec			Represent literals in decimal\n\
   --literal-ascii		Show ASCII value of literal operands in a\n\
 				comment\n\
+  --resolve-addresses		Track the page and bank selection to print\n\
+				full call/goto and register addresses.\n\
+  --diff			Compare two program files and print the\n\
+				changed, inserted and removed blocks.\n\
+  --search <pattern>		Print the addresses of the instruction\n\
+				sequences matching the pattern, e.g.\n\
+				\"movlw *; movwf 0x0B; bsf *, 7\".\n\
+  --signatures <database>	Name the library functions recognized with\n\
+				the signature database.\n\
+  --build-signatures <source>	Compile a signature database source file.\n\
+  --stats[=json]		Print instruction statistics instead of the\n\
+				disassembly, as a table or as JSON.\n\
+  --export-columns <directory>	Write the decoded instructions of the files\n\
+				as fixed width column files.\n\
+  --verify-roundtrip		Check that the disassembly assembles back\n\
+				to the program, and print the words that\n\
+				don't.\n\
+  --validate			Only check the records of the files, and\n\
+				print every error with its line number.\n\
+  --keep-going			Skip the malformed records of the file,\n\
+				print them, and disassemble the rest.\n\
+  --overlap <policy>		Report the words written more than once and\n\
+				keep the first or last one, or fail on\n\
+				different data (first, last, error).\n\
+  --simulate[=<conditions>]	Run the program in the instruction set\n\
+				simulator until a stop condition, e.g.\n\
+				\"pc=0x1F,cycles=100000,0x20=5\".\n\
+  --cache <directory>		Keep the disassembly of every input and set\n\
+				of options in the directory, and copy it\n\
+				from there when it is requested again.\n\
+  --incremental <state file>	Keep the disassembly of every page in the\n\
+				state file, and only disassemble the pages\n\
+				that changed since the previous run again.\n\
+  --start <address>		Only read the words from this address on,\n\
+				seeking with an index of the records.\n\
+  --end <address>		Only read the words up to this address.\n\
+  --view[=<cache KB>]		Read address ranges, e.g. \"0x100 0x1FF\",\n\
+				from standard input and print the\n\
+				disassembly of each, rendering it lazily.\n\
+  --convert <format>		Write the program as an ihex, srecord or\n\
+				binary file instead of disassembling it.\n\
+  --patch <patches>		Replace words before converting, e.g.\n\
+				\"0x2000=0x12,0x2001=0x34\".\n\
+  --output-format <format>	Write the disassembly as text (default),\n\
+				jsonl (a JSON object per line) or binary\n\
+				records.\n\
+  --profile[=json]		Print the time spent in each stage and the\n\
+				work done to standard error at exit.\n\
+  --perf-counters		Also count cycles, instructions, branch and\n\
+				L1D cache misses per stage in the profile.\n\
   -h, --help			Display this usage/help.\n\
   -v, --version			Display the program's version.\n\n");
 	fprintf(stream, "Supported 8-bit PIC Architectures:\n\
   Baseline 			baseline\n\
   Mid-Range			midrange (default)\n\
-  Enhanced Mid-Range		enhanced\n\n");
+  Enhanced Mid-Range		enhanced\n\
+  Detect from the program	auto\n\n");
 	fprintf(stream, "Supported file types:\n\
   Intel HEX8 			ihex\n\
   Motorola S-Record 		srecord\n\n");
+	fprintf(stream, "Supported PIC devices:\n ");
+	for (i = 0; i < numDevices; i++)
+		fprintf(stream, " %s", allDevices[i].name);
+	fprintf(stream, "\n\n");
 }
 
 static void printVersion(FILE *stream) {
-	fprintf(stream, "vPICdisasm version 1.3 - 04/03/2011.\n");
+	fprintf(stream, "vPICdisasm version %s.\n", PROGRAM_VERSION);
 	fprintf(stream, "Written by Vanya Sergeev - <vsergeev@gmail.com>\n");
 }
 
+/* Recognizes the file type of a program file by its first character. */
+static int detectFileType(FILE *fileIn, char *fileType) {
+	int c;
+
+	c = fgetc(fileIn);
+	/* Intel HEX record statements start with : */
+	if ((char)c == ':')
+		strcpy(fileType, "ihex");
+	/* Motorola S-Record record statements start with S */
+	else if ((char)c == 'S')
+		strcpy(fileType, "srecord");
+	else {
+		fprintf(stderr, "Unable to auto-recognize file type by first character.\n");
+		fprintf(stderr, "Please specify file type with -t,--file-type option.\n");
+		return -1;
+	}
+	ungetc(c, fileIn);
+
+	return 0;
+}
+
+/* Reads all of a program file into memory, decompressing it if it is
+ * compressed. */
+static int readWholeProgramFile(const char *fileName, char **data, size_t *size) {
+	FILE *fileIn;
+	int retVal;
+
+	if (strcmp(fileName, "-") == 0) {
+		fileIn = stdin;
+	} else {
+		fileIn = fopen(fileName, "r");
+		if (fileIn == NULL) {
+			perror("Error: Cannot open program file");
+			return ERROR_FILE_READING_ERROR;
+		}
+	}
+	fileIn = decompressFile(profileFile(fileIn, "r"));
+	if (fileIn == NULL)
+		return ERROR_FILE_READING_ERROR;
+
+	retVal = readWholeFile(fileIn, data, size);
+	if (retVal == ERROR_MEMORY_ALLOCATION_ERROR)
+		fprintf(stderr, "Error allocating sufficient memory for program file!\n");
+	else if (retVal < 0)
+		perror("Error: Cannot read program file");
+
+	if (fileIn != stdin)
+		fclose(fileIn);
+
+	return retVal;
+}
+
+/* Reads a program file into a program image, see readProgramFile(). */
+static int loadProgramFile(programImage *image, const char *fileName, const char *fileType) {
+	FILE *fileIn;
+	recordScanner scanner;
+	char detectedType[8];
+	char *data;
+	size_t size;
+	int retVal;
+
+	/* Going on after malformed records needs the line structure of the
+	 * whole file, which the record scanner reads from memory */
+	if (keep_going) {
+		retVal = readWholeProgramFile(fileName, &data, &size);
+		if (retVal < 0)
+			return retVal;
+		retVal = initRecordScanner(&scanner, data, size, fileType, fileName, stderr);
+		if (retVal < 0) {
+			fprintf(stderr, "Unable to recognize the file type of %s.\n", fileName);
+			fprintf(stderr, "Please specify file type with -t,--file-type option.\n");
+		} else {
+			retVal = readScannedRecords(&scanner, image);
+		}
+		free(data);
+		if (retVal == 0 && (rangeStart != 0 || rangeEnd != UINT32_MAX))
+			selectProgramImageRange(image, rangeStart, rangeEnd);
+		return retVal;
+	}
+
+	/* With an address range, only the records of the range are read
+	 * where the file can be indexed */
+	if (rangeStart != 0 || rangeEnd != UINT32_MAX) {
+		retVal = readIndexedRange(image, fileName, fileType, rangeStart, rangeEnd);
+		if (retVal != 1)
+			return retVal;
+	}
+
+	if (strcmp(fileName, "-") == 0) {
+		fileIn = stdin;
+	} else {
+		fileIn = fopen(fileName, "r");
+		if (fileIn == NULL) {
+			perror("Error: Cannot open program file for disassembly");
+			return ERROR_FILE_READING_ERROR;
+		}
+	}
+	/* Compressed program files are decompressed while they are read */
+	fileIn = decompressFile(profileFile(fileIn, "r"));
+	if (fileIn == NULL)
+		return ERROR_FILE_READING_ERROR;
+
+	strcpy(detectedType, fileType);
+	if (detectedType[0] == '\0' && detectFileType(fileIn, detectedType) < 0)
+		retVal = ERROR_FILE_READING_ERROR;
+	else if (strcasecmp(detectedType, "ihex") == 0)
+		retVal = readIHexFile(image, fileIn);
+	else if (strcasecmp(detectedType, "srecord") == 0)
+		retVal = readSRecordFile(image, fileIn);
+	else {
+		fprintf(stderr, "Unknown file type %s.\n", detectedType);
+		fprintf(stderr, "See program help/usage for supported file types.\n");
+		retVal = ERROR_INVALID_ARGUMENTS;
+	}
+
+	if (fileIn != stdin)
+		fclose(fileIn);
+
+	if (retVal == 0 && (rangeStart != 0 || rangeEnd != UINT32_MAX))
+		selectProgramImageRange(image, rangeStart, rangeEnd);
+
+	return retVal;
+}
+
+/* Reads a program file into a program image, recognizing its file type
+ * unless one was specified, and resolving the overlapping records if an
+ * overlap policy was selected. */
+static int readProgramFile(programImage *image, const char *fileName, const char *fileType) {
+	int retVal;
+
+	retVal = loadProgramFile(image, fileName, fileType);
+	if (retVal == 0 && overlapPolicy >= 0)
+		retVal = resolveProgramImageOverlaps(image, fileName, overlapPolicy);
+
+	return retVal;
+}
+
+/* Picks the architecture that a program image decodes best under, and
+ * reports the scores on standard error. */
+static int detectImageArchitecture(const programImage *image, const char *fileName) {
+	/* Names of the PIC_Instruction_Set_Index architectures */
+	static const char *archNames[] = {"baseline", "midrange", "enhanced"};
+	architectureScore scores[ARCH_DETECT_NUM_CANDIDATES];
+	int i, confidence, retVal;
+
+	retVal = detectArchitecture(image, scores, &confidence);
+	if (retVal < 0) {
+		fprintf(stderr, "Error allocating sufficient memory for architecture detection!\n");
+		return retVal;
+	}
+
+	fprintf(stderr, "%s: %s architecture, %d%% confidence (scores:", fileName, archNames[retVal], confidence);
+	for (i = 0; i < ARCH_DETECT_NUM_CANDIDATES; i++)
+		fprintf(stderr, " %s %d", archNames[scores[i].archSelect], scores[i].score);
+	fprintf(stderr, ")\n");
+
+	return retVal;
+}
+
+/* Picks the architecture that a program file decodes best under, see
+ * detectImageArchitecture(). */
+static int detectProgramArchitecture(const char *fileName, const char *fileType) {
+	programImage image;
+	int retVal;
+
+	/* The words written more than once don't change the scores much,
+	 * and are reported when the file is read again */
+	initProgramImage(&image);
+	retVal = loadProgramFile(&image, fileName, fileType);
+	if (retVal == 0)
+		retVal = detectImageArchitecture(&image, fileName);
+	freeProgramImage(&image);
+
+	return retVal;
+}
+
+/* Hashes the input and everything else that determines the disassembly
+ * into the key of its result cache entry: the options, the file type, the
+ * contents of the signature database, and the program and output
+ * versions. */
+static int hashCacheOptions(cacheKey *key, const char *input, size_t inputSize, const char *fileType, const char *signaturesFileName, formattingOptions fOptions, int archSelect) {
+	struct {
+		int archSelect, options, addressFieldWidth, deviceIndex, outputFormat;
+		char addressLabelPrefix[8], fileType[8];
+	} options;
+	char *signatures;
+	size_t signaturesSize;
+	FILE *fileIn;
+	int outputVersion = CACHE_OUTPUT_VERSION;
+	int retVal;
+
+	initCacheKey(key);
+	hashCacheKey(key, PROGRAM_VERSION, strlen(PROGRAM_VERSION));
+	hashCacheKey(key, &outputVersion, sizeof(outputVersion));
+	hashCacheKey(key, input, inputSize);
+
+	/* Zeroed so the padding hashes the same every time */
+	memset(&options, 0, sizeof(options));
+	options.archSelect = archSelect;
+	options.options = fOptions.options;
+	options.addressFieldWidth = fOptions.addressFieldWidth;
+	options.deviceIndex = fOptions.deviceIndex;
+	options.outputFormat = fOptions.outputFormat;
+	if (fOptions.options & FORMAT_OPTION_ADDRESS_LABEL)
+		memcpy(options.addressLabelPrefix, fOptions.addressLabelPrefix, sizeof(options.addressLabelPrefix));
+	strncpy(options.fileType, fileType, sizeof(options.fileType)-1);
+	hashCacheKey(key, &options, sizeof(options));
+
+	if (signaturesFileName != NULL) {
+		fileIn = fopen(signaturesFileName, "rb");
+		if (fileIn == NULL)
+			return ERROR_FILE_READING_ERROR;
+		retVal = readWholeFile(fileIn, &signatures, &signaturesSize);
+		fclose(fileIn);
+		if (retVal < 0)
+			return retVal;
+		hashCacheKey(key, signatures, signaturesSize);
+		free(signatures);
+	}
+
+	return 0;
+}
+
 int main(int argc, const char *argv[]) {
 	int optc;
 	FILE *fileIn, *fileOut;
-	char arch[9], fileType[8];
-	int archSelect;
+	char arch[9], fileType[8], device[16];
+	const char *searchPatternText = NULL;
+	const char *signaturesFileName = NULL, *signaturesSourceName = NULL;
+	signatureDatabase signatures;
+	int statsMode = 0;
+	const char *exportDirectory = NULL;
+	int profileFormat = PROFILE_OFF, perfCounters = 0;
+	int simulateMode = 0;
+	const char *stopConditions = NULL;
+	const char *cacheDirectory = NULL;
+	const char *incrementalState = NULL;
+	unsigned long address;
+	char *endPtr;
+	size_t viewBudget = 0;
+	int convertFormat = -1;
+	const char **patches;
+	int numPatches = 0;
+	char cacheTempPath[CACHE_MAX_PATH_LENGTH];
+	cacheKey key;
+	FILE *resultOut = NULL;
+	char *input = NULL;
+	size_t inputSize;
+	int retVal;
+	int archSelect, autoArch = 0, detectPerFile = 0;
 	int (*disassembleFile)(FILE *, FILE *, formattingOptions, int);
 	formattingOptions fOptions;
 
+	patches = malloc(argc*sizeof(const char *));
+	if (patches == NULL) {
+		fprintf(stderr, "Error allocating sufficient memory for the options!\n");
+		exit(EXIT_FAILURE);
+	}
+
 	/* Recent flag options */
 	fOptions.options = 0;
 	/* Set default address field width for this version. */
 	fOptions.addressFieldWidth = 3;
+	/* No device selected by default */
+	fOptions.deviceIndex = -1;
+	/* No library function signatures by default */
+	fOptions.signatures = NULL;
+	/* Assembly text output by default */
+	fOptions.outputFormat = OUTPUT_FORMAT_TEXT;
 	/* Default output file to stdout */
 	fileOut = stdout;
 
 	arch[0] = '\0';
 	fileType[0] = '\0';
+	device[0] = '\0';
 	while (1) {
-		optc = getopt_long(argc, (char * const *)argv, "o:a:t:l:hv", long_options, NULL);
+		optc = getopt_long(argc, (char * const *)argv, "o:a:d:t:l:hv", long_options, NULL);
 		if (optc == -1)
 			break;
 		switch (optc) {
@@ -126,6 +510,117 @@ int main(int argc, const char *argv[]) {
 			case 'a':
 				strncpy(arch, optarg, sizeof(arch));
 				break;
+			case 'd':
+				strncpy(device, optarg, sizeof(device)-1);
+				device[sizeof(device)-1] = '\0';
+				break;
+			case 's':
+				searchPatternText = optarg;
+				break;
+			case 'g':
+				signaturesFileName = optarg;
+				break;
+			case 'G':
+				signaturesSourceName = optarg;
+				break;
+			case 'F':
+				if (strcasecmp(optarg, "text") == 0)
+					fOptions.outputFormat = OUTPUT_FORMAT_TEXT;
+				else if (strcasecmp(optarg, "jsonl") == 0)
+					fOptions.outputFormat = OUTPUT_FORMAT_JSONL;
+				else if (strcasecmp(optarg, "binary") == 0)
+					fOptions.outputFormat = OUTPUT_FORMAT_BINARY;
+				else {
+					fprintf(stderr, "Unknown output format %s.\n", optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'P':
+				if (optarg == NULL || strcasecmp(optarg, "text") == 0)
+					profileFormat = PROFILE_TEXT;
+				else if (strcasecmp(optarg, "json") == 0)
+					profileFormat = PROFILE_JSON;
+				else {
+					fprintf(stderr, "Unknown profile format %s.\n", optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'C':
+				perfCounters = 1;
+				break;
+			case 'S':
+				simulateMode = 1;
+				stopConditions = optarg;
+				break;
+			case 'K':
+				cacheDirectory = optarg;
+				break;
+			case 'I':
+				incrementalState = optarg;
+				break;
+			case 'c':
+				if (strcasecmp(optarg, "ihex") == 0)
+					convertFormat = CONVERT_IHEX;
+				else if (strcasecmp(optarg, "srecord") == 0)
+					convertFormat = CONVERT_SRECORD;
+				else if (strcasecmp(optarg, "binary") == 0)
+					convertFormat = CONVERT_BINARY;
+				else {
+					fprintf(stderr, "Unknown conversion format %s.\n", optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'p':
+				patches[numPatches++] = optarg;
+				break;
+			case 'O':
+				if (strcasecmp(optarg, "error") == 0)
+					overlapPolicy = OVERLAP_ERROR;
+				else if (strcasecmp(optarg, "first") == 0)
+					overlapPolicy = OVERLAP_FIRST;
+				else if (strcasecmp(optarg, "last") == 0)
+					overlapPolicy = OVERLAP_LAST;
+				else {
+					fprintf(stderr, "Unknown overlap policy %s.\n", optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'V':
+				viewBudget = VIEW_DEFAULT_BUDGET;
+				if (optarg != NULL) {
+					address = strtoul(optarg, &endPtr, 0);
+					if (optarg[0] == '\0' || *endPtr != '\0' || address == 0) {
+						fprintf(stderr, "Invalid view cache size %s.\n", optarg);
+						exit(EXIT_FAILURE);
+					}
+					viewBudget = (size_t)address*1024;
+				}
+				break;
+			case 'b':
+			case 'e':
+				address = strtoul(optarg, &endPtr, 0);
+				if (optarg[0] == '\0' || *endPtr != '\0' || address > UINT32_MAX) {
+					fprintf(stderr, "Invalid address %s.\n", optarg);
+					exit(EXIT_FAILURE);
+				}
+				if (optc == 'b')
+					rangeStart = address;
+				else
+					rangeEnd = address;
+				break;
+			case 'X':
+				exportDirectory = optarg;
+				break;
+			case 'T':
+				if (optarg == NULL || strcasecmp(optarg, "table") == 0)
+					statsMode = 1;
+				else if (strcasecmp(optarg, "json") == 0)
+					statsMode = 2;
+				else {
+					fprintf(stderr, "Unknown statistics format %s.\n", optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
 			case 'o':
 				if (strcmp(optarg, "-") != 0)
 					fileOut = fopen(optarg, "w");
@@ -142,6 +637,11 @@ int main(int argc, const char *argv[]) {
 		}
 	}
 
+	if (rangeStart > rangeEnd) {
+		fprintf(stderr, "Invalid address range, --start 0x%X is after --end 0x%X.\n", rangeStart, rangeEnd);
+		exit(EXIT_FAILURE);
+	}
+
 	if (!no_addresses)
 		fOptions.options |= FORMAT_OPTION_ADDRESS;
 	if (!no_destination_comments)
@@ -160,53 +660,69 @@ int main(int argc, const char *argv[]) {
 	if (original_opcode)
 		fOptions.options |= FORMAT_OPTION_ORIGINAL_OPCODE;
 
+	if (resolve_addresses)
+		fOptions.options |= FORMAT_OPTION_RESOLVE_ADDRESSES;
+
+	/* Labels and org directives only make sense in assembly text */
+	if (fOptions.outputFormat != OUTPUT_FORMAT_TEXT)
+		fOptions.options &= ~FORMAT_OPTION_ADDRESS_LABEL;
+
 	if (fileOut == NULL) {
 		perror("Error: Cannot open output file for writing");
 		exit(EXIT_FAILURE);
 	}
 
-	/* If there are no more arguments left */
-	if (optind == argc) {
-		fprintf(stderr, "Error: No program file specified! Use - for standard input.\n\n");
-		printUsage(stderr, argv[0]);
-		if (fileOut != stdout)
-			fclose(fileOut);
-		exit(EXIT_FAILURE);
+	/* Time the whole run, including the writes of the output */
+	if (perfCounters && profileFormat == PROFILE_OFF)
+		profileFormat = PROFILE_TEXT;
+	if (profileFormat != PROFILE_OFF) {
+		if (startProfile(profileFormat) < 0) {
+			fprintf(stderr, "Error: Cannot start profiling!\n");
+			exit(EXIT_FAILURE);
+		}
+		/* Without the counters the timings are still worth printing */
+		if (perfCounters)
+			startPerfCounters();
+		fileOut = profileFile(fileOut, "w");
 	}
 
-	/* Support reading from stdin with filename "-" */
-	if (strcmp(argv[optind], "-") == 0) {
-		fileIn = stdin;
-	} else {
-		fileIn = fopen(argv[optind], "r");
+	/* Compile a signature database source file instead of disassembling */
+	if (signaturesSourceName != NULL) {
+		int retVal;
+
+		fileIn = fopen(signaturesSourceName, "r");
 		if (fileIn == NULL) {
-			perror("Error: Cannot open program file for disassembly");
+			perror("Error: Cannot open signature database source file");
 			if (fileOut != stdout)
 				fclose(fileOut);
 			exit(EXIT_FAILURE);
 		}
+		retVal = buildSignatureDatabase(fileOut, fileIn);
+		fclose(fileIn);
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit((retVal == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
 	}
 
-	/* If no file type was specified, try to auto-recognize the first character of the file */
-	if (fileType[0] == '\0') {
-		int c;
-		c = fgetc(fileIn);
-		/* Intel HEX record statements start with : */
-		if ((char)c == ':')
-			strcpy(fileType, "ihex");
-		/* Motorola S-Record record statements start with S */
-		else if ((char)c == 'S')
-			strcpy(fileType, "srecord");
-		else {
-			fprintf(stderr, "Unable to auto-recognize file type by first character.\n");
-			fprintf(stderr, "Please specify file type with -t,--file-type option.\n");
+	/* Load the signature database of known library functions */
+	if (signaturesFileName != NULL) {
+		int retVal;
+
+		fileIn = fopen(signaturesFileName, "rb");
+		if (fileIn == NULL) {
+			perror("Error: Cannot open signature database");
 			if (fileOut != stdout)
 				fclose(fileOut);
-			if (fileIn != stdin)
-				fclose(fileIn);
 			exit(EXIT_FAILURE);
 		}
-		ungetc(c, fileIn);
+		retVal = loadSignatureDatabase(&signatures, fileIn);
+		fclose(fileIn);
+		if (retVal < 0) {
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+		fOptions.signatures = &signatures;
 	}
 
 	/* If no architecture was specified, use midrange by default */
@@ -219,17 +735,553 @@ int main(int argc, const char *argv[]) {
 			archSelect = PIC_MIDRANGE;
 		else if (strcasecmp(arch, "enhanced") == 0)
 			archSelect = PIC_MIDRANGE_ENHANCED;
+		else if (strcasecmp(arch, "auto") == 0)
+			autoArch = 1;
 		else {
 			fprintf(stderr, "Unknown 8-bit PIC architecture %s.\n", arch);
 			fprintf(stderr, "See program help/usage for supported PIC architectures.\n");
 			if (fileOut != stdout)
 				fclose(fileOut);
-			if (fileIn != stdin)
-				fclose(fileIn);
 			exit(EXIT_FAILURE);
 		}
 	}
 
+	/* Look up the device, which also determines the architecture if none
+	 * was specified */
+	if (device[0] != '\0') {
+		fOptions.deviceIndex = lookupDevice(device);
+		if (fOptions.deviceIndex < 0 || (arch[0] != '\0' && !autoArch && allDevices[fOptions.deviceIndex].archSelect != archSelect)) {
+			if (fOptions.deviceIndex < 0)
+				fprintf(stderr, "Unknown PIC device %s.\n", device);
+			else
+				fprintf(stderr, "PIC device %s does not match the %s architecture.\n", device, arch);
+			fprintf(stderr, "See program help/usage for supported PIC devices.\n");
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+		archSelect = allDevices[fOptions.deviceIndex].archSelect;
+		/* Register names depend on the selected bank */
+		fOptions.options |= FORMAT_OPTION_RESOLVE_ADDRESSES;
+		/* Size the address field to the device's program memory */
+		fOptions.addressFieldWidth = 1;
+		while ((allDevices[fOptions.deviceIndex].programMemorySize-1) >> (4*fOptions.addressFieldWidth))
+			fOptions.addressFieldWidth++;
+	} else if (autoArch && (searchPatternText != NULL || statsMode != 0)) {
+		/* Searches and statistics detect the architecture of every
+		 * program file after reading it */
+		archSelect = PIC_MIDRANGE;
+		detectPerFile = 1;
+	} else if (autoArch) {
+		/* The columns of an export and the checks of a validation are
+		 * for a single architecture */
+		if (argc-optind > 1 && (exportDirectory != NULL || validate_mode)) {
+			fprintf(stderr, "Error: --arch auto can't pick a single architecture for %s of several program files!\n",
+				(exportDirectory != NULL) ? "the columns" : "the validation");
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+		/* Detect the architecture from the first program file, which
+		 * is read again by the mode that runs */
+		if (optind == argc || strcmp(argv[optind], "-") == 0) {
+			fprintf(stderr, "Error: --arch auto needs a program file, standard input can't be read twice!\n");
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+		archSelect = detectProgramArchitecture(argv[optind], fileType);
+		if (archSelect < 0) {
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	/* Compare two program files instead of disassembling one */
+	if (diff_mode) {
+		programImage oldImage, newImage;
+		int retVal;
+
+		if (argc-optind != 2) {
+			fprintf(stderr, "Error: --diff needs an old and a new program file!\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		initProgramImage(&oldImage);
+		initProgramImage(&newImage);
+		retVal = readProgramFile(&oldImage, argv[optind], fileType);
+		if (retVal == 0)
+			retVal = readProgramFile(&newImage, argv[optind+1], fileType);
+		if (retVal == 0)
+			retVal = diffProgramImages(fileOut, &oldImage, &newImage, fOptions, archSelect);
+		freeProgramImage(&oldImage);
+		freeProgramImage(&newImage);
+
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit((retVal == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	/* Search any number of program files for an instruction pattern */
+	if (searchPatternText != NULL) {
+		programImage image;
+		searchPattern pattern, patterns[ARCH_DETECT_NUM_CANDIDATES];
+		int compiled[ARCH_DETECT_NUM_CANDIDATES] = {0};
+		int fileArch, retVal, failed = 0;
+
+		if (!detectPerFile && compileSearchPattern(&pattern, searchPatternText, archSelect) < 0) {
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+		if (optind == argc) {
+			fprintf(stderr, "Error: No program file specified! Use - for standard input.\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		/* Keep going past files that can't be read, so one bad file
+		 * doesn't stop a search over many */
+		for (; optind < argc; optind++) {
+			initProgramImage(&image);
+			retVal = readProgramFile(&image, argv[optind], fileType);
+			/* The pattern is compiled once for every architecture found */
+			if (retVal == 0 && detectPerFile) {
+				fileArch = detectImageArchitecture(&image, argv[optind]);
+				if (fileArch >= 0 && !compiled[fileArch]) {
+					if (compileSearchPattern(&patterns[fileArch], searchPatternText, fileArch) < 0)
+						fileArch = ERROR_INVALID_ARGUMENTS;
+					else
+						compiled[fileArch] = 1;
+				}
+				if (fileArch < 0)
+					retVal = fileArch;
+				else
+					pattern = patterns[fileArch];
+			}
+			if (retVal == 0)
+				retVal = searchProgramImage(fileOut, argv[optind], &image, &pattern, fOptions);
+			if (retVal < 0) {
+				fprintf(stderr, "Error searching program file %s.\n", argv[optind]);
+				failed = 1;
+			}
+			freeProgramImage(&image);
+		}
+
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+	}
+
+	/* Print the statistics of any number of program files */
+	if (statsMode != 0) {
+		programImage image;
+		programStatistics statistics;
+		int retVal, failed = 0;
+
+		if (optind == argc) {
+			fprintf(stderr, "Error: No program file specified! Use - for standard input.\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		for (; optind < argc; optind++) {
+			initProgramImage(&image);
+			retVal = readProgramFile(&image, argv[optind], fileType);
+			if (retVal == 0 && detectPerFile) {
+				archSelect = detectImageArchitecture(&image, argv[optind]);
+				if (archSelect < 0)
+					retVal = archSelect;
+			}
+			if (retVal == 0)
+				retVal = collectStatistics(&statistics, &image, archSelect, fOptions.deviceIndex);
+			if (retVal == 0)
+				retVal = printStatistics(fileOut, argv[optind], &statistics, statsMode == 2);
+			if (retVal < 0) {
+				fprintf(stderr, "Error collecting statistics of program file %s.\n", argv[optind]);
+				failed = 1;
+			}
+			freeProgramImage(&image);
+		}
+
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+	}
+
+	/* Export the decoded instructions of any number of program files as
+	 * columns */
+	if (exportDirectory != NULL) {
+		programImage image;
+		columnExport export;
+		int retVal, failed = 0;
+
+		if (optind == argc) {
+			fprintf(stderr, "Error: No program file specified! Use - for standard input.\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		if (openColumnExport(&export, exportDirectory, archSelect, fOptions.deviceIndex) < 0) {
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		/* Files that can't be read are left out of the export */
+		for (; optind < argc; optind++) {
+			initProgramImage(&image);
+			retVal = readProgramFile(&image, argv[optind], fileType);
+			if (retVal == 0)
+				retVal = exportProgramImage(&export, argv[optind], &image);
+			if (retVal < 0) {
+				fprintf(stderr, "Error exporting program file %s.\n", argv[optind]);
+				failed = 1;
+			}
+			freeProgramImage(&image);
+		}
+
+		if (closeColumnExport(&export) < 0)
+			failed = 1;
+
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+	}
+
+	/* Only check the records of the program files */
+	if (validate_mode) {
+		recordScanner scanner;
+		char *data;
+		size_t size;
+		int failed = 0;
+
+		if (optind == argc) {
+			fprintf(stderr, "Error: No program file specified! Use - for standard input.\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		for (; optind < argc; optind++) {
+			if (readWholeProgramFile(argv[optind], &data, &size) < 0) {
+				failed = 1;
+				continue;
+			}
+			if (initRecordScanner(&scanner, data, size, fileType, argv[optind], fileOut) < 0) {
+				fprintf(fileOut, "%s: not an Intel HEX or Motorola S-Record file\n", argv[optind]);
+				failed = 1;
+			} else if (validateRecords(&scanner, archSelect) > 0) {
+				failed = 1;
+			}
+			free(data);
+		}
+
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+	}
+
+	/* Check that the disassembly assembles back to the program */
+	if (verify_roundtrip) {
+		programImage image;
+		int retVal;
+
+		if (argc-optind != 1) {
+			fprintf(stderr, "Error: --verify-roundtrip needs one program file!\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		initProgramImage(&image);
+		retVal = readProgramFile(&image, argv[optind], fileType);
+		if (retVal == 0)
+			retVal = verifyRoundTrip(fileOut, &image, fOptions, archSelect);
+		freeProgramImage(&image);
+
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit((retVal == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	/* Run the program in the simulator instead of disassembling it */
+	if (simulateMode) {
+		programImage image;
+		simulator sim;
+		int retVal;
+
+		if (argc-optind != 1) {
+			fprintf(stderr, "Error: --simulate needs one program file!\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+		if (archSelect != PIC_MIDRANGE && archSelect != PIC_MIDRANGE_ENHANCED) {
+			fprintf(stderr, "Error: Only the midrange and enhanced architectures can be simulated!\n");
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		initProgramImage(&image);
+		retVal = readProgramFile(&image, argv[optind], fileType);
+		if (retVal == 0) {
+			retVal = initSimulator(&sim, &image, archSelect, fOptions.deviceIndex);
+			if (retVal == ERROR_MEMORY_ALLOCATION_ERROR)
+				fprintf(stderr, "Error allocating sufficient memory for the simulator!\n");
+			else if (retVal < 0)
+				fprintf(stderr, "Encountered an irrecoverable error during pre-decoding!\n");
+		}
+		freeProgramImage(&image);
+		if (retVal == 0) {
+			if (stopConditions != NULL)
+				retVal = parseStopConditions(&sim, stopConditions, fOptions.deviceIndex);
+			if (retVal == 0) {
+				/* Running into a word that isn't an instruction is a failure */
+				if (runSimulator(&sim) == SIM_STOP_INVALID_INSTRUCTION)
+					retVal = ERROR_IRRECOVERABLE;
+				if (printSimulatorState(fileOut, &sim) < 0)
+					retVal = ERROR_FILE_WRITING_ERROR;
+			}
+			freeSimulator(&sim);
+		}
+
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit((retVal == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	/* Only disassemble the pages that changed since the previous run */
+	if (incrementalState != NULL) {
+		programImage image;
+		int retVal;
+
+		if (argc-optind != 1) {
+			fprintf(stderr, "Error: --incremental needs one program file!\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		/* The pages of a state file are only valid for the same options */
+		retVal = hashCacheOptions(&key, "", 0, fileType, signaturesFileName, fOptions, archSelect);
+		if (retVal < 0)
+			fprintf(stderr, "Error: Cannot read signature database!\n");
+
+		initProgramImage(&image);
+		if (retVal == 0)
+			retVal = readProgramFile(&image, argv[optind], fileType);
+		if (retVal == 0)
+			retVal = disassembleIncremental(fileOut, &image, fOptions, archSelect, &key, incrementalState);
+		freeProgramImage(&image);
+
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit((retVal == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	/* Print the disassembly of the address ranges read from standard input */
+	if (viewBudget != 0) {
+		programImage image;
+		disassemblyView view;
+		const viewLine *lines;
+		char request[128], *next;
+		unsigned long start, end;
+		int i, numLines, retVal;
+
+		if (argc-optind != 1 || strcmp(argv[optind], "-") == 0) {
+			fprintf(stderr, "Error: --view needs one program file, standard input holds the ranges!\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		initProgramImage(&image);
+		retVal = readProgramFile(&image, argv[optind], fileType);
+		if (retVal == 0) {
+			retVal = initDisassemblyView(&view, &image, fOptions, archSelect, viewBudget);
+			if (retVal < 0) {
+				fprintf(stderr, "Error allocating sufficient memory for program analysis!\n");
+				freeProgramImage(&image);
+				if (fileOut != stdout)
+					fclose(fileOut);
+				exit(EXIT_FAILURE);
+			}
+		} else {
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		/* Every range is answered with its lines and an empty line */
+		while (retVal == 0 && fgets(request, sizeof(request), stdin) != NULL) {
+			start = strtoul(request, &next, 0);
+			end = strtoul(next, &endPtr, 0);
+			if (next == request || endPtr == next) {
+				fprintf(stderr, "Invalid address range %s", request);
+				continue;
+			}
+			retVal = getDisassemblyLines(&view, start, end, &lines, &numLines);
+			for (i = 0; i < numLines && retVal == 0; i++) {
+				if (fwrite(lines[i].text, 1, lines[i].textLength, fileOut) != lines[i].textLength)
+					retVal = ERROR_FILE_WRITING_ERROR;
+			}
+			if (retVal == 0 && (fputc('\n', fileOut) == EOF || fflush(fileOut) == EOF))
+				retVal = ERROR_FILE_WRITING_ERROR;
+		}
+		if (retVal == ERROR_FILE_WRITING_ERROR)
+			fprintf(stderr, "Error writing formatted disassembly to file!\n");
+		freeDisassemblyView(&view);
+		freeProgramImage(&image);
+
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit((retVal == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	/* Convert the program to another file format, with words patched */
+	if (convertFormat >= 0 || numPatches > 0) {
+		programImage image;
+		int i, retVal;
+
+		if (convertFormat < 0) {
+			fprintf(stderr, "Error: --patch needs --convert to write the patched program!\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+		if (argc-optind != 1) {
+			fprintf(stderr, "Error: --convert needs one program file!\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		initProgramImage(&image);
+		retVal = readProgramFile(&image, argv[optind], fileType);
+		for (i = 0; i < numPatches && retVal == 0; i++)
+			retVal = applyWordPatches(&image, patches[i]);
+		if (retVal == 0)
+			retVal = writeProgramImage(fileOut, &image, convertFormat);
+		freeProgramImage(&image);
+		free(patches);
+
+		if (fileOut != stdout && fclose(fileOut) != 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		exit((retVal == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	/* Only disassemble the words of the address range, the words of the
+	 * well formed records, or one word at every address */
+	if (rangeStart != 0 || rangeEnd != UINT32_MAX || keep_going || overlapPolicy >= 0) {
+		programImage image;
+		int retVal;
+
+		if (argc-optind != 1) {
+			fprintf(stderr, "Error: --start, --end, --keep-going and --overlap need one program file!\n\n");
+			printUsage(stderr, argv[0]);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+
+		initProgramImage(&image);
+		retVal = readProgramFile(&image, argv[optind], fileType);
+		if (retVal == 0)
+			retVal = disassembleProgramImage(fileOut, &image, fOptions, archSelect);
+		freeProgramImage(&image);
+
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit((retVal == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	/* If there are no more arguments left */
+	if (optind == argc) {
+		fprintf(stderr, "Error: No program file specified! Use - for standard input.\n\n");
+		printUsage(stderr, argv[0]);
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit(EXIT_FAILURE);
+	}
+
+	/* Support reading from stdin with filename "-" */
+	if (strcmp(argv[optind], "-") == 0) {
+		fileIn = stdin;
+	} else {
+		fileIn = fopen(argv[optind], "r");
+		if (fileIn == NULL) {
+			perror("Error: Cannot open program file for disassembly");
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	/* With a result cache, hash the input and the options, and copy the
+	 * cached disassembly if there is one. Otherwise the input is
+	 * disassembled from memory. */
+	if (cacheDirectory != NULL) {
+		retVal = readWholeFile(fileIn, &input, &inputSize);
+		if (fileIn != stdin)
+			fclose(fileIn);
+		if (retVal == 0)
+			retVal = hashCacheOptions(&key, input, inputSize, fileType, signaturesFileName, fOptions, archSelect);
+		if (retVal == 0)
+			retVal = copyCachedResult(fileOut, cacheDirectory, &key);
+		if (retVal != 0) {
+			if (retVal < 0)
+				fprintf(stderr, "Error: Cannot read program file or result cache!\n");
+			free(input);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit((retVal > 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		fileIn = fmemopen(input, inputSize, "r");
+		if (fileIn == NULL) {
+			perror("Error: Cannot read program file from memory");
+			free(input);
+			if (fileOut != stdout)
+				fclose(fileOut);
+			exit(EXIT_FAILURE);
+		}
+	}
+	/* Compressed program files are decompressed while they are read */
+	fileIn = decompressFile(profileFile(fileIn, "r"));
+	if (fileIn == NULL) {
+		free(input);
+		if (fileOut != stdout)
+			fclose(fileOut);
+		exit(EXIT_FAILURE);
+	}
+
+	/* If no file type was specified, try to auto-recognize the first character of the file */
+	if (fileType[0] == '\0' && detectFileType(fileIn, fileType) < 0) {
+		if (fileOut != stdout)
+			fclose(fileOut);
+		if (fileIn != stdin)
+			fclose(fileIn);
+		exit(EXIT_FAILURE);
+	}
+
 	if (strcasecmp(fileType, "ihex") == 0)
 		disassembleFile = disassembleIHexFile;
 	else if (strcasecmp(fileType, "srecord") == 0)
@@ -247,13 +1299,42 @@ int main(int argc, const char *argv[]) {
 		exit(EXIT_FAILURE);
 	}
 
-	disassembleFile(fileOut, fileIn, fOptions, archSelect);
+	/* Disassemble into a new cache entry, and copy it to the output once
+	 * it is complete. Without a usable cache directory, disassemble
+	 * straight to the output. */
+	if (cacheDirectory != NULL) {
+		resultOut = fileOut;
+		fileOut = createCacheEntry(cacheDirectory, cacheTempPath);
+		if (fileOut == NULL) {
+			fprintf(stderr, "Warning: Cannot create an entry in the result cache %s, not caching.\n", cacheDirectory);
+			fileOut = resultOut;
+			resultOut = NULL;
+		}
+	}
+
+	retVal = disassembleFile(fileOut, fileIn, fOptions, archSelect);
+
+	if (resultOut != NULL) {
+		if (fclose(fileOut) != 0 && retVal == 0)
+			retVal = ERROR_FILE_WRITING_ERROR;
+		fileOut = resultOut;
+		/* Failed disassemblies aren't cached */
+		if (retVal < 0)
+			unlink(cacheTempPath);
+		else if (commitCacheEntry(cacheDirectory, &key, cacheTempPath) < 0 || copyCachedResult(fileOut, cacheDirectory, &key) <= 0) {
+			fprintf(stderr, "Error: Cannot copy the disassembly from the result cache!\n");
+			retVal = ERROR_FILE_WRITING_ERROR;
+		}
+	}
+	free(input);
 
+	if (fOptions.signatures != NULL)
+		freeSignatureDatabase(&signatures);
 	if (fileOut != stdout)
 		fclose(fileOut);
 	if (fileOut != stdin)
 		fclose(fileIn);
 
-	exit(EXIT_SUCCESS);
+	exit((cacheDirectory == NULL || retVal >= 0) ? EXIT_SUCCESS : EXIT_FAILURE);
 }
 
@@ -0,0 +1,345 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * view.c - Lazy disassembly of address ranges of a program image. The
+ *  words are rendered in aligned intervals of VIEW_INTERVAL_WORDS words
+ *  when they are first requested, and the intervals are kept in a hashed
+ *  cache with least recently used eviction within a memory budget.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "pic_disasm.h"
+#include "pic_analysis.h"
+#include "pic_device.h"
+#include "format.h"
+#include "image.h"
+#include "errorcodes.h"
+#include "view.h"
+
+static int compareAddress(const void *a, const void *b) {
+	const assembledInstruction *x = *(const assembledInstruction **)a;
+	const assembledInstruction *y = *(const assembledInstruction **)b;
+
+	if (x->address != y->address)
+		return (x->address < y->address) ? -1 : 1;
+	return (x < y) ? -1 : (x > y);
+}
+
+/* Returns the index of the first sorted word with an address of at least
+ * address. */
+static int findFirstWord(const disassemblyView *view, uint32_t address) {
+	int low, high, middle;
+
+	low = 0;
+	high = view->image->numInstructions;
+	while (low < high) {
+		middle = low + (high-low)/2;
+		if (view->sorted[middle]->address < address)
+			low = middle+1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+static uint32_t hashInterval(const disassemblyView *view, uint32_t number) {
+	return (number * 0x9E3779B1) & view->bucketMask;
+}
+
+/* Prepares the lazy disassembly of a program image, which must stay
+ * unchanged while the view is used. Only sorts the words by address, and
+ * analyzes the program if address resolution is enabled; nothing is
+ * decoded or rendered until it is requested. The cache holds about
+ * memoryBudget bytes of rendered intervals. */
+int initDisassemblyView(disassemblyView *view, const programImage *image, formattingOptions fOptions, int archSelect, size_t memoryBudget) {
+	int i, retVal;
+
+	memset(view, 0, sizeof(disassemblyView));
+	view->image = image;
+	view->fOptions = fOptions;
+	view->archSelect = archSelect;
+	view->memoryBudget = memoryBudget;
+
+	view->sorted = malloc((image->numInstructions+1)*sizeof(assembledInstruction *));
+	/* The hash table grows with the number of cached intervals */
+	view->buckets = calloc(64, sizeof(viewInterval *));
+	view->bucketMask = 64-1;
+	if (view->sorted == NULL || view->buckets == NULL) {
+		freeDisassemblyView(view);
+		return ERROR_MEMORY_ALLOCATION_ERROR;
+	}
+	for (i = 0; i < image->numInstructions; i++)
+		view->sorted[i] = &image->instructions[i];
+	qsort(view->sorted, image->numInstructions, sizeof(assembledInstruction *), compareAddress);
+
+	if (fOptions.options & FORMAT_OPTION_RESOLVE_ADDRESSES) {
+		retVal = analyzeProgramImage(&view->analysis, image, archSelect);
+		if (retVal < 0) {
+			freeDisassemblyView(view);
+			return retVal;
+		}
+		view->pAnalysis = &view->analysis;
+	}
+
+	return 0;
+}
+
+/* Decodes and renders the words of an interval into one text buffer. */
+static viewInterval *renderInterval(disassemblyView *view, uint32_t number) {
+	viewInterval *interval;
+	FILE *textOut;
+	size_t textSize;
+	uint32_t end;
+	int first, i, retVal, region;
+	viewLine *line;
+
+	interval = calloc(1, sizeof(viewInterval));
+	if (interval == NULL)
+		return NULL;
+	interval->number = number;
+
+	first = findFirstWord(view, number*VIEW_INTERVAL_WORDS);
+	end = number*VIEW_INTERVAL_WORDS + (VIEW_INTERVAL_WORDS-1);
+	for (i = first; i < view->image->numInstructions && view->sorted[i]->address <= end; i++)
+		;
+	interval->numLines = i - first;
+	interval->lines = malloc((interval->numLines+1)*sizeof(viewLine));
+	textOut = open_memstream(&interval->text, &textSize);
+	if (interval->lines == NULL || textOut == NULL) {
+		if (textOut != NULL)
+			fclose(textOut);
+		free(interval->text);
+		free(interval->lines);
+		free(interval);
+		return NULL;
+	}
+
+	retVal = 0;
+	for (i = 0; i < interval->numLines && retVal == 0; i++) {
+		line = &interval->lines[i];
+		line->word = *view->sorted[first+i];
+		/* The offset of the text, until the buffer doesn't move any more */
+		line->textLength = ftell(textOut);
+		memset(&line->instruction, 0, sizeof(disassembledInstruction));
+
+		/* Words outside of the device's program memory aren't instructions */
+		if (view->fOptions.deviceIndex >= 0) {
+			region = lookupMemoryRegion(view->fOptions.deviceIndex, line->word.address);
+			if (region != REGION_PROGRAM) {
+				retVal = printMemoryWord(textOut, &line->word, region, view->fOptions);
+				continue;
+			}
+		}
+
+		retVal = disassembleInstruction(&line->instruction, &line->word, view->archSelect);
+		if (retVal == 0 && view->pAnalysis != NULL)
+			resolveOperands(view->pAnalysis, &line->instruction);
+		if (retVal == 0)
+			retVal = printDisassembledInstruction(textOut, &line->word, &line->instruction, view->fOptions);
+	}
+	if (fclose(textOut) != 0 || retVal < 0) {
+		free(interval->text);
+		free(interval->lines);
+		free(interval);
+		return NULL;
+	}
+
+	for (i = 0; i < interval->numLines; i++) {
+		interval->lines[i].text = interval->text + interval->lines[i].textLength;
+		interval->lines[i].textLength = ((i+1 < interval->numLines) ? interval->lines[i+1].textLength : textSize) - interval->lines[i].textLength;
+	}
+
+	interval->memory = sizeof(viewInterval) + interval->numLines*sizeof(viewLine) + textSize;
+	return interval;
+}
+
+/* Takes an interval out of the LRU list */
+static void unlinkInterval(disassemblyView *view, viewInterval *interval) {
+	if (interval->newer != NULL)
+		interval->newer->older = interval->older;
+	else
+		view->newest = interval->older;
+	if (interval->older != NULL)
+		interval->older->newer = interval->newer;
+	else
+		view->oldest = interval->newer;
+	interval->newer = interval->older = NULL;
+}
+
+/* Puts an interval at the most recently used end of the LRU list */
+static void linkNewestInterval(disassemblyView *view, viewInterval *interval) {
+	interval->older = view->newest;
+	interval->newer = NULL;
+	if (view->newest != NULL)
+		view->newest->newer = interval;
+	else
+		view->oldest = interval;
+	view->newest = interval;
+}
+
+static void freeInterval(viewInterval *interval) {
+	free(interval->text);
+	free(interval->lines);
+	free(interval);
+}
+
+/* Evicts the least recently used intervals until the cache is within its
+ * memory budget, except for the intervals of the current request. */
+static void evictIntervals(disassemblyView *view) {
+	viewInterval *interval, **link;
+
+	while (view->memory > view->memoryBudget && view->oldest != NULL && view->oldest->lastUsed != view->request) {
+		interval = view->oldest;
+		for (link = &view->buckets[hashInterval(view, interval->number)]; *link != interval; link = &(*link)->nextInBucket)
+			;
+		*link = interval->nextInBucket;
+		unlinkInterval(view, interval);
+		view->memory -= interval->memory;
+		view->numIntervals--;
+		freeInterval(interval);
+	}
+}
+
+/* Doubles the number of hash buckets and rehashes the cached intervals.
+ * The table stays as it is if there isn't memory for a larger one. */
+static void growBuckets(disassemblyView *view) {
+	viewInterval **buckets, *interval;
+	uint32_t oldMask, bucket;
+
+	buckets = calloc(2*(size_t)(view->bucketMask+1), sizeof(viewInterval *));
+	if (buckets == NULL)
+		return;
+	free(view->buckets);
+	view->buckets = buckets;
+	oldMask = view->bucketMask;
+	view->bucketMask = 2*oldMask+1;
+	for (interval = view->newest; interval != NULL; interval = interval->older) {
+		bucket = hashInterval(view, interval->number);
+		interval->nextInBucket = view->buckets[bucket];
+		view->buckets[bucket] = interval;
+	}
+}
+
+/* Returns the cached interval, rendering it if it isn't cached, and
+ * marks it most recently used. */
+static viewInterval *useInterval(disassemblyView *view, uint32_t number) {
+	viewInterval *interval;
+	uint32_t bucket;
+
+	bucket = hashInterval(view, number);
+	for (interval = view->buckets[bucket]; interval != NULL; interval = interval->nextInBucket) {
+		if (interval->number == number)
+			break;
+	}
+
+	if (interval == NULL) {
+		interval = renderInterval(view, number);
+		if (interval == NULL)
+			return NULL;
+		interval->nextInBucket = view->buckets[bucket];
+		view->buckets[bucket] = interval;
+		view->memory += interval->memory;
+		linkNewestInterval(view, interval);
+		/* Keep about one interval per bucket */
+		if (++view->numIntervals > (int)view->bucketMask+1)
+			growBuckets(view);
+	} else {
+		unlinkInterval(view, interval);
+		linkNewestInterval(view, interval);
+	}
+	interval->lastUsed = view->request;
+
+	return interval;
+}
+
+/* Returns the decoded and rendered lines of the words with an address from
+ * start to end, in address order, rendering the intervals that hold any of
+ * them and aren't cached. Least recently used intervals are evicted to
+ * stay within the memory budget. The lines stay valid until the next
+ * request. */
+int getDisassemblyLines(disassemblyView *view, uint32_t start, uint32_t end, const viewLine **lines, int *numLines) {
+	viewInterval *interval;
+	viewLine *newLines;
+	uint32_t number;
+	int i, n, word, next, newCapacity;
+
+	*lines = view->lines;
+	*numLines = 0;
+	view->request++;
+
+	if (start > end)
+		return 0;
+
+	/* Step from one interval holding words of the range to the next, so
+	 * empty intervals are never rendered or cached */
+	n = 0;
+	for (word = findFirstWord(view, start); word < view->image->numInstructions && view->sorted[word]->address <= end; word = next) {
+		number = view->sorted[word]->address/VIEW_INTERVAL_WORDS;
+		for (next = word+1; next < view->image->numInstructions && view->sorted[next]->address/VIEW_INTERVAL_WORDS == number; next++)
+			;
+
+		interval = useInterval(view, number);
+		if (interval == NULL) {
+			fprintf(stderr, "Error allocating sufficient memory for formatted disassembly!\n");
+			return ERROR_MEMORY_ALLOCATION_ERROR;
+		}
+
+		for (i = 0; i < interval->numLines; i++) {
+			if (interval->lines[i].word.address < start || interval->lines[i].word.address > end)
+				continue;
+			if (n == view->linesCapacity) {
+				newCapacity = (view->linesCapacity == 0) ? 256 : view->linesCapacity*2;
+				newLines = realloc(view->lines, newCapacity*sizeof(viewLine));
+				if (newLines == NULL) {
+					fprintf(stderr, "Error allocating sufficient memory for formatted disassembly!\n");
+					return ERROR_MEMORY_ALLOCATION_ERROR;
+				}
+				view->lines = newLines;
+				view->linesCapacity = newCapacity;
+			}
+			view->lines[n++] = interval->lines[i];
+		}
+	}
+
+	evictIntervals(view);
+
+	*lines = view->lines;
+	*numLines = n;
+	return 0;
+}
+
+/* Frees the cache and everything else held by the view. */
+void freeDisassemblyView(disassemblyView *view) {
+	viewInterval *interval, *older;
+
+	for (interval = view->newest; interval != NULL; interval = older) {
+		older = interval->older;
+		freeInterval(interval);
+	}
+	if (view->pAnalysis != NULL)
+		freeProgramAnalysis(view->pAnalysis);
+	free(view->sorted);
+	free(view->buckets);
+	free(view->lines);
+	memset(view, 0, sizeof(disassemblyView));
+}
@@ -0,0 +1,107 @@
+/*
+ * vPICdisasm - PIC program disassembler.
+ * Written by Vanya A. Sergeev - <vsergeev@gmail.com>
+ *
+ * Copyright (C) 2007-2011 Vanya A. Sergeev
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * view.h - Header file for the lazy disassembly of address ranges of a
+ *  program image on demand, for viewers that scroll through it.
+ *
+ */
+
+#ifndef VIEW_DISASM_H
+#define VIEW_DISASM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pic_disasm.h"
+#include "pic_analysis.h"
+#include "format.h"
+#include "image.h"
+
+/* Number of words in an interval of the view cache, aligned to its size */
+#define VIEW_INTERVAL_WORDS	64
+
+/* Default memory budget of the view cache */
+#define VIEW_DEFAULT_BUDGET	(16*1024*1024)
+
+/* A decoded and rendered word of the program image. The text is the
+ * formatted disassembly of the word, ending in a newline. Words outside
+ * of the device's program memory aren't decoded, and have a NULL
+ * instruction.instruction. */
+struct _viewLine {
+	assembledInstruction word;
+	disassembledInstruction instruction;
+	const char *text;
+	size_t textLength;
+};
+typedef struct _viewLine viewLine;
+
+/* An interval of the view cache, with the lines of the words in it */
+struct _viewInterval {
+	uint32_t number;
+	viewLine *lines;
+	int numLines;
+	char *text;
+	size_t memory;
+	/* Request that last used the interval, it isn't evicted during it */
+	unsigned int lastUsed;
+	/* Chain of the hash bucket, and the LRU list from most recently used */
+	struct _viewInterval *nextInBucket;
+	struct _viewInterval *newer, *older;
+};
+typedef struct _viewInterval viewInterval;
+
+/* Structure to hold the state of the lazy disassembly of a program image */
+struct _disassemblyView {
+	const programImage *image;
+	formattingOptions fOptions;
+	int archSelect;
+	programAnalysis analysis, *pAnalysis;
+	/* Words of the image sorted by address, in file order where an
+	 * address appears more than once */
+	const assembledInstruction **sorted;
+	/* Cached intervals, hashed by number and in LRU order */
+	viewInterval **buckets;
+	uint32_t bucketMask;
+	int numIntervals;
+	viewInterval *newest, *oldest;
+	size_t memory, memoryBudget;
+	unsigned int request;
+	/* Lines of the last request */
+	viewLine *lines;
+	int linesCapacity;
+};
+typedef struct _disassemblyView disassemblyView;
+
+/* Prepares the lazy disassembly of a program image, which must stay
+ * unchanged while the view is used. Only sorts the words by address, and
+ * analyzes the program if address resolution is enabled; nothing is
+ * decoded or rendered until it is requested. The cache holds about
+ * memoryBudget bytes of rendered intervals. */
+int initDisassemblyView(disassemblyView *view, const programImage *image, formattingOptions fOptions, int archSelect, size_t memoryBudget);
+
+/* Returns the decoded and rendered lines of the words with an address from
+ * start to end, in address order, rendering the intervals that hold any of
+ * them and aren't cached. Least recently used intervals are evicted to
+ * stay within the memory budget. The lines stay valid until the next
+ * request. */
+int getDisassemblyLines(disassemblyView *view, uint32_t start, uint32_t end, const viewLine **lines, int *numLines);
+
+/* Frees the cache and everything else held by the view. */
+void freeDisassemblyView(disassemblyView *view);
+
+#endif